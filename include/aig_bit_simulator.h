@@ -0,0 +1,135 @@
+#pragma once
+
+#include <mockturtle/mockturtle.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class VCDParser;
+
+// ==================== 内置位并行逻辑仿真 ====================
+//
+// 替代 BLIF -> yosys -> iverilog -> VCD -> VCDParser 的往返：AIG 先展开成
+// 按层级排序的扁平数组，每个节点的取值用 W 个 64 位字表示 64*W 条独立的
+// 激励通道 (W = 1 或 4，对应 64/256 路)，一次按序扫描门数组完成一个周期。
+//
+// 周期语义与 VCD 在时钟上升沿采样一致：周期 c 的 PI 取激励第 c 拍，
+// 寄存器输出取周期 c 开始时的状态；组合逻辑求值后所有节点值即为周期 c
+// 的采样，寄存器输入的值成为周期 c+1 的状态。时钟 PI (若指定) 恒为 1。
+
+// ==================== 分层 AIG ====================
+//
+// 节点号与 circuit.node_to_index 一致；扇入用文字表示：节点号 * 2 + 取反位。
+// 常量节点 0 的值为 0。
+struct LevelizedAIG {
+    uint32_t num_nodes;
+    uint32_t depth;
+    std::vector<uint32_t> pis;          // PI 节点号，按 PI 序号
+    std::vector<uint32_t> ros;          // 寄存器输出节点号，按寄存器序号
+    std::vector<uint32_t> ris;          // 寄存器输入文字，与 ros 对齐
+    std::vector<uint32_t> pos;          // PO 文字
+    std::vector<uint32_t> gates;        // 与门节点号，按层级升序
+    std::vector<uint32_t> fanin0;       // 与 gates 对齐的扇入文字
+    std::vector<uint32_t> fanin1;
+    std::vector<uint32_t> level;        // 节点号 -> 层级 (PI/寄存器/常量为 0)
+    std::vector<uint32_t> level_begin;  // 第 l 层的门在 gates 中的起点，末尾多一个哨兵
+
+    LevelizedAIG() : num_nodes(0), depth(0) {}
+
+    static LevelizedAIG build(const mockturtle::aig_network& circuit);
+
+    static uint32_t literal(uint32_t node, bool complemented) { return node * 2 + (complemented ? 1 : 0); }
+    static uint32_t literalNode(uint32_t lit) { return lit >> 1; }
+    static bool literalComplemented(uint32_t lit) { return lit & 1; }
+
+    size_t numGates() const { return gates.size(); }
+    bool isGate(uint32_t node) const { return node < level.size() && level[node] > 0; }
+};
+
+// ==================== 无故障仿真结果 ====================
+//
+// 按 [周期][节点][字] 连续存放的位数组，周期从 1 开始。
+// 多通道时 P(1) 为取 1 的通道比例；单一激励广播到所有通道时即为 0/1 值。
+class GoldenTrace {
+public:
+    GoldenTrace();
+
+    int numCycles() const { return num_cycles_; }
+    int numNodes() const { return num_nodes_; }
+    int numLanes() const { return words_ * 64; }
+    int wordsPerNode() const { return words_; }
+    int numPOs() const { return static_cast<int>(po_literals_.size()); }
+    bool hasCycle(int cycle) const { return cycle >= 1 && cycle <= num_cycles_; }
+
+    const uint64_t* nodeWords(int node, int cycle) const {
+        return bits_.data() + ((size_t)(cycle - 1) * num_nodes_ + node) * words_;
+    }
+
+    bool value(int node, int cycle, int lane = 0) const {
+        return (nodeWords(node, cycle)[lane >> 6] >> (lane & 63)) & 1;
+    }
+    int countOnes(int node, int cycle) const;
+
+    // 与 VCDParser 同名查询一致的接口，供 FSTRA 直接替换波形来源
+    bool getNodeOutputByIndex(int node, int cycle, double& prob_0, double& prob_1) const;
+    bool getPOOutput(int po, int cycle, std::vector<double>& prob_0, std::vector<double>& prob_1) const;
+    bool getPOValue(int po, int cycle, int lane = 0) const;
+
+private:
+    friend class AigBitSimulator;
+
+    int num_cycles_;
+    int num_nodes_;
+    int words_;
+    std::vector<uint64_t> bits_;
+    std::vector<uint32_t> po_literals_;
+
+    uint64_t* mutableWords(int node, int cycle) {
+        return bits_.data() + ((size_t)(cycle - 1) * num_nodes_ + node) * words_;
+    }
+};
+
+// ==================== 仿真器 ====================
+class AigBitSimulator {
+public:
+    explicit AigBitSimulator(const LevelizedAIG& aig, int lanes = 64);
+
+    int numLanes() const { return words_ * 64; }
+
+    // 时序电路的 clock 是网络中的普通 PI，在采样时刻 (上升沿) 取 1；-1 表示没有时钟
+    void setClockInput(int pi_index) { clock_pi_ = pi_index; }
+
+    // 寄存器初值，按寄存器序号；默认全 0 (与 FSTRA 第 1 周期寄存器先验一致)
+    void setInitialState(const std::vector<bool>& state) { initial_state_ = state; }
+
+    // 每个通道独立的均匀随机激励，相同种子得到相同序列
+    void setRandomStimulus(uint64_t seed);
+
+    // 显式激励：input_sequence[c-1][i] 为第 c 拍 PI i 的值 (含时钟位)，广播到所有通道
+    void setStimulus(const std::vector<std::vector<bool>>& input_sequence);
+
+    // 从 iverilog 产生的 VCD 中按 input_k / rout_k 读出每拍激励和寄存器初值，
+    // 用于与 VCD 对照；PI 0 为时钟时其余 PI 依次对应 input_0, input_1, ...
+    bool loadStimulusFromWaveform(VCDParser& vcd, int num_cycles);
+
+    bool run(int num_cycles, GoldenTrace& trace);
+
+    // 与 VCD 波形逐周期比较 signal_N 与 PO 的值 (只比较第 0 通道)，返回不一致的个数，-1 表示无法比较
+    static int compareWithWaveform(const LevelizedAIG& aig, const GoldenTrace& trace, VCDParser& vcd,
+                                   int num_cycles, int max_report = 10);
+
+private:
+    enum class StimulusMode { Random, Explicit };
+
+    const LevelizedAIG& aig_;
+    int words_;
+    int clock_pi_;
+    StimulusMode mode_;
+    uint64_t seed_;
+    std::vector<std::vector<bool>> sequence_;
+    std::vector<bool> initial_state_;
+
+    template <int W>
+    void evaluateGates(uint64_t* values) const;
+    void evaluateGatesGeneric(uint64_t* values) const;
+};
@@ -6,6 +6,41 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include "aig_bit_simulator.h"
+
+// ==================== 逐周期节点值记录 ====================
+//
+// 每个周期记录相对上一周期取值翻转的节点号；翻转节点过多 (增量比位图大)
+// 或距上一关键帧已达 keyframe_interval 个周期时改存一帧按位压缩的全部节点值。
+// 查询某周期的值时从它所属的关键帧向后重放翻转，重放长度不超过间隔。
+// 周期从 0 起；间隔须为正，周期或节点越界时查询返回 false。
+class SimulationTrace {
+public:
+    SimulationTrace() : num_nodes_(0), interval_(64), words_(0), change_begin_(1, 0) {}
+
+    bool reset(uint32_t num_nodes, int keyframe_interval);
+    bool record(const std::vector<uint8_t>& values);   // 追加下一个周期，values 按节点号索引
+
+    int num_cycles() const { return static_cast<int>(key_cycle_.size()); }
+    uint32_t num_nodes() const { return num_nodes_; }
+    bool value(uint32_t node, int cycle, bool& v) const;
+    bool values_at(int cycle, std::vector<uint8_t>& values) const;
+    size_t memory_bytes() const;
+
+private:
+    uint32_t num_nodes_;
+    int interval_;
+    size_t words_;                     // 每个关键帧的 64 位字数
+    std::vector<uint64_t> keyframes_;
+    std::vector<int> key_cycle_;       // 周期 -> 所属关键帧的周期
+    std::vector<int64_t> frame_offset_;// 周期 -> 关键帧在 keyframes_ 中的起点，非关键帧为 -1
+    std::vector<uint32_t> changes_;    // 各周期翻转节点号依次拼接
+    std::vector<size_t> change_begin_; // 周期 c 的翻转在 changes_[change_begin_[c], change_begin_[c+1])
+    std::vector<uint64_t> last_;       // 上一周期的位图
+    std::vector<uint64_t> packed_;
+
+    bool checkCycle(int cycle) const;
+};
 
 class CircuitReliabilitySimulator {
 public:
@@ -24,10 +59,9 @@ public:
             : node(n), index(idx), current_state(false), next_state(false) {}
     };
 
+    // 单个周期的端口值；全部节点值由 get_trace() 按周期查询，不再逐周期复制
     struct SimulationCycle {
         int cycle_number;
-        std::unordered_map<mockturtle::aig_network::node, bool> node_values;
-        std::unordered_map<int, bool> register_states;  // 使用寄存器名作为键
         std::vector<bool> primary_inputs;
         std::vector<bool> primary_outputs;
         std::vector<bool> register_outputs;
@@ -54,6 +88,8 @@ public:
     // 仿真接口
     std::vector<bool> fault_free_simulation(const std::vector<bool>& inputs);
     std::unordered_map<mockturtle::aig_network::node, bool> get_node_values() const;
+    const std::vector<uint8_t>& get_node_value_array() const { return values_; }  // 按节点号索引
+    bool get_node_value(mockturtle::aig_network::node node) const { return values_[circuit_.node_to_index(node)]; }
     std::vector<bool> fault_free_simulation_iverilog(const std::vector<bool>& inputs);
 
     //时序仿真
@@ -68,6 +104,12 @@ public:
 
 
     void identify_registers();
+    void levelize();  // 修改网络后重新展开；仿真入口在节点数变化时自动调用
+    const LevelizedAIG& get_levelized() const { return levelized_; }
+
+    // 关键帧间隔，0 表示不记录逐周期节点值
+    bool set_trace_keyframe_interval(int interval);
+    const SimulationTrace& get_trace() const { return trace_; }
     const std::vector<RegisterInfo>& get_registers() const { return registers_; }
     std::unordered_map<int, bool> get_current_register_state() const;  
     void set_register_state(int register_index, bool state);  
@@ -101,7 +143,10 @@ public:
     
 private:
     mockturtle::aig_network circuit_;
-    std::unordered_map<mockturtle::aig_network::node, bool> node_values_;
+    LevelizedAIG levelized_;
+    std::vector<uint8_t> values_;      // 节点号 -> 当前值 (0/1)
+    SimulationTrace trace_;
+    int trace_interval_;
     std::unordered_map<mockturtle::aig_network::node, double> fault_probabilities_;
 
     std::vector<RegisterInfo> registers_;
@@ -113,14 +158,11 @@ private:
     double clock_duty_cycle_;
     std::unordered_map<int, bool> initial_register_state_;  
     
-    // 门计算函数
-    void compute_gate_output(mockturtle::aig_network::node node);
-    bool compute_and_gate(const std::vector<bool>& inputs);
-    bool compute_or_gate(const std::vector<bool>& inputs);
-    bool compute_not_gate(bool input);
-    bool compute_nand_gate(const std::vector<bool>& inputs);
-    bool compute_nor_gate(const std::vector<bool>& inputs);
-    bool compute_xor_gate(const std::vector<bool>& inputs);
+    // 门计算：按层级顺序扫描与门数组
+    void ensure_levelized();
+    void set_inputs(const std::vector<bool>& inputs);
+    void evaluate_gates();
+    bool literal_value(uint32_t lit) const { return values_[lit >> 1] ^ (lit & 1); }
 
     //时序辅助函数
     void setup_constant_nodes();
@@ -133,5 +175,4 @@ private:
     
     // 辅助函数
     bool get_fanin_value(mockturtle::aig_network::signal fanin) const;
-    std::vector<bool> get_fanin_values(mockturtle::aig_network::node node) const;
 };
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "aig_bit_simulator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==================== 单固定型故障仿真 (PPSFP) ====================
+//
+// 把寄存器看作伪输入/伪输出 (全扫描视角)：激励给 PI 与寄存器输出，观测 PO 与寄存器输入。
+// 每个 64 位字是 64 个测试向量，先求一次无故障值，再对每个未检出的故障只沿其扇出锥
+// 按层级传播与无故障值不同的位；差异到达观测点即检出，默认检出后从故障表中丢弃。
+// 故障之间相互独立，按故障并行 (OpenMP)，结果与线程数无关。
+
+struct StuckAtFault {
+    uint32_t node;       // 节点号
+    bool value;          // 固定值
+};
+
+class FaultCampaign {
+public:
+    // 单个故障的统计
+    struct FaultResult {
+        StuckAtFault fault;
+        long long activations = 0;        // 故障点取值与固定值不同 (被激活) 的向量数
+        long long detections = 0;         // 差异到达 PO/寄存器输入的向量数
+        long long first_detection = -1;   // 第一个检出向量的序号
+
+        bool detected() const { return first_detection >= 0; }
+        // 被激活但被逻辑屏蔽；由故障压缩展开得到的结果激活数未知 (-1)
+        long long masked() const { return activations < 0 ? -1 : activations - detections; }
+    };
+
+    explicit FaultCampaign(const LevelizedAIG& aig);
+
+    // 故障表：默认为所有 PI、寄存器输出和与门上的 stuck-at-0/1
+    void enumerate_faults();
+    void set_fault_list(const std::vector<StuckAtFault>& faults);
+    const std::vector<StuckAtFault>& get_fault_list() const { return faults_; }
+
+    // 关闭后对每个故障统计全部向量 (用于屏蔽率)，开启时检出所在字之后不再仿真
+    void set_fault_dropping(bool enable) { dropping_ = enable; }
+
+    // 随机向量：每个输入每个字由计数器型随机数流 (seed, 输入序号, 字号) 产生
+    bool run_random(long long num_patterns, uint64_t seed);
+    // 指定向量：每个向量依次为 PI 值、寄存器输出值
+    bool run(const std::vector<std::vector<bool>>& patterns);
+
+    const std::vector<FaultResult>& get_results() const { return results_; }
+    // 换成外部给出的结果 (如 FaultCollapser::expand 展开的全部故障)，故障表随之替换
+    void set_results(const std::vector<FaultResult>& results);
+    long long get_num_patterns() const { return num_patterns_; }
+    size_t get_num_detected() const;
+    double get_fault_coverage() const;
+
+    void print_summary() const;
+    bool write_report(const std::string& filename) const;
+
+private:
+    LevelizedAIG aig_;
+    std::vector<StuckAtFault> faults_;
+    std::vector<FaultResult> results_;
+    bool dropping_;
+    long long num_patterns_;
+
+    std::vector<uint32_t> fanout_begin_;   // 节点号 -> fanout_gates_ 区间 (CSR)
+    std::vector<uint32_t> fanout_gates_;   // 扇出门在 aig_.gates 中的序号
+    std::vector<uint8_t> observed_;        // 节点号 -> 是否驱动 PO 或寄存器输入
+    std::vector<uint64_t> good_;           // 当前字的无故障值
+
+    // 每个线程的传播缓冲
+    struct Scratch {
+        std::vector<uint64_t> value;              // 故障值，stamp 匹配时有效
+        std::vector<uint32_t> stamp;
+        std::vector<uint32_t> queued;             // 按门序号
+        std::vector<std::vector<uint32_t>> levels;
+        uint32_t current = 0;
+    };
+    std::vector<Scratch> scratch_;
+
+    // fill(word, ci, valid) 给出第 word 个字中各 CI (先 PI 后寄存器输出) 的激励
+    template <typename Fill>
+    bool run_words(long long num_patterns, Fill fill);
+    void simulate_good(uint64_t valid);
+    void simulate_fault(size_t index, long long word, uint64_t valid, Scratch& s);
+};
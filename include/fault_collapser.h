@@ -0,0 +1,45 @@
+#pragma once
+
+#include "fault_campaign.h"
+#include <cstdint>
+#include <vector>
+
+// ==================== 结构故障压缩 ====================
+//
+// 故障在节点 (干线) 上。节点 a 只扇出到一个与门 g、且不直接驱动 PO/寄存器输入时，
+// a 上的故障等同于 g 的输入引脚故障，于是：
+//   等价：使 g 的该输入为控制值 0 的固定值 (a 的补码位 c) 与 g stuck-at-0 等价；
+//   支配：g stuck-at-1 支配该输入为 1 的故障 (a stuck-at !c)，检出后者必检出前者。
+// 等价关系用并查集合并，在无扇出区域内沿链传递；支配按层级顺序处理，被丢弃的类
+// 记录它依赖的 (保留的) 类。仿真代表故障后用 expand() 展开回全部故障：
+// 等价成员的检出结果精确；被支配丢弃的故障在依赖的类检出时记为检出，否则保守地记为未检出。
+
+class FaultCollapser {
+public:
+    explicit FaultCollapser(const LevelizedAIG& aig, bool use_dominance = true);
+
+    // 全部故障，与 FaultCampaign::enumerate_faults 的顺序相同
+    const std::vector<StuckAtFault>& faults() const { return faults_; }
+    // 需要仿真的代表故障
+    const std::vector<StuckAtFault>& representatives() const { return representatives_; }
+    // 代表 -> 与它等价的全部故障序号 (含自身)
+    const std::vector<uint32_t>& members(size_t rep) const { return members_[rep]; }
+    // 代表 -> 因支配而丢弃、在该代表检出时随之检出的故障序号
+    const std::vector<uint32_t>& implied(size_t rep) const { return implied_[rep]; }
+
+    // 代表故障的仿真结果 (与 representatives() 对齐) 展开为全部故障的结果
+    std::vector<FaultCampaign::FaultResult> expand(const std::vector<FaultCampaign::FaultResult>& rep_results) const;
+
+    double collapse_ratio() const {
+        return faults_.empty() ? 1.0 : static_cast<double>(representatives_.size()) / faults_.size();
+    }
+    void print_summary() const;
+
+private:
+    std::vector<StuckAtFault> faults_;
+    std::vector<StuckAtFault> representatives_;
+    std::vector<std::vector<uint32_t>> members_;
+    std::vector<std::vector<uint32_t>> implied_;
+    size_t equivalence_dropped_;
+    size_t dominance_dropped_;
+};
@@ -1,7 +1,8 @@
 #pragma once
 
 #include "circuit_simulator.h"
-#include <random>
+#include "fault_site_sampler.h"
+#include "philox_rng.h"
 #include <unordered_map>
 
 class FaultInjector {
@@ -11,6 +12,7 @@ public:
     
     // 故障注入接口
     void inject_random_faults(double fault_probability);
+    void set_seed(uint64_t seed) { seed_ = seed; trial_ = 0; }   // 第 k 次注入使用流 (seed, k)
     void set_stuck_at_fault(mockturtle::aig_network::node node, bool stuck_value);
     void clear_faults();
     void clear_node_fault(mockturtle::aig_network::node node);
@@ -20,6 +22,20 @@ public:
         const std::vector<bool>& inputs,
         const std::unordered_map<mockturtle::aig_network::node, bool>& node_values);
     
+    // 差分仿真：无故障值按周期压缩成位图存一次，故障场景只沿故障节点的扇出锥
+    // 按层级传播与无故障值不同的事件，差异被屏蔽处即停止
+    void record_golden_cycle(const std::vector<uint8_t>& node_values);   // 按节点号索引，追加一个周期
+    bool set_golden_trace(const SimulationTrace& trace);
+    void clear_golden();
+    int get_num_golden_cycles() const { return golden_cycles_; }
+    
+    // 第 cycle 周期的 PO 值；PI 与寄存器输出取无故障值 (与 simulate_with_faults 相同)
+    std::vector<bool> simulate_with_faults_differential(int cycle);
+    // 从 first_cycle 起连续 num_cycles 个周期，寄存器锁存的差异带入下一周期
+    std::vector<std::vector<bool>> simulate_sequence_differential(int first_cycle, int num_cycles);
+    // 最近一次差分仿真中求值的门数
+    size_t get_last_evaluated_gates() const { return evaluated_gates_; }
+    
     // 故障信息获取
     const std::unordered_map<mockturtle::aig_network::node, bool>& 
         get_injected_faults() const { return stuck_at_faults_; }
@@ -34,8 +50,41 @@ public:
 private:
     mockturtle::aig_network& circuit_;
     std::unordered_map<mockturtle::aig_network::node, bool> stuck_at_faults_;
-    std::mt19937 rng_;
-    std::uniform_real_distribution<double> dist_;
+    uint64_t seed_;
+    uint32_t trial_;
+    std::vector<mockturtle::aig_network::node> gates_;   // 抽样用的门列表，网络变化时重建
+    std::vector<uint64_t> fault_sites_;
+    
+    // 差分仿真状态
+    LevelizedAIG levelized_;
+    std::vector<uint32_t> gate_of_node_;       // 节点号 -> levelized_ 中的门序号，非门为 UINT32_MAX
+    std::vector<uint32_t> fanout_begin_;       // 节点号 -> fanout_gates_ 区间
+    std::vector<uint32_t> fanout_gates_;
+    std::vector<uint32_t> ri_begin_;           // 节点号 -> 读取它的寄存器输入序号
+    std::vector<uint32_t> ri_of_node_;
+    std::vector<uint64_t> golden_bits_;        // [cycle * golden_words_ + node / 64]
+    size_t golden_words_ = 0;
+    int golden_cycles_ = 0;
+    
+    std::vector<uint32_t> diff_stamp_;         // 节点的故障值在本周期与无故障值不同时等于 stamp_
+    std::vector<uint8_t> diff_value_;
+    std::vector<uint32_t> queued_stamp_;
+    std::vector<int8_t> stuck_;                // 节点号 -> 固定值，-1 表示无故障
+    std::vector<std::vector<uint32_t>> level_queue_;
+    std::vector<uint32_t> touched_;            // 本周期与无故障值不同的节点
+    uint32_t stamp_ = 0;
+    size_t evaluated_gates_ = 0;
+    
+    void ensure_levelized();
+    bool golden_value(uint32_t node, int cycle) const {
+        return (golden_bits_[(size_t)cycle * golden_words_ + (node >> 6)] >> (node & 63)) & 1;
+    }
+    bool faulty_value(uint32_t node, int cycle) const {
+        return diff_stamp_[node] == stamp_ ? diff_value_[node] : golden_value(node, cycle);
+    }
+    bool faulty_literal(uint32_t lit, int cycle) const { return faulty_value(lit >> 1, cycle) ^ (lit & 1); }
+    void mark_diff(uint32_t node, bool value);
+    void propagate_cycle(int cycle, const std::vector<std::pair<uint32_t, bool>>& seeds);
     
     // 门计算函数（考虑故障）
     void compute_gate_output_with_values(
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ==================== 故障位置抽样 ====================
+//
+// 每个位置 (门、或门 x 场景位) 独立地以概率 p 出错。逐位置抽均匀随机数的
+// 代价与位置数成正比；这里改为直接抽相邻两个故障位置之间的间隔：
+// 间隔服从几何分布 P(gap = k) = (1-p)^k p，用 floor(ln U / ln(1-p)) 一次得到，
+// 随机数个数与故障个数成正比。
+//
+// 位并行场景下 p 较大时 (每个 64 位字期望超过一个故障) 几何跳跃反而更慢，
+// 改用按 p 的二进制展开组合随机字的位技巧：从最低位起，该位为 1 时与随机字
+// 取或，为 0 时取与，kMaskBits 个随机字得到每位独立、概率为 p (截断到
+// 2^-kMaskBits) 的掩码。
+//
+// URBG 需输出 64 位随机数 (如 std::mt19937_64)。
+
+class FaultSiteSampler {
+public:
+    static constexpr int kMaskBits = 24;
+
+    explicit FaultSiteSampler(double p = 0.0) { setProbability(p); }
+
+    void setProbability(double p) {
+        p_ = p < 0.0 ? 0.0 : (p > 1.0 ? 1.0 : p);
+        logq_ = (p_ > 0.0 && p_ < 1.0) ? std::log1p(-p_) : 0.0;
+        threshold_ = static_cast<uint32_t>(std::ldexp(p_, kMaskBits) + 0.5);
+        useMaskBits_ = p_ * 64.0 >= 1.0;
+    }
+
+    double probability() const { return p_; }
+
+    // 距下一个故障位置要跳过的无故障位置数；p = 0 时返回 UINT64_MAX
+    template <typename URBG>
+    uint64_t nextGap(URBG& rng) const {
+        if (p_ <= 0.0) return UINT64_MAX;
+        if (p_ >= 1.0) return 0;
+        const double u = (static_cast<double>(rng() >> 11) + 1.0) * (1.0 / 9007199254740992.0);  // (0, 1]
+        const double gap = std::floor(std::log(u) / logq_);
+        return gap >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(gap);
+    }
+
+    // 在 [0, n) 中抽出所有故障位置 (升序) 追加到 sites
+    template <typename URBG>
+    void sample(uint64_t n, URBG& rng, std::vector<uint64_t>& sites) const {
+        uint64_t pos = 0;
+        while (true) {
+            const uint64_t gap = nextGap(rng);
+            if (gap >= n - pos) return;
+            pos += gap;
+            sites.push_back(pos);
+            if (++pos >= n) return;
+        }
+    }
+
+    // 64 位掩码，每位独立地以概率 p 置 1
+    template <typename URBG>
+    uint64_t mask64(URBG& rng) const {
+        if (threshold_ == 0) return 0;
+        if (threshold_ >= (1u << kMaskBits)) return ~uint64_t(0);
+        uint64_t m = 0;
+        for (int b = 0; b < kMaskBits; ++b) {
+            const uint64_t r = rng();
+            m = ((threshold_ >> b) & 1) ? (m | r) : (m & r);
+        }
+        return m;
+    }
+
+    // 位并行时是否按字抽掩码 (否则对整串位置做几何跳跃)
+    bool prefersMaskBits() const { return useMaskBits_; }
+
+private:
+    double p_;
+    double logq_;
+    uint32_t threshold_;   // round(p * 2^kMaskBits)
+    bool useMaskBits_;
+};
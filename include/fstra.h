@@ -3,6 +3,7 @@
 #include <mockturtle/mockturtle.hpp>
 #include "iverilog_simulator.h"
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <vector>
 #include <unsupported/Eigen/KroneckerProduct>
 #include <kitty/kitty.hpp>
@@ -11,6 +12,8 @@
 #include <functional>
 #include <memory>
 #include "vcd_parser.h"
+#include "tensor_network.h"
+#include "aig_bit_simulator.h"
 
 class FSTRAAnalyzer {
 private:
@@ -27,13 +30,16 @@ private:
         Eigen::MatrixXd iptM;
         Eigen::MatrixXd optM;
         Eigen::MatrixXd REoptM;
+        Eigen::SparseMatrix<double, Eigen::RowMajor> sparseOptM;  // 稀疏化模式下替代 optM
         std::vector<int> fsL;
         bool hasFanoutBranch;
         bool isSequential;
+        bool optMIsSparse;
         std::vector<double> rel;
         
         FSNode() : in(0), out(0), index(-1), cycle(0), 
-                  hasFanoutBranch(false), isSequential(false) {
+                  hasFanoutBranch(false), isSequential(false),
+                  optMIsSparse(false) {
             iptM = Eigen::MatrixXd::Identity(1, 1);
             optM = Eigen::MatrixXd::Identity(1, 1);
             REoptM = Eigen::MatrixXd::Identity(1, 1);
@@ -41,7 +47,8 @@ private:
         }
         
         FSNode(int idx) : in(0), out(0), index(idx), cycle(0),
-                         hasFanoutBranch(false), isSequential(false) {
+                         hasFanoutBranch(false), isSequential(false),
+                         optMIsSparse(false) {
             iptM = Eigen::MatrixXd::Identity(1, 1);
             optM = Eigen::MatrixXd::Identity(1, 1);
             REoptM = Eigen::MatrixXd::Identity(1, 1);
@@ -64,6 +71,26 @@ private:
     
     int nowCycle_;
 
+    // 稀疏化配置：optM 中低于阈值的元素被丢弃，丢弃的质量按 PO 统计
+    bool sparseMode_;
+    double sparseThreshold_;
+    int sparseMinRows_;
+    std::vector<std::vector<double>> sparseErrorBound_;
+
+    // FS_TRAMethodByCycle 得到的 PO 可靠度，按 [cycle][po] 保存
+    std::vector<std::vector<double>> poReliability_;
+
+    // 张量网络缩并得到的 PO 可靠度，按 [cycle][po] 保存
+    std::vector<std::vector<double>> tnReliability_;
+    std::shared_ptr<const VCDQuerySnapshot> waveform_;      // 并行阶段只读采样用的波形快照
+
+    // 统计先验：设置后 opVectors_ 取自信号统计 (窗口平均或逐周期) 而不是波形单点采样
+    std::shared_ptr<const VCDSignalStatistics> signalStats_;
+    bool statsWindowAverage_;
+
+    // 内置位并行仿真结果：设置后 opVectors_ 与理想 PO 输出都取自它，不再查询 VCD
+    std::shared_ptr<const GoldenTrace> goldenTrace_;
+
 
 public:
     FSTRAAnalyzer(mockturtle::aig_network& circuit, IverilogSimulator& sim, VCDParser& vcd_parser);
@@ -79,12 +106,28 @@ public:
     void runParallelReliabilityCalculation(const std::vector<int>& vec_int, int k);
     void FS_TRAMethod(int cycle, int Mn_fs);
     void FS_TRAMethodByCycle(int cycle, int Mn_fs);
+    // 任一节点的缩并宽度无法降到 max_width 以内时报错并返回 false，之后的周期不再计算
+    bool TensorNetworkMethodByCycle(int cycle, int max_width = 20,
+                                    TensorNetwork::OrderHeuristic heuristic = TensorNetwork::OrderHeuristic::MinFill);
     double calculateOutputReliability(const Eigen::MatrixXd& optM, const Eigen::VectorXd& oIV,bool is_complemented);
     double calculateOutputReliability(const Eigen::MatrixXd& optM, const Eigen::VectorXd& oIV);
     
     // 配置函数
     void setFaultRate(double rate) { faultRate_ = rate; }
     void setMffMatrix(const Eigen::Matrix<double, 2, 2>& mff) { Mff_ = mff; }
+    void setSparsification(bool enable, double threshold = 1e-6, int min_rows = 16) {
+        sparseMode_ = enable;
+        sparseThreshold_ = threshold;
+        sparseMinRows_ = min_rows;
+    }
+    double getSparseErrorBound(int cycle, int po_index) const;
+    double getReliability(int cycle, int po_index) const;
+    double getTensorNetworkReliability(int cycle, int po_index) const;
+    void setSignalStatistics(std::shared_ptr<const VCDSignalStatistics> stats, bool window_average = true) {
+        signalStats_ = std::move(stats);
+        statsWindowAverage_ = window_average;
+    }
+    void setGoldenTrace(std::shared_ptr<const GoldenTrace> trace) { goldenTrace_ = std::move(trace); }
     
     // 访问函数
     FSNode& getFSNode(int cycle,int index) { return allFsNodes_[cycle][index]; }
@@ -108,6 +151,12 @@ private:
         const std::vector<int>& elements_to_remove);
     void del_rMr(const Eigen::MatrixXd& formoptM, const std::vector<int>& formFsL, 
                                 const std::vector<int>& tb_rm_FsL,Eigen::MatrixXd& tmpM,std::vector<int>& tmpFsl);
+    void del_rMrSparse(const Eigen::SparseMatrix<double, Eigen::RowMajor>& formoptM, bool swap_cols,
+                       const std::vector<int>& formFsL, const std::vector<int>& tb_rm_FsL,
+                       Eigen::MatrixXd& tmpM, std::vector<int>& tmpFsl);
+    bool buildSparseOptM(FSNode& fsnode, const std::vector<std::vector<int>>& faninFsL,
+                         const std::vector<Eigen::MatrixXd>& faninM);
+    void recordSparseErrorBound(const FSNode& father, int po_index);
     void fsTracking(FSNode& fsnode);
     void iterativeReduction(std::vector<int> nodefsL, Eigen::MatrixXd& nodeOptM);
     void ProgramIterativeReduction(FSNode& fsnode, Eigen::MatrixXd& nodeOptM,int Mn_fs);
@@ -118,6 +167,9 @@ private:
     void DimensionReductionByCycle(FSNode& fsnode,int Mn_fs);
     void getIdealOutput();
     void getopVectors(int cycle);
+    const VCDQuerySnapshot* waveformSnapshot();
+    bool idealPOOutput(int po_index, int cycle, std::vector<double>& prob_0, std::vector<double>& prob_1);
+    void buildCycleTensorNetwork(TensorNetwork& tn, int cycle, const std::vector<Eigen::Vector2d>& roDist);
     void calPriorities(int cycle);
     int extractSignalIndex(const std::string& node_name);
     
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <array>
+#include <utility>
+#include <vector>
+
+// ==================== 小规模扇出源列表的特化内核 ====================
+//
+// removeDuplicateElements / del_rMr 在 fsL 长度 n 很小时 (典型 Mn_fs = 3~8)
+// 处理的矩阵只有 2^n 行。这里为 n = 0..kMaxFixedFsL 生成编译期特化的内核，
+// 索引映射放在 std::array 中，循环次数固定，便于编译器完全展开；中间结果放在
+// 行数固定、列数不超过 kMaxFixedCols 的栈上矩阵里，只在最后写回调用方一次。
+// 运行时通过分派表按 n 选择对应实例，超出范围时调用方走原有的动态路径。
+//
+// 编码约定与 FSTRAAnalyzer 保持一致：fsL[i] 对应行号的第 (n-1-i) 位 (MSB 优先)。
+
+namespace fstra_kernels {
+
+constexpr int kMaxFixedFsL = 8;
+constexpr int kMaxFixedCols = 4;    // iptM 为两个两列矩阵的 Kronecker 积，最多 4 列
+
+// 2^N 行、列数在运行时确定的栈上矩阵 (N = 0 时为行向量，Eigen 要求行优先)
+template <int N>
+using FixedRowsMatrix = Eigen::Matrix<double, (1 << N), Eigen::Dynamic,
+                                      (N == 0 ? Eigen::RowMajor : Eigen::ColMajor), (1 << N), kMaxFixedCols>;
+
+// 合并内核参数：out.row(code) = kron(A.row(codeA), B.row(codeB))
+struct CombineArgs {
+    const Eigen::MatrixXd* A;
+    const Eigen::MatrixXd* B;
+    // mulA[p] / mulB[p]：合并编码第 p 位在子编码中的权值 (不属于该子列表时为 0)
+    std::array<int, kMaxFixedFsL> mulA;
+    std::array<int, kMaxFixedFsL> mulB;
+};
+
+// 约简内核参数：out = (⊗_i (removed_i ? opV_i^T : I2)) * M
+struct ContractArgs {
+    const Eigen::MatrixXd* M;
+    // 对 M 行号第 p 位：被约去时 opv[p] 非空，否则 keepMul[p] 为保留编码中的权值
+    std::array<const Eigen::Vector2d*, kMaxFixedFsL> opv;
+    std::array<int, kMaxFixedFsL> keepMul;
+    int keptCount;
+};
+
+template <int N>
+void combineFixed(const CombineArgs& args, Eigen::MatrixXd& out) {
+    const Eigen::MatrixXd& A = *args.A;
+    const Eigen::MatrixXd& B = *args.B;
+    const int ca = static_cast<int>(A.cols());
+    const int cb = static_cast<int>(B.cols());
+    constexpr int rows = 1 << N;
+
+    FixedRowsMatrix<N> result(rows, ca * cb);
+    for (int code = 0; code < rows; ++code) {
+        int codeA = 0;
+        int codeB = 0;
+        for (int p = 0; p < N; ++p) {
+            const int bit = (code >> p) & 1;
+            codeA += bit * args.mulA[p];
+            codeB += bit * args.mulB[p];
+        }
+        for (int i = 0; i < ca; ++i) {
+            const double a = A(codeA, i);
+            for (int j = 0; j < cb; ++j) {
+                result(code, i * cb + j) = a * B(codeB, j);
+            }
+        }
+    }
+    out = result;
+}
+
+template <int N>
+void contractFixed(const ContractArgs& args, Eigen::MatrixXd& out) {
+    constexpr int rows = 1 << N;
+    const Eigen::Map<const Eigen::Matrix<double, rows, Eigen::Dynamic>> M(args.M->data(), rows, args.M->cols());
+
+    // 保留编码不超过 2^N 个，只用结果的前 2^keptCount 行
+    FixedRowsMatrix<N> result = FixedRowsMatrix<N>::Zero(rows, M.cols());
+    for (int r = 0; r < rows; ++r) {
+        int kept = 0;
+        double w = 1.0;
+        for (int p = 0; p < N; ++p) {
+            const int bit = (r >> p) & 1;
+            if (args.opv[p]) {
+                w *= (*args.opv[p])(bit);
+            } else {
+                kept += bit * args.keepMul[p];
+            }
+        }
+        if (w != 0.0) {
+            result.row(kept) += w * M.row(r);
+        }
+    }
+    out = result.topRows(1 << args.keptCount);
+}
+
+using CombineFn = void (*)(const CombineArgs&, Eigen::MatrixXd&);
+using ContractFn = void (*)(const ContractArgs&, Eigen::MatrixXd&);
+
+template <int... Ns>
+constexpr std::array<CombineFn, sizeof...(Ns)> makeCombineTable(std::integer_sequence<int, Ns...>) {
+    return {{&combineFixed<Ns>...}};
+}
+
+template <int... Ns>
+constexpr std::array<ContractFn, sizeof...(Ns)> makeContractTable(std::integer_sequence<int, Ns...>) {
+    return {{&contractFixed<Ns>...}};
+}
+
+inline const std::array<CombineFn, kMaxFixedFsL + 1>& combineTable() {
+    static constexpr auto table = makeCombineTable(std::make_integer_sequence<int, kMaxFixedFsL + 1>{});
+    return table;
+}
+
+inline const std::array<ContractFn, kMaxFixedFsL + 1>& contractTable() {
+    static constexpr auto table = makeContractTable(std::make_integer_sequence<int, kMaxFixedFsL + 1>{});
+    return table;
+}
+
+// 子矩阵的行数必须与其 fsL 长度匹配 (fsL 为空时只使用第 0 行)
+inline bool rowsMatchFsL(const Eigen::MatrixXd& M, size_t fsLen) {
+    if (M.rows() == 0) return false;
+    if (fsLen == 0) return true;
+    return M.rows() == (Eigen::Index(1) << fsLen);
+}
+
+// 计算 sub 中每个元素在合并列表 com 中对应的位权
+inline void fillBitWeights(const std::vector<int>& com, const std::vector<int>& sub,
+                           std::array<int, kMaxFixedFsL>& mul) {
+    const int n = static_cast<int>(com.size());
+    const int m = static_cast<int>(sub.size());
+    mul.fill(0);
+    for (int i = 0; i < m; ++i) {
+        int pos = -1;
+        for (int k = 0; k < n; ++k) {
+            if (com[k] == sub[i]) { pos = k; break; }
+        }
+        if (pos < 0) continue;
+        mul[n - 1 - pos] += 1 << (m - 1 - i);
+    }
+}
+
+// 合并分派：成功时返回 true；规模或列数超出特化范围、矩阵形状不规则时返回 false
+inline bool combine(const Eigen::MatrixXd& A, const std::vector<int>& fsA,
+                    const Eigen::MatrixXd& B, const std::vector<int>& fsB,
+                    const std::vector<int>& comFsL, Eigen::MatrixXd& out) {
+    const size_t n = comFsL.size();
+    if (n > static_cast<size_t>(kMaxFixedFsL) || A.cols() * B.cols() > kMaxFixedCols) return false;
+    if (!rowsMatchFsL(A, fsA.size()) || !rowsMatchFsL(B, fsB.size())) return false;
+
+    CombineArgs args;
+    args.A = &A;
+    args.B = &B;
+    fillBitWeights(comFsL, fsA, args.mulA);
+    fillBitWeights(comFsL, fsB, args.mulB);
+    combineTable()[n](args, out);
+    return true;
+}
+
+// 约简分派：opv 按 fsL 位置给出被约去源的概率向量 (保留源为 nullptr)
+inline bool contract(const Eigen::MatrixXd& M, const std::vector<const Eigen::Vector2d*>& opv,
+                     Eigen::MatrixXd& out) {
+    const size_t n = opv.size();
+    if (n > static_cast<size_t>(kMaxFixedFsL) || M.cols() > kMaxFixedCols) return false;
+    if (M.rows() != (Eigen::Index(1) << n)) return false;
+
+    ContractArgs args;
+    args.M = &M;
+    args.opv.fill(nullptr);
+    args.keepMul.fill(0);
+
+    int kept = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!opv[i]) ++kept;
+    }
+    args.keptCount = kept;
+
+    int k = kept;
+    for (size_t i = 0; i < n; ++i) {
+        const int p = static_cast<int>(n - 1 - i);
+        if (opv[i]) {
+            args.opv[p] = opv[i];
+        } else {
+            args.keepMul[p] = 1 << (--k);
+        }
+    }
+    contractTable()[n](args, out);
+    return true;
+}
+
+} // namespace fstra_kernels
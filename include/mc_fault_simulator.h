@@ -4,10 +4,14 @@
 
 #include "circuit_simulator.h"
 #include "fault_injector.h"
-#include <random>
+#include "fault_site_sampler.h"
+#include "philox_rng.h"
+#include <chrono>
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 #include <functional>
+#include <limits>
 
 class MCFaultSimulator {
 public:
@@ -15,8 +19,8 @@ public:
     struct FaultStatistics {
         int cycle;
         int node_id;
-        int count_0;
-        int count_1;
+        int64_t count_0;
+        int64_t count_1;
         
         double probability_0() const { 
             return (count_0 + count_1) > 0 ? 
@@ -29,6 +33,35 @@ public:
         }
     };
     
+    // PO 失效统计：故障场景中该周期 PO 值与无故障值不同的次数
+    struct POStatistics {
+        int cycle;
+        int po_index;
+        long long failures;
+        long long trials;
+        double ci_half_width;         // 失效概率置信区间半宽
+        
+        double failure_probability() const {
+            return trials > 0 ? static_cast<double>(failures) / trials : 0.0;
+        }
+        double reliability() const { return 1.0 - failure_probability(); }
+    };
+    
+    // 稀有失效估计：重要性抽样/分层抽样给出的 PO 失效概率
+    struct RareEventEstimate {
+        int cycle;
+        int po_index;
+        double probability;
+        double std_error;
+        double truncation;            // 分层抽样未覆盖的故障数层的总概率 (估计偏差上界)
+        long long trials;
+        
+        double relative_error() const {
+            return probability > 0.0 ? std_error / probability : std::numeric_limits<double>::infinity();
+        }
+        double reliability() const { return 1.0 - probability; }
+    };
+    
     // 趋势概率向量
     struct TrendProbability {
         int node_id;
@@ -41,18 +74,62 @@ public:
     
     // 算法4：蒙特卡洛故障注入仿真
     std::vector<TrendProbability> run_mc_simulations(
-        int n_sim,                    // 仿真次数
+        long long n_sim,              // 仿真次数
         int k_cycles,                 // 周期数
         const std::vector<std::vector<bool>>& input_sequence, // 输入序列
         double fault_prob = 0.01,     // 故障概率
         const std::vector<int>& low_priority_nodes = {}); // 低优先级节点
     
+    // 重要性抽样：以抬高的故障率 biased_prob 仿真，每个场景按似然比
+    // (eps/q)^k ((1-eps)/(1-q))^(N-k) 加权，k 为到该周期为止注入的故障数、N 为故障位置数。
+    // biased_prob <= 0 时取 max(eps, 1/N)，即每个场景期望约一个故障
+    std::vector<std::vector<RareEventEstimate>> run_importance_sampling(
+        int n_sim,
+        int k_cycles,
+        const std::vector<std::vector<bool>>& input_sequence,
+        double fault_prob,
+        double biased_prob = 0.0,
+        double relative_tolerance = 0.0);   // > 0 时所有非零估计的 z*se/p 达标即停止
+    
+    // 分层抽样：按整个仿真中注入的故障总数 k 分层，层内每个场景恰好注入 k 个均匀分布的
+    // 故障，P(fail) = sum_k Binom(k; N, eps) P(fail | k)。max_faults <= 0 时自动取到
+    // 未覆盖的层总概率不超过 1e-6 * P(K >= 1)
+    std::vector<std::vector<RareEventEstimate>> run_stratified_sampling(
+        int n_sim,
+        int k_cycles,
+        const std::vector<std::vector<bool>>& input_sequence,
+        double fault_prob,
+        int max_faults = 0,
+        double relative_tolerance = 0.0);
+    
+    // 每个机器字并行仿真的故障场景数 (64 或 256)
+    void set_lanes(int lanes) { words_ = lanes > 64 ? 4 : 1; }
+    int get_lanes() const { return words_ * 64; }
+    
+    // 自适应停止：每个周期每个 PO 的失效概率置信区间半宽都不超过 tolerance，
+    // 或用时超过 time_budget_seconds 时提前结束，n_sim 作为上限；两者 <= 0 时按固定 n_sim。
+    // z 为置信水平对应的正态分位数 (1.96 即 95%)
+    void set_adaptive_stopping(double tolerance, double time_budget_seconds = 0.0, double z = 1.96);
+    long long get_trials_run() const { return trials_run_; }   // 最近一次实际仿真的场景数
+    
+    // 随机数种子；同一种子下结果与线程数无关
+    void set_seed(uint64_t seed) { seed_ = seed; scalar_trials_ = 0; }
+    uint64_t get_seed() const { return seed_; }
+    
+    // 最近一次 run_mc_simulations 的 PO 失效统计，按 [cycle][po]
+    const std::vector<std::vector<POStatistics>>& get_po_statistics() const { return po_statistics_; }
+    
     // 获取趋势概率向量
     std::unordered_map<int, std::pair<double, double>> 
     get_low_priority_trend_vectors(int k_cycles, double priority_threshold = 0.1);
     
-    // 计算节点优先级（基于论文公式3-7）
+    // 计算节点优先级（基于论文公式3-7），按与门节点号，归一化到 [0, 1]
     std::unordered_map<int, double> calculate_gate_priorities(int k_cycles = 1);
+    // 优先级低于阈值的与门，按节点号升序；可直接作为 run_mc_simulations 的 low_priority_nodes
+    std::vector<int> get_low_priority_nodes(double priority_threshold = 0.1);
+    // 每个与门的扇出源列表长度 (论文公式3)、到 PO/寄存器输入的最长路径 (不可观测为 -1)
+    std::unordered_map<int, double> get_fanout_source_lengths();
+    std::unordered_map<int, int> get_topological_distances();
     
     // 保存结果
     void save_results(const std::string& filename);
@@ -62,27 +139,106 @@ public:
     
 private:
     CircuitReliabilitySimulator& simulator_;
-    std::mt19937 rng_;
-    std::uniform_real_distribution<double> dist_;
+    uint64_t seed_;
+    uint32_t scalar_trials_;          // inject_random_faults 已用的流数
+    
+    int words_;                       // 每个节点的 64 位字数
+    FaultSiteSampler sampler_;
+    
+    double tolerance_;
+    double time_budget_;
+    double z_;
+    long long trials_run_;
     
     // 仿真结果存储
     std::unordered_map<int, std::vector<FaultStatistics>> statistics_;
+    std::vector<std::vector<POStatistics>> po_statistics_;
     
     // 趋势概率向量
     std::unordered_map<int, std::vector<TrendProbability>> trend_probabilities_;
     
-    // 辅助函数
+    // 在线均值/方差 (Welford)，每批的失效比例为一个样本
+    struct RunningStat {
+        long long count = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        
+        void add(double x) {
+            count++;
+            const double delta = x - mean;
+            mean += delta / count;
+            m2 += delta * (x - mean);
+        }
+        double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    };
+    static constexpr int kRoundBatches = 16;   // 每轮的批数，与线程数无关
+    
+    static double binomial_variance(long long failures, long long trials);
+    double half_width(const RunningStat& stat, long long failures, long long trials) const;
+    double max_half_width(const std::vector<RunningStat>& stats,
+                          const std::vector<long long>& failures, long long trials) const;
+    
+    // 不与门号冲突的流号
+    static constexpr uint32_t kSiteStream = 0xFFFFFFFFu;     // 整串位置的几何跳跃
+    static constexpr uint32_t kScalarStream = 0xFFFFFFFEu;   // inject_random_faults
+    static constexpr uint32_t kStrataStream = 0xFFFFFFFDu;   // 分层抽样的故障位置
+    
+    // 加权批次：故障来源与 PO 失效的加权累计
+    struct WeightedBatch {
+        const std::vector<uint64_t>* sites = nullptr;   // 预先给定的故障位置 (周期, 门, 场景位) 展平升序；空则按 sampler_ 抽样
+        double log_fault = 0.0;                         // 每个故障位置的对数似然比
+        double log_clean = 0.0;                         // 每个无故障位置的对数似然比
+        double* po_weight = nullptr;                    // [cycle * num_pos + po] 失效场景的权重和
+        double* po_weight_sq = nullptr;                 // 权重平方和
+    };
+    
+    // 与 run_mc_simulations 相同的轮次/并行约定运行 batches 批 (共 n_trials 个场景)。
+    // setup 准备每批的 WeightedBatch，batch_done 按批号顺序收到每批的权重和，
+    // round_done 在每轮后调用，返回 true 时停止
+    void run_weighted_batches(const LevelizedAIG& aig, int batches, long long n_trials, int k_cycles,
+                              const std::vector<std::vector<bool>>& input_sequence,
+                              const std::vector<bool>& initial_state,
+                              const std::vector<uint8_t>& golden_po,
+                              const std::function<void(int, std::vector<uint64_t>&, WeightedBatch&)>& setup,
+                              const std::function<void(int, const double*, const double*)>& batch_done,
+                              const std::function<bool(int)>& round_done);
+    bool rare_event_converged(const std::vector<std::vector<RareEventEstimate>>& estimates,
+                              double relative_tolerance,
+                              std::chrono::steady_clock::time_point start) const;
+    
+    const LevelizedAIG& prepare_simulation(int k_cycles,
+                                           const std::vector<std::vector<bool>>& input_sequence,
+                                           std::vector<bool>& initial_state,
+                                           std::vector<uint8_t>& golden_po);
+    
     void inject_random_faults(FaultInjector& fault_injector, double fault_prob);
-    std::vector<bool> simulate_cycle_with_faults(
-        const std::vector<bool>& inputs,
-        FaultInjector& fault_injector,
-        int cycle);
-    
-    // 优先级计算辅助函数
-    double calculate_py_pre(int node_id, int cycle);
-    double calculate_py_suc(int node_id, int cycle);
-    std::unordered_map<int, double> get_fanout_source_lengths();
-    std::unordered_map<int, int> get_topological_distances();
+    void simulate_golden(const LevelizedAIG& aig, int k_cycles,
+                         const std::vector<std::vector<bool>>& input_sequence,
+                         const std::vector<bool>& initial_state,
+                         std::vector<uint8_t>& golden_po);
+    template <int W>
+    void simulate_batch(const LevelizedAIG& aig, int batch, int k_cycles,
+                        const std::vector<std::vector<bool>>& input_sequence,
+                        const std::vector<bool>& initial_state,
+                        const std::vector<uint8_t>& golden_po,
+                        const std::vector<uint32_t>& monitored,
+                        const uint64_t* valid, long long* node_ones,   // [cycle * monitored + i]
+                        long long* po_failures,                         // [cycle * num_pos + po]
+                        const WeightedBatch* weighted = nullptr) const;
+    
+    // 结构优先级：只依赖网络结构，按电路缓存，节点数或门数变化时重算
+    struct StructuralPriorities {
+        uint32_t num_nodes = 0;
+        size_t num_gates = 0;
+        std::vector<uint32_t> fanout_sources;   // 节点号 -> 扇出源列表长度，超过 kMaxFanoutSources 时饱和
+        std::vector<int> distances;             // 节点号 -> 到 PO/寄存器输入的最长路径，不可观测为 -1
+        std::vector<double> priorities;         // 节点号 -> 归一化优先级，非门为 0
+    };
+    StructuralPriorities structure_;
+    static constexpr size_t kMaxFanoutSources = 32;
+    static constexpr double kFanoutDecay = 0.8;   // py_pre 沿扇入的衰减，与 FSTRAAnalyzer::calPriorities 一致
+    
+    const StructuralPriorities& structural_priorities();
 };
 
 #endif // MC_FAULT_SIMULATOR_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// ==================== 计数器型随机数 (Philox4x32-10) ====================
+//
+// 随机数是 (key, counter) 的纯函数：key 取种子，counter 的前三个字标识一条流
+// (如 批次/周期/节点)，第四个字是流内的块号。不同流互不相关，也不需要共享状态，
+// 任意线程按任意顺序生成同一条流都得到相同结果，因此并行蒙特卡洛的结果只由种子
+// 决定，与线程数无关。
+//
+// 每块输出 4 个 32 位字；生成时一次算 kBlocks 块，按结构数组排布让编译器向量化。
+
+class Philox4x32 {
+public:
+    static constexpr int kRounds = 10;
+
+    // 对 N 个计数器分别求一块输出；ctr[i][j] 为第 j 个计数器的第 i 个字，结果写回 ctr
+    template <int N>
+    static void blocks(uint32_t ctr[4][N], uint32_t key0, uint32_t key1) {
+        for (int r = 0; r < kRounds; ++r) {
+            for (int j = 0; j < N; ++j) {
+                const uint64_t p0 = uint64_t(kMul0) * ctr[0][j];
+                const uint64_t p1 = uint64_t(kMul1) * ctr[2][j];
+                const uint32_t x0 = uint32_t(p1 >> 32) ^ ctr[1][j] ^ key0;
+                const uint32_t x1 = uint32_t(p1);
+                const uint32_t x2 = uint32_t(p0 >> 32) ^ ctr[3][j] ^ key1;
+                const uint32_t x3 = uint32_t(p0);
+                ctr[0][j] = x0;
+                ctr[1][j] = x1;
+                ctr[2][j] = x2;
+                ctr[3][j] = x3;
+            }
+            key0 += kWeyl0;
+            key1 += kWeyl1;
+        }
+    }
+
+    static void block(uint32_t out[4], const uint32_t in[4], uint32_t key0, uint32_t key1) {
+        uint32_t ctr[4][1] = {{in[0]}, {in[1]}, {in[2]}, {in[3]}};
+        blocks<1>(ctr, key0, key1);
+        for (int i = 0; i < 4; ++i) out[i] = ctr[i][0];
+    }
+
+private:
+    static constexpr uint32_t kMul0 = 0xD2511F53u;
+    static constexpr uint32_t kMul1 = 0xCD9E8D57u;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+};
+
+// 一条 64 位随机数流，满足 UniformRandomBitGenerator，可直接用于 <random> 分布
+// 和 FaultSiteSampler。流号 (a, b, c) 由调用方按 (试验, 周期, 节点) 等编排。
+class PhiloxStream {
+public:
+    using result_type = uint64_t;
+    static constexpr int kBlocks = 4;                    // 每次生成的块数
+    static constexpr int kBuffer = kBlocks * 2;          // 每块两个 64 位数
+
+    PhiloxStream(uint64_t seed, uint32_t a, uint32_t b = 0, uint32_t c = 0)
+        : key0_(uint32_t(seed)), key1_(uint32_t(seed >> 32)), a_(a), b_(b), c_(c),
+          next_block_(0), pos_(kBuffer) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        if (pos_ == kBuffer) refill();
+        return buffer_[pos_++];
+    }
+
+    // 连续取 n 个数，与逐个调用 operator() 的结果相同
+    void fill(uint64_t* out, size_t n) {
+        while (n > 0) {
+            if (pos_ == kBuffer) refill();
+            const size_t take = std::min<size_t>(n, kBuffer - pos_);
+            for (size_t i = 0; i < take; ++i) out[i] = buffer_[pos_ + i];
+            pos_ += static_cast<int>(take);
+            out += take;
+            n -= take;
+        }
+    }
+
+private:
+    uint32_t key0_, key1_;
+    uint32_t a_, b_, c_;
+    uint32_t next_block_;      // 流内下一个块号
+    int pos_;
+    uint64_t buffer_[kBuffer];
+
+    void refill() {
+        uint32_t ctr[4][kBlocks];
+        for (int j = 0; j < kBlocks; ++j) {
+            ctr[0][j] = next_block_ + j;
+            ctr[1][j] = a_;
+            ctr[2][j] = b_;
+            ctr[3][j] = c_;
+        }
+        Philox4x32::blocks<kBlocks>(ctr, key0_, key1_);
+        for (int j = 0; j < kBlocks; ++j) {
+            buffer_[2 * j] = uint64_t(ctr[0][j]) | (uint64_t(ctr[1][j]) << 32);
+            buffer_[2 * j + 1] = uint64_t(ctr[2][j]) | (uint64_t(ctr[3][j]) << 32);
+        }
+        next_block_ += kBlocks;
+        pos_ = 0;
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "aig_bit_simulator.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ==================== 多周期瞬态翻转 (SEU) 仿真 ====================
+//
+// 在第 t 周期翻转一个寄存器 (周期开始时的状态) 或一个与门 (只在该周期) 的值，
+// 从 t 起逐周期仿真，与无故障轨迹比较：
+//   任一 PO 与无故障值不同 -> 失效，延迟为所在周期减 t；
+//   某周期末寄存器状态回到无故障值 -> 之后与无故障完全相同，记为被屏蔽并立即停止；
+//   到序列末尾或跟踪上限仍未失效也未收敛 -> 潜伏。
+// 同一注入周期的 64 个场景占一个 64 位字的各位，整字全部结束即提前退出。
+// 场景组之间相互独立，按组并行 (OpenMP)，结果与线程数无关。
+
+class SEUCampaign {
+public:
+    enum class Outcome : uint8_t { Masked, Failure, Latent };
+
+    // 注入点：node 为寄存器输出节点或与门节点，cycle 从 0 起
+    struct Injection {
+        uint32_t node;
+        int cycle;
+    };
+
+    struct InjectionResult {
+        Injection injection;
+        Outcome outcome = Outcome::Latent;
+        int latency = -1;          // 失效：到首个 PO 差异的周期数；屏蔽：到状态恢复的周期数
+    };
+
+    // 每个注入点在所有注入周期上的汇总
+    struct TargetStats {
+        uint32_t node;
+        int register_index;        // 寄存器序号，与门为 -1
+        long long injections = 0;
+        long long failures = 0;
+        long long latent = 0;
+        double mean_failure_latency = 0.0;
+
+        // 易损因子：翻转导致失效的比例
+        double vulnerability() const { return injections > 0 ? static_cast<double>(failures) / injections : 0.0; }
+    };
+
+    explicit SEUCampaign(const LevelizedAIG& aig);
+
+    // input_sequence[c][i] 为第 c 周期 PI i 的值；initial_state 按寄存器序号，为空时全 0
+    bool set_stimulus(const std::vector<std::vector<bool>>& input_sequence,
+                      const std::vector<bool>& initial_state = {});
+    // 注入后最多跟踪的周期数，<= 0 时跟踪到序列末尾
+    void set_horizon(int cycles) { horizon_ = cycles; }
+
+    bool run(const std::vector<Injection>& injections);
+    // 所有寄存器 (include_gates 时再加所有与门) 在给定周期上的翻转
+    bool run_all(const std::vector<int>& cycles, bool include_gates = false);
+
+    const std::vector<InjectionResult>& get_results() const { return results_; }
+    // 寄存器在前 (按寄存器序号)，与门在后 (按节点号)
+    std::vector<TargetStats> get_target_stats() const;
+    // 下标为延迟 (周期数)
+    std::vector<long long> get_failure_latency_histogram() const;
+    std::vector<long long> get_convergence_histogram() const;
+    // 实际仿真的 场景*周期 数，与不提前停止时的对比反映收敛检测的收益
+    long long get_simulated_lane_cycles() const { return simulated_lane_cycles_; }
+    long long get_full_lane_cycles() const { return full_lane_cycles_; }
+
+    void print_summary() const;
+    bool write_report(const std::string& filename) const;
+
+private:
+    LevelizedAIG aig_;
+    std::vector<int> register_of_node_;     // 节点号 -> 寄存器序号，非寄存器为 -1
+    std::vector<uint32_t> gate_of_node_;    // 节点号 -> aig_.gates 中的序号，非门为 UINT32_MAX
+    int horizon_;
+
+    std::vector<std::vector<bool>> inputs_;
+    std::vector<uint8_t> golden_state_;     // [cycle * ros + r]，第 cycle 周期开始时的状态，共 cycles+1 组
+    std::vector<uint8_t> golden_po_;        // [cycle * pos + po]
+
+    std::vector<InjectionResult> results_;
+    long long simulated_lane_cycles_;
+    long long full_lane_cycles_;
+
+    int num_cycles() const { return static_cast<int>(inputs_.size()); }
+    // 一个周期的组合求值；flips 为 (门序号, 翻转位) 且按门序号升序
+    void evaluate(std::vector<uint64_t>& values, int cycle, const uint64_t* state,
+                  const std::vector<std::pair<uint32_t, uint64_t>>& flips) const;
+    // 同一周期注入的至多 64 个场景
+    long long simulate_group(const uint32_t* group, size_t size, std::vector<uint64_t>& values);
+};
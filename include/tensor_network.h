@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <unordered_map>
+#include <vector>
+
+// ==================== 二值变量张量网络 ====================
+//
+// 把一个周期的电路看作张量网络：每个节点的取值是一个 0/1 变量，
+// 门 PTM、PI/寄存器的概率向量都是定义在若干变量上的非负张量 (因子)。
+// 求某个变量的边缘分布时，先裁剪出它的扇入锥，再按启发式选出的
+// 消元次序逐个求和消去其余变量。与按拓扑顺序传播相比，对重汇聚结构
+// 选择合适的次序可以把中间张量的宽度从指数级降下来。
+//
+// 当消元宽度超过 maxWidth 时进入近似模式：选择最宽一步中出现次数最多的
+// 变量，把它的各个下游因子分别用该变量的先验 (波形统计概率) 求和消去，
+// 即 FSTRA 中 tb_rm_FsL 的近似方式，然后重新选择次序。没有可切断的变量
+// (都已切断或没有先验) 而宽度仍超过 maxWidth 时，marginal 报错并返回 false。
+
+class TensorNetwork {
+public:
+    enum class OrderHeuristic {
+        Topological,   // 按变量编号从小到大 (mockturtle 节点编号即拓扑序)
+        MinSize,       // 贪心：每步消去生成张量最小的变量
+        MinFill        // 贪心：每步消去在交互图中新增边最少的变量 (树宽导向)
+    };
+
+    struct Factor {
+        std::vector<int> vars;       // 升序排列，vars[i] 对应 table 下标的第 i 位
+        std::vector<double> table;   // 大小为 2^vars.size()
+        int owner;                   // 由该因子定义取值的变量，-1 表示中间结果
+    };
+
+    struct ContractionStats {
+        int width;        // 最大中间张量涉及的变量数
+        int cuts;         // 近似模式下被先验替代的变量个数
+        double flops;     // 乘加次数估计
+    };
+
+    TensorNetwork();
+
+    void clear();
+
+    // vars 不要求有序，table 的下标按传入的 vars 顺序以第 0 个变量为最高位编码
+    bool addFactor(const std::vector<int>& vars, const std::vector<double>& table, int owner);
+
+    // 近似模式中可被切断的变量及其先验分布
+    void setCutPrior(int var, const Eigen::Vector2d& prior) { cutPriors_[var] = prior; }
+
+    void setOrderHeuristic(OrderHeuristic h) { heuristic_ = h; }
+    void setMaxWidth(int w) { maxWidth_ = w; }
+
+    // 计算 query 的边缘分布 (未归一化，结果为 [P(0), P(1)])；宽度无法降到 maxWidth 以内时返回 false
+    bool marginal(int query, Eigen::Vector2d& result);
+
+    // 只计算消元次序与宽度，不做数值缩并
+    std::vector<int> eliminationOrder(int query, int& width) const;
+
+    const ContractionStats& lastStats() const { return stats_; }
+    size_t numFactors() const { return factors_.size(); }
+
+private:
+    std::vector<Factor> factors_;
+    std::unordered_map<int, Eigen::Vector2d> cutPriors_;
+    OrderHeuristic heuristic_;
+    int maxWidth_;
+    ContractionStats stats_;
+
+    std::vector<int> collectCone(int query) const;
+    std::vector<int> planOrder(const std::vector<Factor>& factors, int query,
+                               int& width, std::vector<int>& widestScope) const;
+    static void eliminate(std::vector<Factor>& factors, int var, double& flops);
+    static void absorbPrior(Factor& f, int var, const Eigen::Vector2d& prior);
+};
@@ -13,6 +13,16 @@
 #include <cmath>
 #include <cctype>
 #include <algorithm>
+#include <memory>
+#include <unordered_set>
+#include <fnmatch.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "vcd_tokenizer.h"
+#include "vcd_waveform_store.h"
+#include "vcd_waveform_cache.h"
 
 // ==================== 基础数据结构 ====================
 
@@ -135,6 +145,147 @@ struct VCDIdealOutputVector {
     }
 };
 
+// ==================== 只读查询快照 ====================
+//
+// VCDParser::freeze() 把压缩后的波形和周期/PO/节点索引复制成一个不可变对象，
+// 所有查询都是 const 且不修改任何状态，多个线程可以同时采样而不需要加锁。
+// 快照与解析器相互独立，之后重新解析或 reset() 不影响已发出的快照。
+
+class VCDQuerySnapshot {
+private:
+    VCDWaveformStore store_;
+    std::vector<size_t> cycle_sample_idx_;   // 周期号 -> 采样点下标 (SIZE_MAX 表示无)
+    std::vector<int> slot_width_;            // 信号编号 -> 位宽
+    std::vector<int> node_slot_;             // 网表节点号 N -> signal_N 的信号编号
+    std::vector<int> indexed_nodes_;
+    std::vector<int> po_slot_;               // PO 序号 -> 信号编号 (-1 表示不存在)
+    int num_cycles_;
+
+    friend class VCDParser;
+
+    static void toProbability(uint8_t v, double& prob_0, double& prob_1) {
+        switch (v) {
+            case VCDWaveformStore::kValue0: prob_0 = 1.0; prob_1 = 0.0; break;
+            case VCDWaveformStore::kValue1: prob_0 = 0.0; prob_1 = 1.0; break;
+            default:                        prob_0 = 0.5; prob_1 = 0.5; break;
+        }
+    }
+
+    bool sampleIndex(int cycle_num, size_t& sample_idx) const {
+        if (cycle_num < 0 || cycle_num >= (int)cycle_sample_idx_.size()) return false;
+        sample_idx = cycle_sample_idx_[cycle_num];
+        return sample_idx != SIZE_MAX;
+    }
+
+    int nodeSlot(int node_index) const {
+        if (node_index < 0 || node_index >= (int)node_slot_.size()) return -1;
+        return node_slot_[node_index];
+    }
+
+public:
+    VCDQuerySnapshot() : num_cycles_(0) {}
+
+    int numCycles() const { return num_cycles_; }
+    int numPOs() const { return po_slot_.size(); }
+    bool hasCycle(int cycle_num) const {
+        size_t idx;
+        return sampleIndex(cycle_num, idx);
+    }
+    const std::vector<int>& getIndexedNodes() const { return indexed_nodes_; }
+    size_t memoryBytes() const { return store_.memoryBytes(); }
+
+    // 与 VCDParser::getPOOutputFromWaveform 相同的语义，出错时不打印
+    bool getPOOutput(int po_index, int cycle_num,
+                     std::vector<double>& prob_0, std::vector<double>& prob_1) const {
+        size_t sample_idx;
+        if (!sampleIndex(cycle_num, sample_idx)) return false;
+        if (po_index < 0 || po_index >= (int)po_slot_.size() || po_slot_[po_index] < 0) return false;
+
+        const int slot = po_slot_[po_index];
+        double p0, p1;
+        toProbability(store_.valueAtIndex(slot, sample_idx), p0, p1);
+        prob_0.assign(slot_width_[slot], p0);
+        prob_1.assign(slot_width_[slot], p1);
+        return true;
+    }
+
+    bool getPOProbability(int po_index, int cycle_num, double& prob_0, double& prob_1) const {
+        size_t sample_idx;
+        if (!sampleIndex(cycle_num, sample_idx)) return false;
+        if (po_index < 0 || po_index >= (int)po_slot_.size() || po_slot_[po_index] < 0) return false;
+        toProbability(store_.valueAtIndex(po_slot_[po_index], sample_idx), prob_0, prob_1);
+        return true;
+    }
+
+    bool getNodeOutputByIndex(int node_index, int cycle_num, double& prob_0, double& prob_1) const {
+        size_t sample_idx;
+        const int slot = nodeSlot(node_index);
+        if (slot < 0 || !sampleIndex(cycle_num, sample_idx)) return false;
+        toProbability(store_.valueAtIndex(slot, sample_idx), prob_0, prob_1);
+        return true;
+    }
+
+    VCDValue getNodeValue(int node_index, int cycle_num) const {
+        size_t sample_idx;
+        const int slot = nodeSlot(node_index);
+        if (slot < 0 || !sampleIndex(cycle_num, sample_idx)) return VCDValue::VCD_ERROR;
+        switch (store_.valueAtIndex(slot, sample_idx)) {
+            case VCDWaveformStore::kValue0: return VCDValue::VCD_0;
+            case VCDWaveformStore::kValue1: return VCDValue::VCD_1;
+            case VCDWaveformStore::kValueZ: return VCDValue::VCD_Z;
+            default:                        return VCDValue::VCD_X;
+        }
+    }
+};
+
+// ==================== 信号统计 ====================
+//
+// VCDParser::computeSignalStatistics 单遍扫描得到的稠密统计结果。列为 VCD 中声明的信号，
+// 周期号从 1 开始，窗口 w 覆盖周期 [w*window_cycles+1, (w+1)*window_cycles]。
+// 采样点与 getPOOutputFromWaveform 相同 (时钟上升沿时刻，含该时刻的变化)，X/Z 按 P(1)=0.5 计。
+
+struct VCDSignalStatistics {
+    int num_cycles;
+    int window_cycles;
+    int num_windows;
+    std::vector<std::string> names;            // 列 -> 信号完整名
+    std::vector<int> node_column;              // 网表节点号 N -> signal_N 所在列 (-1 表示无)
+    std::vector<uint8_t> cycle_values;         // [(周期-1) * 列数 + 列]，0/1/2=X；未保留时为空
+    std::vector<float> window_p1;              // [窗口 * 列数 + 列]，窗口内各周期 P(1) 的平均
+    std::vector<uint32_t> window_toggles;      // [窗口 * 列数 + 列]，窗口内 0/1 翻转次数
+    std::vector<double> total_p1;              // 全部周期的平均 P(1)
+    std::vector<uint64_t> total_toggles;
+
+    VCDSignalStatistics() : num_cycles(0), window_cycles(1), num_windows(0) {}
+
+    int numSignals() const { return names.size(); }
+
+    int columnOfNode(int node_index) const {
+        if (node_index < 0 || node_index >= (int)node_column.size()) return -1;
+        return node_column[node_index];
+    }
+
+    int windowOfCycle(int cycle_num) const { return (cycle_num - 1) / window_cycles; }
+
+    // 某周期的 P(1)：window_average 为真时取所在窗口的平均值
+    bool probability(int column, int cycle_num, bool window_average, double& p1) const {
+        if (column < 0 || column >= numSignals() || cycle_num < 1 || cycle_num > num_cycles) return false;
+        if (window_average) {
+            p1 = window_p1[(size_t)windowOfCycle(cycle_num) * numSignals() + column];
+            return true;
+        }
+        if (cycle_values.empty()) return false;
+        uint8_t v = cycle_values[(size_t)(cycle_num - 1) * numSignals() + column];
+        p1 = v == 1 ? 1.0 : (v == 0 ? 0.0 : 0.5);
+        return true;
+    }
+
+    double toggleRate(int column) const {
+        if (column < 0 || column >= numSignals() || num_cycles == 0) return 0.0;
+        return double(total_toggles[column]) / num_cycles;
+    }
+};
+
 // ==================== VCD解析器主类 ====================
 
 class VCDParser {
@@ -151,9 +302,8 @@ private:
     std::unordered_map<std::string, VCDSignal> signals_by_id_;
     std::unordered_map<std::string, VCDSignal> signals_by_fullname_;
     
-    // 值变化
-    std::map<uint64_t, std::vector<VCDValueChange>> value_changes_;
-    std::vector<VCDWaveformSample> waveform_;
+    // 值变化：按信号存储的变化序列，信号编号即 id_strings_ 的下标
+    VCDWaveformStore waveform_store_;
     std::vector<VCDCycle> cycles_;
     
     // 配置
@@ -185,6 +335,44 @@ private:
     
     ParserState current_state_;
     
+    // 映射解析模式：标识符码解码为整数后查表，避免逐条变化做字符串哈希
+    std::unordered_map<std::string, int> id_to_slot_;  // 标识符 -> 信号编号 (查询及逐行解析使用)
+    bool use_mapped_io_;
+    bool defer_waveform_;                            // 解析后不立即重建波形，首次查询时再重建
+    
+    // 查询索引：周期、PO、网表节点到采样点/信号编号的映射，提取周期后一次性建立
+    bool index_built_;
+    std::vector<size_t> cycle_sample_idx_;           // 周期号 -> 采样点下标 (SIZE_MAX 表示无)
+    std::vector<int> slot_width_;                    // 信号编号 -> 位宽
+    std::vector<int> node_slot_;                     // 网表节点号 N -> signal_N 的信号编号
+    std::vector<int> indexed_nodes_;
+    std::vector<int> po_slot_;                       // PO 序号 -> 信号编号 (-2 未解析, -1 不存在)
+    std::shared_ptr<const VCDQuerySnapshot> snapshot_;  // 最近一次 freeze() 的结果
+    std::vector<int> id_slot_;                       // 标识符码 -> id_strings_ 下标
+    std::unordered_map<uint64_t, int> id_slot_overflow_;  // 超出直接索引范围的标识符码
+    std::vector<std::string> id_strings_;
+    static constexpr uint64_t kDirectIdSlots = 1u << 20;
+    
+    // 信号过滤：只保留匹配的信号，其余信号的值变化在分词时直接丢弃
+    bool filter_enabled_;
+    std::vector<std::string> filter_patterns_;       // glob，匹配基础名或完整名
+    std::unordered_set<std::string> filter_ids_;     // 显式指定的标识符
+    size_t skipped_signals_;
+    
+    int parse_threads_;                              // 值变化部分的解析线程数，1 为顺序解析，0 为 OpenMP 默认
+    static constexpr size_t kMinParseChunk = 4u << 20;
+    
+    // 二进制波形缓存
+    bool cache_enabled_;
+    bool cache_hit_;                                 // 最近一次 parseFile 是否直接装载了缓存
+    std::string cache_path_;                         // 为空时使用 <vcd>.fwc
+    vcd_cache::FileKey cache_key_;                   // 当前数据对应的源文件键
+    std::string cached_clock_id_;                    // 缓存中时钟边沿对应的时钟信号
+    std::vector<uint64_t> cached_clock_edges_;
+    
+    // 周期窗口加载：窗口之前的时钟上升沿个数，提取周期时作为周期号的起点
+    int cycle_base_;
+    
     // ==================== 辅助函数 ====================
     
     void reset() {
@@ -195,8 +383,7 @@ private:
         
         signals_by_id_.clear();
         signals_by_fullname_.clear();
-        value_changes_.clear();
-        waveform_.clear();
+        waveform_store_.clear();
         cycles_.clear();
         
         clock_signal_id_.clear();
@@ -209,6 +396,113 @@ private:
         current_date_content_.clear();
         current_version_content_.clear();
         current_timescale_content_.clear();
+        
+        id_slot_.clear();
+        id_slot_overflow_.clear();
+        id_strings_.clear();
+        id_to_slot_.clear();
+        skipped_signals_ = 0;
+        cache_key_ = vcd_cache::FileKey();
+        cached_clock_id_.clear();
+        cached_clock_edges_.clear();
+        cycle_base_ = 0;
+        invalidateQueryIndex();
+    }
+    
+    void invalidateQueryIndex() {
+        index_built_ = false;
+        cycle_sample_idx_.clear();
+        slot_width_.clear();
+        node_slot_.clear();
+        indexed_nodes_.clear();
+        po_slot_.clear();
+        snapshot_.reset();
+    }
+    
+    static uint8_t packValue(VCDValue val) {
+        switch (val) {
+            case VCDValue::VCD_0: return VCDWaveformStore::kValue0;
+            case VCDValue::VCD_1: return VCDWaveformStore::kValue1;
+            case VCDValue::VCD_Z: return VCDWaveformStore::kValueZ;
+            default: return VCDWaveformStore::kValueX;   // X 与无法识别的值查询时处理相同
+        }
+    }
+    
+    static VCDValue unpackValue(uint8_t v) {
+        switch (v) {
+            case VCDWaveformStore::kValue0: return VCDValue::VCD_0;
+            case VCDWaveformStore::kValue1: return VCDValue::VCD_1;
+            case VCDWaveformStore::kValueZ: return VCDValue::VCD_Z;
+            default: return VCDValue::VCD_X;
+        }
+    }
+    
+    int newSlot(const std::string& identifier) {
+        int slot = id_strings_.size();
+        id_strings_.push_back(identifier);
+        id_to_slot_[identifier] = slot;
+        return slot;
+    }
+    
+    // 标识符 -> 信号编号；被过滤的标识符返回 -1，过滤开启时未声明的标识符也不分配编号
+    int slotForIdentifier(const std::string& identifier) {
+        auto it = id_to_slot_.find(identifier);
+        if (it != id_to_slot_.end()) return it->second;
+        if (filter_enabled_) {
+            id_to_slot_[identifier] = -1;
+            return -1;
+        }
+        return newSlot(identifier);
+    }
+    
+    bool isSignalSelected(const VCDSignal& signal) const {
+        if (!filter_enabled_) return true;
+        if (filter_ids_.count(signal.identifier)) return true;
+        for (const auto& pattern : filter_patterns_) {
+            if (fnmatch(pattern.c_str(), signal.basename.c_str(), 0) == 0 ||
+                fnmatch(pattern.c_str(), signal.name.c_str(), 0) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // 记录 $var 声明：被选中的信号分配编号并登记，未选中的只标记为跳过。
+    // 同一标识符可被多个 $var 引用 (别名)，任一别名被选中即保留
+    void declareSignal(const VCDSignal& signal) {
+        if (!isSignalSelected(signal)) {
+            if (!id_to_slot_.count(signal.identifier)) id_to_slot_[signal.identifier] = -1;
+            skipped_signals_++;
+            return;
+        }
+        
+        auto it = id_to_slot_.find(signal.identifier);
+        if (it == id_to_slot_.end() || it->second < 0) {
+            newSlot(signal.identifier);
+            uncacheIdentifier(signal.identifier);
+        }
+        signals_by_id_[signal.identifier] = signal;
+        signals_by_fullname_[signal.name] = signal;
+    }
+    
+    // 清除标识符码缓存中的条目，下次查找时回到 id_to_slot_
+    void uncacheIdentifier(const std::string& identifier) {
+        uint64_t code = vcd_tokenizer::decodeIdentifier(identifier.data(), identifier.size());
+        if (code < kDirectIdSlots) {
+            if (code < id_slot_.size()) id_slot_[code] = -1;
+        } else if (code != UINT64_MAX) {
+            id_slot_overflow_.erase(code);
+        }
+    }
+    
+    int findSlot(const std::string& identifier) const {
+        auto it = id_to_slot_.find(identifier);
+        return it != id_to_slot_.end() ? it->second : -1;
+    }
+    
+    // 采样点 sample_idx 处某个标识符的值
+    VCDValue sampleValue(const std::string& identifier, size_t sample_idx) const {
+        return unpackValue(waveform_store_.valueAtIndex(findSlot(identifier), sample_idx));
     }
     
     static std::string trim(const std::string& str) {
@@ -330,8 +624,7 @@ private:
         signal.name = signal.getFullName();
         
         // 存储信号
-        signals_by_id_[identifier] = signal;
-        signals_by_fullname_[signal.name] = signal;
+        declareSignal(signal);
         
         // 调试输出已注释
         // std::cout << "解析信号: " << signal.toString() << std::endl;
@@ -342,23 +635,13 @@ private:
         if (line.empty()) return;
         
         if (line[0] == 'b' || line[0] == 'B') {
-            // 二进制向量值
+            // 二进制向量值，取最高位
             size_t space_pos = line.find(' ');
             if (space_pos != std::string::npos) {
                 std::string value_str = line.substr(1, space_pos - 1);
                 std::string identifier = trim(line.substr(space_pos + 1));
-                
-                VCDValueChange change;
-                change.timestamp = 0;
-                change.identifier = identifier;
-                change.vector_value = value_str;
-                change.is_vector = true;
-                
-                if (!value_str.empty()) {
-                    change.value = char_to_vcd_value(value_str[0]);
-                }
-                
-                value_changes_[0].push_back(change);
+                VCDValue value = value_str.empty() ? VCDValue::VCD_X : char_to_vcd_value(value_str[0]);
+                waveform_store_.append(slotForIdentifier(identifier), 0, packValue(value));
             }
         } else if (line[0] == 'r' || line[0] == 'R') {
             // 实数，跳过
@@ -367,16 +650,8 @@ private:
         } else {
             // 标量值
             if (line.length() > 1) {
-                char value_char = line[0];
                 std::string identifier = trim(line.substr(1));
-                
-                VCDValueChange change;
-                change.timestamp = 0;
-                change.identifier = identifier;
-                change.value = char_to_vcd_value(value_char);
-                change.is_vector = false;
-                
-                value_changes_[0].push_back(change);
+                waveform_store_.append(slotForIdentifier(identifier), 0, packValue(char_to_vcd_value(line[0])));
             }
         }
     }
@@ -399,23 +674,13 @@ private:
         
         // 值变化
         if (line[0] == 'b' || line[0] == 'B') {
-            // 二进制向量
+            // 二进制向量，取最高位
             size_t space_pos = line.find(' ');
             if (space_pos != std::string::npos) {
                 std::string value_str = line.substr(1, space_pos - 1);
                 std::string identifier = trim(line.substr(space_pos + 1));
-                
-                VCDValueChange change;
-                change.timestamp = current_timestamp_;
-                change.identifier = identifier;
-                change.vector_value = value_str;
-                change.is_vector = true;
-                
-                if (!value_str.empty()) {
-                    change.value = char_to_vcd_value(value_str[0]);
-                }
-                
-                value_changes_[current_timestamp_].push_back(change);
+                VCDValue value = value_str.empty() ? VCDValue::VCD_X : char_to_vcd_value(value_str[0]);
+                waveform_store_.append(slotForIdentifier(identifier), current_timestamp_, packValue(value));
             }
         } else if (line[0] == 'r' || line[0] == 'R') {
             // 实数，跳过
@@ -424,16 +689,9 @@ private:
         } else {
             // 标量值
             if (line.length() > 1) {
-                char value_char = line[0];
                 std::string identifier = trim(line.substr(1));
-                
-                VCDValueChange change;
-                change.timestamp = current_timestamp_;
-                change.identifier = identifier;
-                change.value = char_to_vcd_value(value_char);
-                change.is_vector = false;
-                
-                value_changes_[current_timestamp_].push_back(change);
+                waveform_store_.append(slotForIdentifier(identifier), current_timestamp_,
+                                       packValue(char_to_vcd_value(line[0])));
             }
         }
         
@@ -534,59 +792,1151 @@ private:
                     break;
             }
         }
-    }
-    
-    // 解析值变化主体部分
-    bool parseBodyLine(const std::string& line) {
-        if (line.empty()) return true;
+    }
+    
+    // 解析值变化主体部分
+    bool parseBodyLine(const std::string& line) {
+        if (line.empty()) return true;
+        
+        // 检查是否是新命令
+        if (line[0] == '$') {
+            if (line.find("$dumpvars") == 0) {
+                current_state_ = ParserState::IN_DUMPVARS;
+            } else if (line.find("$comment") == 0) {
+                // 跳过注释
+                current_state_ = ParserState::IN_COMMENT;
+            } else if (line.find("$end") == 0) {
+                // 结束当前段
+                if (current_state_ == ParserState::IN_DUMPVARS) {
+                    current_state_ = ParserState::IN_BODY;
+                } else if (current_state_ == ParserState::IN_COMMENT) {
+                    current_state_ = ParserState::IN_BODY;
+                }
+            }
+            return true;
+        }
+        
+        // 根据当前状态处理
+        switch (current_state_) {
+            case ParserState::IN_DUMPVARS:
+                parseInitialValue(line);
+                break;
+            case ParserState::IN_BODY:
+                return parseValueChange(line);
+            default:
+                // 忽略
+                break;
+        }
+        
+        return true;
+    }
+    
+    // 标识符记号 -> 槽位，规则同 slotForIdentifier；标识符码缓存中 -2 表示已被过滤
+    int lookupIdSlot(const vcd_tokenizer::Token& tok) {
+        uint64_t code = vcd_tokenizer::decodeIdentifier(tok.ptr, tok.len);
+        if (code < kDirectIdSlots) {
+            if (code >= id_slot_.size()) id_slot_.resize(code + 1, -1);
+            int& slot = id_slot_[code];
+            if (slot == -1) {
+                int s = slotForIdentifier(tok.str());
+                slot = s < 0 ? -2 : s;
+            }
+            return slot < 0 ? -1 : slot;
+        }
+        
+        // 超长标识符直接按字符串查找
+        if (code == UINT64_MAX) return slotForIdentifier(tok.str());
+        
+        auto it = id_slot_overflow_.find(code);
+        if (it != id_slot_overflow_.end()) return it->second;
+        int slot = slotForIdentifier(tok.str());
+        id_slot_overflow_[code] = slot;
+        return slot;
+    }
+    
+    // 解析 $var 记号序列: $var type width identifier reference... $end
+    void parseVarTokens(vcd_tokenizer::Tokenizer& tz) {
+        vcd_tokenizer::Token tok;
+        std::vector<vcd_tokenizer::Token> tokens;
+        while (tz.next(tok) && !tok.equals("$end")) {
+            tokens.push_back(tok);
+        }
+        
+        if (tokens.size() < 4) {
+            std::cerr << "警告：变量定义格式错误" << std::endl;
+            return;
+        }
+        
+        VCDSignal signal;
+        signal.type = tokens[0].str();
+        uint64_t width = 1;
+        if (!vcd_tokenizer::parseUnsigned(tokens[1].ptr, tokens[1].len, width)) {
+            std::cerr << "警告：无法解析宽度: " << tokens[1].str() << std::endl;
+            width = 1;
+        }
+        signal.width = static_cast<int>(width);
+        signal.identifier = tokens[2].str();
+        
+        std::string reference;
+        for (size_t i = 3; i < tokens.size(); i++) {
+            if (!reference.empty()) reference += " ";
+            reference.append(tokens[i].ptr, tokens[i].len);
+        }
+        signal.reference = reference;
+        signal.basename = reference;
+        signal.scope = getCurrentScopePath();
+        signal.name = signal.getFullName();
+        
+        declareSignal(signal);
+    }
+    
+    // 读取 $date/$version/$timescale 等段的内容直到 $end
+    std::string collectSection(vcd_tokenizer::Tokenizer& tz) {
+        std::string content;
+        vcd_tokenizer::Token tok;
+        while (tz.next(tok) && !tok.equals("$end")) {
+            content += " ";
+            content.append(tok.ptr, tok.len);
+        }
+        return content;
+    }
+
+    // 解析定义部分直到 $enddefinitions，tz 停在值变化部分的开头
+    void parseHeaderTokens(vcd_tokenizer::Tokenizer& tz) {
+        vcd_tokenizer::Token tok;
+        while (current_state_ != ParserState::IN_BODY && tz.next(tok)) {
+            if (tok.equals("$date")) {
+                date_ = collectSection(tz);
+            } else if (tok.equals("$version")) {
+                version_ = collectSection(tz);
+            } else if (tok.equals("$timescale")) {
+                timescale_ = collectSection(tz);
+                parseTimescale(timescale_);
+            } else if (tok.equals("$scope")) {
+                vcd_tokenizer::Token type_tok, name_tok;
+                if (tz.next(type_tok) && !type_tok.equals("$end") && tz.next(name_tok)) {
+                    if (!name_tok.equals("$end")) {
+                        current_scope_.push_back(name_tok.str());
+                        tz.skipToEnd();
+                    }
+                }
+            } else if (tok.equals("$upscope")) {
+                if (!current_scope_.empty()) current_scope_.pop_back();
+                tz.skipToEnd();
+            } else if (tok.equals("$var")) {
+                parseVarTokens(tz);
+            } else if (tok.equals("$enddefinitions")) {
+                tz.skipToEnd();
+                current_state_ = ParserState::IN_BODY;
+            } else if (tok.ptr[0] == '$' && !tok.equals("$end")) {
+                // $comment 以及未知段整体跳过
+                tz.skipToEnd();
+            }
+        }
+    }
+    
+    // 解析 [begin, end) 范围内的值变化，slot_of(Token) 给出标识符对应的信号编号，
+    // 变化交给 sink.append(slot, time, value) (VCDWaveformStore 或统计用的累加器)。
+    // time / state 为进入该范围时的当前时间与解析状态，返回时更新为结束时的值
+    template <typename Sink, typename SlotFn>
+    bool parseBodyRange(const char* begin, const char* end, Sink& store,
+                        uint64_t& time, ParserState& state, SlotFn&& slot_of) const {
+        vcd_tokenizer::Tokenizer tz(begin, end);
+        vcd_tokenizer::Token tok;
+        
+        // 标量变化约占 3~6 字节
+        store.reserveChanges((end - begin) / 6);
+        while (tz.next(tok)) {
+            const char c = tok.ptr[0];
+            
+            if (c == '#') {
+                uint64_t t;
+                if (!vcd_tokenizer::parseUnsigned(tok.ptr + 1, tok.len - 1, t)) {
+                    std::cerr << "错误：无法解析时间戳: " << tok.str() << std::endl;
+                    return false;
+                }
+                time = t * timescale_multiplier_;
+                continue;
+            }
+            
+            if (c == '$') {
+                if (tok.equals("$dumpvars")) {
+                    state = ParserState::IN_DUMPVARS;
+                } else if (tok.equals("$comment")) {
+                    tz.skipToEnd();
+                } else if (tok.equals("$end")) {
+                    state = ParserState::IN_BODY;
+                }
+                continue;
+            }
+            
+            // $dumpvars 中的初值统一记录在时间 0
+            const uint64_t t = (state == ParserState::IN_DUMPVARS) ? 0 : time;
+            
+            if (c == 'b' || c == 'B') {
+                vcd_tokenizer::Token id_tok;
+                if (!tz.next(id_tok)) break;
+                
+                // 向量取最高位
+                VCDValue value = tok.len > 1 ? char_to_vcd_value(tok.ptr[1]) : VCDValue::VCD_X;
+                store.append(slot_of(id_tok), t, packValue(value));
+            } else if (c == 'r' || c == 'R' || c == 's' || c == 'S') {
+                // 实数/字符串，跳过其标识符
+                vcd_tokenizer::Token id_tok;
+                if (!tz.next(id_tok)) break;
+            } else if (tok.len > 1) {
+                store.append(slot_of(vcd_tokenizer::Token(tok.ptr + 1, tok.len - 1)), t,
+                             packValue(char_to_vcd_value(c)));
+            }
+        }
+        return true;
+    }
+    
+    // 统计扫描的累加器：按时间块 (同一时间戳的全部变化) 提交信号值，
+    // 块结束时判断时钟上升沿并对所有信号采样，与波形存储的去重规则一致 (同一时刻取最后的值)
+    struct StatisticsSink {
+        VCDSignalStatistics& stats;
+        int clock_slot;
+        bool keep_cycles;
+        std::vector<uint8_t> committed;     // 上一个时间块结束时的值
+        std::vector<uint8_t> current;       // 当前时间块中的最新值
+        std::vector<int> dirty;             // 当前块中发生变化的信号
+        std::vector<uint8_t> is_dirty;
+        std::vector<uint32_t> pending_toggles;  // 尚未归入窗口的翻转 (属于下一个周期)
+        std::vector<int> toggled;           // pending_toggles 非零的信号
+        std::vector<double> window_sum;     // 当前窗口的 P(1) 累加
+        std::vector<uint8_t> edge_sample;   // 最近一次上升沿的采样，周期在下一次上升沿时确定
+        uint64_t block_time;
+        bool started;
+        long long edges;
+        
+        StatisticsSink(VCDSignalStatistics& s, int num_slots, int clock, bool keep)
+            : stats(s), clock_slot(clock), keep_cycles(keep),
+              committed(num_slots, VCDWaveformStore::kValueX), current(num_slots, VCDWaveformStore::kValueX),
+              is_dirty(num_slots, 0), pending_toggles(num_slots, 0), window_sum(num_slots, 0.0),
+              block_time(0), started(false), edges(0) {}
+        
+        void reserveChanges(size_t) {}
+        
+        void append(int slot, uint64_t time, uint8_t value) {
+            if (slot < 0 || slot >= (int)current.size()) return;
+            if (started && time != block_time) closeBlock();
+            block_time = time;
+            started = true;
+            current[slot] = value;
+            if (!is_dirty[slot]) {
+                is_dirty[slot] = 1;
+                dirty.push_back(slot);
+            }
+        }
+        
+        void closeBlock() {
+            bool rising = false;
+            if (clock_slot >= 0) {
+                rising = committed[clock_slot] == VCDWaveformStore::kValue0 &&
+                         current[clock_slot] == VCDWaveformStore::kValue1;
+            }
+            
+            // 上升沿结束上一个周期 (第一个上升沿之前的翻转不属于任何周期)，本块的翻转计入新周期
+            if (rising) {
+                if (edges > 0) emitCycle();
+                for (int slot : toggled) pending_toggles[slot] = 0;
+                toggled.clear();
+            }
+            
+            for (int slot : dirty) {
+                uint8_t a = committed[slot], b = current[slot];
+                if (a != b && a <= 1 && b <= 1) {
+                    if (pending_toggles[slot]++ == 0) toggled.push_back(slot);
+                }
+                committed[slot] = b;
+                is_dirty[slot] = 0;
+            }
+            dirty.clear();
+            
+            if (rising) {
+                edge_sample = committed;
+                edges++;
+            }
+        }
+        
+        // 周期号 = edges，采样值为该周期起始上升沿处的值
+        void emitCycle() {
+            const int n = committed.size();
+            const int cycle = edges;
+            const int window = (cycle - 1) / stats.window_cycles;
+            if (window >= stats.num_windows) {
+                stats.num_windows = window + 1;
+                stats.window_p1.resize((size_t)stats.num_windows * n, 0.0f);
+                stats.window_toggles.resize((size_t)stats.num_windows * n, 0);
+            }
+            if (keep_cycles) {
+                stats.cycle_values.insert(stats.cycle_values.end(), edge_sample.begin(), edge_sample.end());
+            }
+            for (int slot = 0; slot < n; slot++) {
+                uint8_t v = edge_sample[slot];
+                double p1 = v == VCDWaveformStore::kValue1 ? 1.0 : (v == VCDWaveformStore::kValue0 ? 0.0 : 0.5);
+                window_sum[slot] += p1;
+                stats.total_p1[slot] += p1;
+            }
+            for (int slot : toggled) {
+                stats.window_toggles[(size_t)window * n + slot] += pending_toggles[slot];
+                stats.total_toggles[slot] += pending_toggles[slot];
+            }
+            stats.num_cycles = cycle;
+            
+            // 窗口的最后一个周期：写入平均值
+            if (cycle % stats.window_cycles == 0) flushWindow(window, stats.window_cycles);
+        }
+        
+        void flushWindow(int window, int count) {
+            const int n = committed.size();
+            for (int slot = 0; slot < n; slot++) {
+                stats.window_p1[(size_t)window * n + slot] = window_sum[slot] / count;
+                window_sum[slot] = 0.0;
+            }
+        }
+        
+        // 扫描结束：收尾最后一个时间块；最后一个上升沿之后没有完整周期，其翻转丢弃
+        void finish() {
+            if (started) closeBlock();
+            const int n = committed.size();
+            int partial = stats.num_cycles % stats.window_cycles;
+            if (partial > 0) flushWindow(stats.num_windows - 1, partial);
+            for (int slot = 0; slot < n && stats.num_cycles > 0; slot++) {
+                stats.total_p1[slot] /= stats.num_cycles;
+            }
+        }
+    };
+    
+    // 把 id_to_slot_ 中的全部标识符填入标识符码缓存，之后可以只读地并发查找
+    void fillIdentifierCache() {
+        for (const auto& kv : id_to_slot_) {
+            const std::string& id = kv.first;
+            uint64_t code = vcd_tokenizer::decodeIdentifier(id.data(), id.size());
+            int cached = kv.second < 0 ? -2 : kv.second;
+            if (code < kDirectIdSlots) {
+                if (code >= id_slot_.size()) id_slot_.resize(code + 1, -1);
+                id_slot_[code] = cached;
+            } else if (code != UINT64_MAX) {
+                id_slot_overflow_[code] = kv.second;
+            }
+        }
+    }
+    
+    // 只查已声明的标识符，不分配新编号
+    int lookupDeclaredSlot(const vcd_tokenizer::Token& tok) const {
+        uint64_t code = vcd_tokenizer::decodeIdentifier(tok.ptr, tok.len);
+        if (code < kDirectIdSlots && code < id_slot_.size() && id_slot_[code] != -1) {
+            return id_slot_[code] < 0 ? -1 : id_slot_[code];
+        }
+        auto it = id_to_slot_.find(tok.str());
+        return it != id_to_slot_.end() ? it->second : -1;
+    }
+    
+    bool parseBody(const char* begin, const char* end) {
+        int threads = parse_threads_;
+#ifdef _OPENMP
+        if (threads <= 0) threads = omp_get_max_threads();
+#else
+        threads = 1;
+#endif
+        
+        // 分段边界取在时间戳行上；$comment 中可能出现以 '#' 开头的行，此时不分段
+        size_t chunks = std::min<size_t>(threads * 2, (end - begin) / kMinParseChunk);
+        if (threads > 1 && chunks > 1 &&
+            memmem(begin, end - begin, "$comment", 8) == nullptr) {
+            return parseBodyParallel(begin, end, chunks);
+        }
+        
+        return parseBodyRange(begin, end, waveform_store_, current_timestamp_, current_state_,
+                              [this](const vcd_tokenizer::Token& tok) { return lookupIdSlot(tok); });
+    }
+    
+    // 分段并行解析：各段写入自己的构建缓冲，按段顺序合并。
+    // 标识符查表只读；段内遇到未声明的标识符先占位，合并后顺序分配编号
+    bool parseBodyParallel(const char* begin, const char* end, size_t chunks) {
+        std::vector<const char*> bounds{begin};
+        for (size_t k = 1; k < chunks; k++) {
+            const char* target = begin + (end - begin) * k / chunks;
+            const char* b = vcd_tokenizer::findTimestampLine(std::max(target, bounds.back()) - 1, end);
+            if (b >= end) break;
+            if (b > bounds.back()) bounds.push_back(b);
+        }
+        bounds.push_back(end);
+        chunks = bounds.size() - 1;
+        
+        // 已声明标识符全部填入标识符码缓存，解析期间只读
+        fillIdentifierCache();
+        
+        struct Chunk {
+            VCDWaveformStore store;
+            std::vector<std::pair<size_t, std::string>> pending;   // (变化序号, 未声明的标识符)
+            uint64_t time;
+            ParserState state;
+            bool ok;
+        };
+        std::vector<Chunk> parts(chunks);
+        
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t k = 0; k < chunks; k++) {
+            Chunk& part = parts[k];
+            part.time = current_timestamp_;
+            part.state = current_state_;
+            part.ok = parseBodyRange(bounds[k], bounds[k + 1], part.store, part.time, part.state,
+                [&](const vcd_tokenizer::Token& tok) -> int {
+                    uint64_t code = vcd_tokenizer::decodeIdentifier(tok.ptr, tok.len);
+                    int slot = -1;
+                    if (code < id_slot_.size()) {
+                        slot = id_slot_[code];
+                    } else if (code >= kDirectIdSlots) {
+                        auto it = code == UINT64_MAX ? id_slot_overflow_.end() : id_slot_overflow_.find(code);
+                        if (it != id_slot_overflow_.end()) {
+                            slot = it->second;
+                        } else {
+                            auto jt = id_to_slot_.find(tok.str());
+                            if (jt != id_to_slot_.end()) slot = jt->second < 0 ? -2 : jt->second;
+                        }
+                    }
+                    if (slot >= 0) return slot;
+                    if (slot == -2 || filter_enabled_) return -1;
+                    part.pending.emplace_back(part.store.pendingChanges(), tok.str());
+                    return 0;
+                });
+        }
+        
+        for (size_t k = 0; k < chunks; k++) {
+            if (!parts[k].ok) return false;
+            size_t base = waveform_store_.pendingChanges();
+            waveform_store_.append(parts[k].store);
+            for (const auto& pe : parts[k].pending) {
+                waveform_store_.setSignal(base + pe.first, slotForIdentifier(pe.second));
+            }
+            current_timestamp_ = parts[k].time;
+            current_state_ = parts[k].state;
+        }
+        return true;
+    }
+
+    // ==================== 二进制缓存 ====================
+    
+    std::string cacheFilePath() const {
+        return cache_path_.empty() ? filename_ + ".fwc" : cache_path_;
+    }
+    
+    // 信号过滤设置不同则缓存内容不同，作为键的一部分
+    uint64_t filterHash() const {
+        uint64_t h = vcd_cache::fnv1a(&filter_enabled_, sizeof(filter_enabled_));
+        for (const auto& pattern : filter_patterns_) {
+            h = vcd_cache::fnv1a(pattern.data(), pattern.size() + 1, h);
+        }
+        std::vector<std::string> ids(filter_ids_.begin(), filter_ids_.end());
+        std::sort(ids.begin(), ids.end());
+        for (const auto& id : ids) {
+            h = vcd_cache::fnv1a(id.data(), id.size() + 1, h);
+        }
+        return h;
+    }
+    
+    static void writeSignal(vcd_cache::Writer& w, const VCDSignal& signal) {
+        w.str(signal.identifier);
+        w.str(signal.type);
+        w.str(signal.reference);
+        w.str(signal.basename);
+        w.str(signal.scope);
+        w.pod<int32_t>(signal.width);
+    }
+    
+    static bool readSignal(vcd_cache::Reader& r, VCDSignal& signal) {
+        int32_t width = 1;
+        if (!r.str(signal.identifier) || !r.str(signal.type) || !r.str(signal.reference) ||
+            !r.str(signal.basename) || !r.str(signal.scope) || !r.pod(width)) {
+            return false;
+        }
+        signal.width = width;
+        signal.name = signal.getFullName();
+        return true;
+    }
+    
+    // 写入缓存：先写临时文件再改名，中途失败不会留下损坏的缓存
+    bool writeWaveformCache() {
+        if (!waveform_store_.finalized() || cache_key_.size == 0) return false;
+        
+        const std::string path = cacheFilePath();
+        const std::string tmp = path + ".tmp";
+        vcd_cache::Writer w(tmp);
+        if (!w.good()) {
+            std::cerr << "警告：无法写入波形缓存: " << tmp << std::endl;
+            return false;
+        }
+        
+        w.bytes(vcd_cache::kMagic, sizeof(vcd_cache::kMagic));
+        w.pod(vcd_cache::kVersion);
+        w.pod(cache_key_);
+        w.pod(filterHash());
+        w.pod(timescale_multiplier_);
+        w.str(date_);
+        w.str(version_);
+        w.str(timescale_);
+        w.pod<uint64_t>(skipped_signals_);
+        
+        // 信号表：按标识符与按完整名两张表 (别名在后者中各占一项)
+        w.pod<uint64_t>(signals_by_id_.size());
+        for (const auto& kv : signals_by_id_) writeSignal(w, kv.second);
+        w.pod<uint64_t>(signals_by_fullname_.size());
+        for (const auto& kv : signals_by_fullname_) writeSignal(w, kv.second);
+        
+        // 信号编号 -> 标识符
+        w.pod<uint64_t>(id_strings_.size());
+        for (const auto& id : id_strings_) w.str(id);
+        
+        waveform_store_.save(w);
+        
+        // 时钟周期索引 (上升沿时间)
+        w.str(cached_clock_id_);
+        w.array(cached_clock_edges_);
+        
+        bool ok = w.good();
+        w.close();
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            std::cerr << "警告：无法写入波形缓存: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    bool loadWaveformCache(const std::string& filename, const vcd_cache::FileKey& key) {
+        filename_ = filename;
+        vcd_tokenizer::MappedFile mf;
+        if (!mf.open(cacheFilePath())) return false;
+        
+        vcd_cache::Reader r(mf.data(), mf.end());
+        char magic[sizeof(vcd_cache::kMagic)];
+        uint32_t version = 0;
+        vcd_cache::FileKey stored_key;
+        uint64_t filter_hash = 0;
+        if (!r.bytes(magic, sizeof(magic)) || std::memcmp(magic, vcd_cache::kMagic, sizeof(magic)) != 0 ||
+            !r.pod(version) || version != vcd_cache::kVersion ||
+            !r.pod(stored_key) || stored_key != key ||
+            !r.pod(filter_hash) || filter_hash != filterHash()) {
+            return false;
+        }
+        
+        reset();
+        filename_ = filename;
+        
+        uint64_t skipped = 0, count = 0;
+        bool ok = r.pod(timescale_multiplier_) && r.str(date_) && r.str(version_) &&
+                  r.str(timescale_) && r.pod(skipped);
+        skipped_signals_ = skipped;
+        
+        if (ok && r.pod(count)) {
+            for (uint64_t i = 0; ok && i < count; i++) {
+                VCDSignal signal;
+                ok = readSignal(r, signal);
+                if (ok) signals_by_id_[signal.identifier] = signal;
+            }
+        }
+        if (ok && r.pod(count)) {
+            for (uint64_t i = 0; ok && i < count; i++) {
+                VCDSignal signal;
+                ok = readSignal(r, signal);
+                if (ok) signals_by_fullname_[signal.name] = signal;
+            }
+        }
+        if (ok && r.pod(count)) {
+            for (uint64_t i = 0; ok && i < count; i++) {
+                std::string id;
+                ok = r.str(id);
+                if (ok) newSlot(id);
+            }
+        }
+        
+        ok = ok && r.ok() && waveform_store_.load(r) && waveform_store_.numSignals() == id_strings_.size() &&
+             r.str(cached_clock_id_) && r.array(cached_clock_edges_);
+        if (!ok) {
+            std::cerr << "警告：波形缓存损坏，重新解析: " << cacheFilePath() << std::endl;
+            reset();
+            return false;
+        }
+        
+        cache_key_ = key;
+        current_state_ = ParserState::IN_BODY;
+        return true;
+    }
+
+    // ==================== 时间戳定位索引 ====================
+    //
+    // 每 interval 个时间戳行记一个检查点：该行的字节偏移、之前最后一个时间戳、
+    // 此前的时钟上升沿个数以及此刻所有信号的值 (2 bit)。按周期窗口加载时从
+    // 最近的检查点恢复信号状态，只解析窗口覆盖的字节范围。
+    
+    struct SeekCheckpoint {
+        uint64_t offset;                 // '#' 行在文件中的字节偏移
+        uint64_t state_time;             // 该行之前的最后一个时间戳
+        uint64_t edges_before;           // offset 之前的时钟上升沿个数
+        std::vector<uint8_t> state;      // 每个信号 2 bit，顺序同索引中的标识符表
+    };
+    
+    static constexpr char kSeekMagic[8] = {'F', 'S', 'T', 'R', 'A', 'W', 'F', 'I'};
+    static constexpr uint32_t kSeekVersion = 1;
+    
+    std::string seekIndexPath() const { return filename_ + ".fwi"; }
+    
+    bool writeSeekIndex(const vcd_cache::FileKey& key, const std::string& clock_name, uint64_t interval,
+                        const std::vector<std::string>& ids, const std::vector<SeekCheckpoint>& checkpoints) {
+        const std::string path = seekIndexPath();
+        const std::string tmp = path + ".tmp";
+        vcd_cache::Writer w(tmp);
+        
+        w.bytes(kSeekMagic, sizeof(kSeekMagic));
+        w.pod(kSeekVersion);
+        w.pod(key);
+        w.pod(filterHash());
+        w.str(clock_name);
+        w.pod(interval);
+        w.pod<uint64_t>(ids.size());
+        for (const auto& id : ids) w.str(id);
+        w.pod<uint64_t>(checkpoints.size());
+        for (const auto& cp : checkpoints) {
+            w.pod(cp.offset);
+            w.pod(cp.state_time);
+            w.pod(cp.edges_before);
+            w.array(cp.state);
+        }
+        
+        bool ok = w.good();
+        w.close();
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            std::cerr << "警告：无法写入定位索引: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    bool loadSeekIndex(const vcd_cache::FileKey& key, const std::string& clock_name,
+                       std::vector<std::string>& ids, std::vector<SeekCheckpoint>& checkpoints) {
+        vcd_tokenizer::MappedFile mf;
+        if (!mf.open(seekIndexPath())) return false;
+        
+        vcd_cache::Reader r(mf.data(), mf.end());
+        char magic[sizeof(kSeekMagic)];
+        uint32_t version = 0;
+        vcd_cache::FileKey stored_key;
+        uint64_t filter_hash = 0, interval = 0, count = 0;
+        std::string stored_clock;
+        if (!r.bytes(magic, sizeof(magic)) || std::memcmp(magic, kSeekMagic, sizeof(magic)) != 0 ||
+            !r.pod(version) || version != kSeekVersion ||
+            !r.pod(stored_key) || stored_key != key ||
+            !r.pod(filter_hash) || filter_hash != filterHash() ||
+            !r.str(stored_clock) || stored_clock != clock_name || !r.pod(interval)) {
+            return false;
+        }
+        
+        bool ok = r.pod(count);
+        ids.assign(ok ? std::min<uint64_t>(count, mf.size()) : 0, std::string());
+        for (size_t i = 0; ok && i < ids.size(); i++) ok = r.str(ids[i]);
+        
+        ok = ok && r.pod(count) && count <= mf.size();
+        checkpoints.assign(ok ? count : 0, SeekCheckpoint());
+        for (size_t i = 0; ok && i < checkpoints.size(); i++) {
+            SeekCheckpoint& cp = checkpoints[i];
+            ok = r.pod(cp.offset) && r.pod(cp.state_time) && r.pod(cp.edges_before) && r.array(cp.state) &&
+                 cp.state.size() == (ids.size() + 3) / 4;
+        }
+        if (!ok) {
+            std::cerr << "警告：定位索引损坏，重新建立: " << seekIndexPath() << std::endl;
+        }
+        return ok;
+    }
+
+    // 按名称规则查找 PO 对应的信号标识符 (poN / po_N / *.uut.poN / signal_N)，找不到返回空串
+    std::string resolvePOIdentifier(int po_index) const {
+        // 查找PO信号的标识符
+        std::vector<std::string> possible_po_names = {
+            "po" + std::to_string(po_index),
+            "po_" + std::to_string(po_index)
+        };
+        
+        // 如果有uut前缀，也检查
+        std::vector<std::string> possible_po_names_with_uut;
+        for (const auto& name : possible_po_names) {
+            possible_po_names_with_uut.push_back("uut." + name);
+            possible_po_names_with_uut.push_back("tb_top.uut." + name);
+        }
+        
+        possible_po_names.insert(possible_po_names.end(), 
+                                possible_po_names_with_uut.begin(), 
+                                possible_po_names_with_uut.end());
+        
+        std::string po_identifier;
+        for (const auto& po_name : possible_po_names) {
+            // 查找信号
+            for (const auto& kv : signals_by_id_) {
+                if (kv.second.name.find(po_name) != std::string::npos) {
+                    po_identifier = kv.first;
+                    // std::cout << "找到PO信号: " << kv.second.name 
+                    //           << " (ID: " << po_identifier << ")" << std::endl;
+                    break;
+                }
+            }
+            if (!po_identifier.empty()) break;
+        }
+        
+        if (po_identifier.empty()) {
+            // 尝试更宽松的匹配
+            // std::cout << "尝试更宽松的信号匹配..." << std::endl;
+            for (const auto& kv : signals_by_id_) {
+                const std::string& basename = kv.second.basename;
+                
+                // 检查是否是PO信号
+                if (basename.find("po") == 0 || basename.find("signal_") == 0) {
+                    // 提取数字
+                    std::string num_str;
+                    if (basename.find("po") == 0) {
+                        num_str = basename.substr(2);
+                    } else if (basename.find("signal_") == 0) {
+                        num_str = basename.substr(7);
+                    }
+                    
+                    try {
+                        int signal_num = std::stoi(num_str);
+                        if (signal_num == po_index) {
+                            po_identifier = kv.first;
+                            // std::cout << "通过宽松匹配找到PO信号: " << name 
+                            //           << " (ID: " << po_identifier << ")" << std::endl;
+                            break;
+                        }
+                    } catch (...) {
+                        // 转换失败，继续
+                    }
+                }
+            }
+        }
+        
+        if (po_identifier.empty()) {
+            
+            // 显示所有可能的PO信号以供调试
+            // std::cout << "可用信号列表 (可能包含PO):" << std::endl;
+            for (const auto& kv : signals_by_fullname_) {
+                if (kv.second.basename.find("po") == 0 || 
+                    kv.second.basename.find("signal_") == 0) {
+                    // std::cout << "  " << kv.first << " (basename: " 
+                    //           << kv.second.basename << ")" << std::endl;
+                }
+            }
+        }
+        
+        return po_identifier;
+    }
+    
+    static void valueToProbability(VCDValue val, double& prob_0, double& prob_1) {
+        switch (val) {
+            case VCDValue::VCD_0: prob_0 = 1.0; prob_1 = 0.0; break;
+            case VCDValue::VCD_1: prob_0 = 0.0; prob_1 = 1.0; break;
+            default:              prob_0 = 0.5; prob_1 = 0.5; break;
+        }
+    }
+    
+    static void fillProbabilities(VCDValue val, int width,
+                                  std::vector<double>& prob_0, std::vector<double>& prob_1) {
+        double p0, p1;
+        valueToProbability(val, p0, p1);
+        prob_0.assign(width, p0);
+        prob_1.assign(width, p1);
+    }
+    
+    // 确保波形已压缩、周期已提取，并建立查询索引
+    bool ensureQueryIndex() {
+        if (index_built_) return true;
+        
+        if (!waveform_store_.finalized()) {
+            if (!reconstructWaveform()) {
+                return false;
+            }
+        }
+        
+        if (cycles_.empty() && !waveform_store_.empty()) {
+            if (!extractClockCycles()) {
+                return false;
+            }
+        }
+        
+        if (cycles_.empty()) {
+            std::cerr << "错误：没有周期数据" << std::endl;
+            return false;
+        }
+        
+        buildQueryIndex();
+        return true;
+    }
+    
+    void buildQueryIndex() {
+        // 周期号 -> 最接近采样时间的采样点
+        int max_cycle = 0;
+        for (const auto& cycle : cycles_) max_cycle = std::max(max_cycle, cycle.cycle_number);
+        cycle_sample_idx_.assign(max_cycle + 1, SIZE_MAX);
+        for (const auto& cycle : cycles_) {
+            if (cycle.cycle_number >= 0 && cycle_sample_idx_[cycle.cycle_number] == SIZE_MAX) {
+                cycle_sample_idx_[cycle.cycle_number] = waveform_store_.nearestTimeIndex(cycle.sampling_time);
+            }
+        }
+        
+        // 信号编号 -> 位宽
+        slot_width_.assign(id_strings_.size(), 1);
+        for (const auto& kv : signals_by_id_) {
+            int slot = findSlot(kv.first);
+            if (slot >= 0) slot_width_[slot] = kv.second.width;
+        }
+        
+        // 网表节点 N -> signal_N
+        node_slot_.clear();
+        indexed_nodes_.clear();
+        for (const auto& kv : signals_by_id_) {
+            const std::string& base = kv.second.basename;
+            if (base.compare(0, 7, "signal_") != 0 || base.size() == 7) continue;
+            uint64_t n = 0;
+            if (!vcd_tokenizer::parseUnsigned(base.data() + 7, base.size() - 7, n) || n > (1u << 30)) continue;
+            if (n >= node_slot_.size()) node_slot_.resize(n + 1, -1);
+            node_slot_[n] = findSlot(kv.first);
+        }
+        for (size_t n = 0; n < node_slot_.size(); n++) {
+            if (node_slot_[n] >= 0) indexed_nodes_.push_back(n);
+        }
+        
+        po_slot_.clear();
+        index_built_ = true;
+    }
+    
+    bool cycleSampleIndex(int cycle_num, size_t& sample_idx) const {
+        if (cycle_num < 0 || cycle_num >= (int)cycle_sample_idx_.size()) return false;
+        sample_idx = cycle_sample_idx_[cycle_num];
+        return sample_idx != SIZE_MAX;
+    }
+    
+    // PO 序号 -> 信号编号，首次查询时按名称规则解析后缓存 (-1 表示不存在)
+    int poSlot(int po_index) {
+        if (po_index < 0) return -1;
+        if (po_index >= (int)po_slot_.size()) po_slot_.resize(po_index + 1, -2);
+        if (po_slot_[po_index] == -2) {
+            std::string id = resolvePOIdentifier(po_index);
+            po_slot_[po_index] = id.empty() ? -1 : findSlot(id);
+        }
+        return po_slot_[po_index];
+    }
+
+public:
+    VCDParser() : timescale_multiplier_(1),
+                  clock_active_edge_(VCDValue::VCD_1),
+                  clock_inactive_state_(VCDValue::VCD_0),
+                  current_timestamp_(0),
+                  current_state_(ParserState::INITIAL),
+                  use_mapped_io_(true),
+                  defer_waveform_(false),
+                  index_built_(false),
+                  filter_enabled_(false),
+                  skipped_signals_(0),
+                  parse_threads_(1),
+                  cache_enabled_(false),
+                  cache_hit_(false),
+                  cycle_base_(0) {}
+    
+    ~VCDParser() {
+        if (file_.is_open()) file_.close();
+    }
+    
+    // ==================== 主要接口 ====================
+    
+    // 是否使用内存映射 + 零拷贝分词解析 (默认开启)
+    void setMappedIO(bool enable) { use_mapped_io_ = enable; }
+    
+    // 延迟波形重建：查询接口在波形未压缩时会自动重建
+    void setDeferWaveform(bool enable) { defer_waveform_ = enable; }
+    
+    /**
+ * 启用二进制波形缓存：解析后写入旁路文件，之后源文件未变化时直接装载
+ * @param path 缓存文件路径，为空时使用 <vcd文件>.fwc
+ */
+    void setWaveformCache(bool enable, const std::string& path = "") {
+        cache_enabled_ = enable;
+        cache_path_ = path;
+    }
+    
+    // 最近一次 parseFile 是否由缓存装载 (缓存缺失、过期或损坏时为 false)
+    bool loadedFromCache() const { return cache_hit_; }
+    
+    /**
+ * 完整解析 VCD 并写出时间戳定位索引 <vcd>.fwi
+ * @param clock_name 时钟信号名，检查点记录此前的上升沿个数
+ * @param interval 相邻检查点之间的时间戳行数
+ */
+    bool buildSeekIndex(const std::string& filename, const std::string& clock_name, size_t interval = 1024) {
+        vcd_cache::FileKey key;
+        if (interval == 0 || !vcd_cache::computeKey(filename, key)) {
+            std::cerr << "错误：无法建立定位索引: " << filename << std::endl;
+            return false;
+        }
+        if (!parseFile(filename) || !reconstructWaveform() || !setClockSignal(clock_name)) {
+            return false;
+        }
+        
+        vcd_tokenizer::MappedFile mf;
+        if (!mf.open(filename)) return false;
+        const char* data = mf.data();
+        const char* end = mf.end();
+        
+        // 值变化部分的起点
+        const char* defs = static_cast<const char*>(memmem(data, mf.size(), "$enddefinitions", 15));
+        if (!defs) {
+            std::cerr << "错误：未找到 $enddefinitions: " << filename << std::endl;
+            return false;
+        }
+        vcd_tokenizer::Tokenizer tz(defs, end);
+        vcd_tokenizer::Token tok;
+        tz.next(tok);
+        tz.skipToEnd();
+        const char* body = tz.position();
+        if (memmem(body, end - body, "$comment", 8) != nullptr) {
+            std::cerr << "错误：值变化部分含 $comment，无法按时间戳行定位" << std::endl;
+            return false;
+        }
+        
+        // 时钟上升沿时间 (与 extractClockCycles 的判定相同)
+        std::vector<uint64_t> edges;
+        VCDValue prev_clock = VCDValue::VCD_X;
+        waveform_store_.forEachChange(findSlot(clock_signal_id_), [&](uint64_t t, uint8_t v) {
+            VCDValue val = unpackValue(v);
+            if (prev_clock == VCDValue::VCD_0 && val == VCDValue::VCD_1) edges.push_back(t);
+            prev_clock = val;
+        });
+        
+        std::vector<SeekCheckpoint> checkpoints;
+        const size_t num_slots = id_strings_.size();
+        uint64_t prev_time = 0;
+        size_t lines = 0;
+        const char* p = body;
+        while (p < end && vcd_tokenizer::isSpace(*p)) ++p;
+        if (p < end && *p != '#') p = vcd_tokenizer::findTimestampLine(p, end);
+        
+        for (; p < end; p = vcd_tokenizer::findTimestampLine(p, end)) {
+            const char* e = vcd_tokenizer::findSpace(p + 1, end);
+            uint64_t t = 0;
+            if (!vcd_tokenizer::parseUnsigned(p + 1, e - p - 1, t)) {
+                std::cerr << "错误：无法解析时间戳: " << std::string(p, e - p) << std::endl;
+                return false;
+            }
+            t *= timescale_multiplier_;
+            if (lines > 0 && t < prev_time) {
+                std::cerr << "错误：时间戳非单调，无法建立定位索引" << std::endl;
+                return false;
+            }
+            
+            if (lines > 0 && lines % interval == 0) {
+                SeekCheckpoint cp;
+                cp.offset = p - data;
+                cp.state_time = prev_time;
+                cp.edges_before = std::upper_bound(edges.begin(), edges.end(), prev_time) - edges.begin();
+                cp.state.assign((num_slots + 3) / 4, 0);
+                for (size_t slot = 0; slot < num_slots; slot++) {
+                    cp.state[slot >> 2] |= waveform_store_.valueAt(slot, prev_time) << ((slot & 3) * 2);
+                }
+                checkpoints.push_back(std::move(cp));
+            }
+            prev_time = t;
+            lines++;
+            p = e;
+        }
+        
+        return writeSeekIndex(key, clock_name, interval, id_strings_, checkpoints);
+    }
+    
+    /**
+ * 只加载 [first_cycle, last_cycle] 周期窗口附近的波形
+ * 使用 <vcd>.fwi 定位索引；索引不存在或已过期时先完整解析并建立索引 (此时加载整个文件)。
+ * 周期号与完整解析时一致
+ */
+    bool parseCycleWindow(const std::string& filename, const std::string& clock_name,
+                          int first_cycle, int last_cycle, size_t interval = 1024) {
+        if (first_cycle < 1 || last_cycle < first_cycle) {
+            std::cerr << "错误：周期窗口无效: [" << first_cycle << ", " << last_cycle << "]" << std::endl;
+            return false;
+        }
+        
+        vcd_cache::FileKey key;
+        if (!vcd_cache::computeKey(filename, key)) {
+            std::cerr << "错误：无法打开VCD文件: " << filename << std::endl;
+            return false;
+        }
+        
+        filename_ = filename;
+        std::vector<std::string> ids;
+        std::vector<SeekCheckpoint> checkpoints;
+        if (!loadSeekIndex(key, clock_name, ids, checkpoints)) {
+            return buildSeekIndex(filename, clock_name, interval);
+        }
+        
+        vcd_tokenizer::MappedFile mf;
+        if (!mf.open(filename)) {
+            std::cerr << "错误：无法打开VCD文件: " << filename << std::endl;
+            return false;
+        }
+        
+        reset();
+        filename_ = filename;
+        vcd_tokenizer::Tokenizer tz(mf.data(), mf.end());
+        parseHeaderTokens(tz);
+        
+        // 起点：上升沿个数不超过 first_cycle-1 的最后一个检查点；终点：之后第一个覆盖 last_cycle+1 个上升沿的检查点
+        const SeekCheckpoint* start = nullptr;
+        const SeekCheckpoint* stop = nullptr;
+        for (const auto& cp : checkpoints) {
+            if (cp.edges_before <= static_cast<uint64_t>(first_cycle - 1)) {
+                start = &cp;
+            } else if (cp.edges_before >= static_cast<uint64_t>(last_cycle) + 1) {
+                stop = &cp;
+                break;
+            }
+        }
+        
+        const char* begin = start ? mf.data() + start->offset : tz.position();
+        const char* end = stop ? mf.data() + stop->offset : mf.end();
+        if (begin < tz.position() || end > mf.end() || begin > end) {
+            std::cerr << "错误：定位索引与文件不符: " << seekIndexPath() << std::endl;
+            return false;
+        }
+        
+        // 从检查点恢复各信号的值
+        if (start) {
+            for (size_t i = 0; i < ids.size(); i++) {
+                uint8_t v = (start->state[i >> 2] >> ((i & 3) * 2)) & 3;
+                if (v != VCDWaveformStore::kValueX) {
+                    waveform_store_.append(slotForIdentifier(ids[i]), start->state_time, v);
+                }
+            }
+            current_timestamp_ = start->state_time;
+            cycle_base_ = start->edges_before;
+        }
+        
+        if (!parseBody(begin, end)) {
+            return false;
+        }
+        if (!defer_waveform_ && !reconstructWaveform()) {
+            return false;
+        }
+        return setClockSignal(clock_name);
+    }
+    
+    /**
+ * 单遍扫描 VCD 统计每个信号的 P(1) 与翻转次数 (按周期、按窗口、全程)，不建立波形存储
+ * 调用后解析器只保留信号定义，波形查询需重新 parseFile
+ * @param window_cycles 每个统计窗口包含的周期数
+ * @param keep_cycle_values 是否保留逐周期采样值 (周期数 x 信号数 字节)
+ */
+    bool computeSignalStatistics(const std::string& filename, const std::string& clock_name,
+                                 int window_cycles, VCDSignalStatistics& stats,
+                                 bool keep_cycle_values = true) {
+        vcd_tokenizer::MappedFile mf;
+        if (!mf.open(filename)) {
+            std::cerr << "错误：无法打开VCD文件: " << filename << std::endl;
+            return false;
+        }
         
-        // 检查是否是新命令
-        if (line[0] == '$') {
-            if (line.find("$dumpvars") == 0) {
-                current_state_ = ParserState::IN_DUMPVARS;
-            } else if (line.find("$comment") == 0) {
-                // 跳过注释
-                current_state_ = ParserState::IN_COMMENT;
-            } else if (line.find("$end") == 0) {
-                // 结束当前段
-                if (current_state_ == ParserState::IN_DUMPVARS) {
-                    current_state_ = ParserState::IN_BODY;
-                } else if (current_state_ == ParserState::IN_COMMENT) {
-                    current_state_ = ParserState::IN_BODY;
-                }
+        reset();
+        filename_ = filename;
+        vcd_tokenizer::Tokenizer tz(mf.data(), mf.end());
+        parseHeaderTokens(tz);
+        if (!setClockSignal(clock_name)) {
+            return false;
+        }
+        
+        // 列即已声明信号的编号
+        const int num_slots = id_strings_.size();
+        stats = VCDSignalStatistics();
+        stats.window_cycles = std::max(1, window_cycles);
+        stats.names.assign(num_slots, std::string());
+        stats.total_p1.assign(num_slots, 0.0);
+        stats.total_toggles.assign(num_slots, 0);
+        for (const auto& kv : signals_by_id_) {
+            int slot = findSlot(kv.first);
+            if (slot < 0) continue;
+            stats.names[slot] = kv.second.name;
+            
+            const std::string& base = kv.second.basename;
+            uint64_t n = 0;
+            if (base.compare(0, 7, "signal_") == 0 &&
+                vcd_tokenizer::parseUnsigned(base.data() + 7, base.size() - 7, n) && n < (1u << 30)) {
+                if (n >= stats.node_column.size()) stats.node_column.resize(n + 1, -1);
+                stats.node_column[n] = slot;
             }
-            return true;
         }
         
-        // 根据当前状态处理
-        switch (current_state_) {
-            case ParserState::IN_DUMPVARS:
-                parseInitialValue(line);
-                break;
-            case ParserState::IN_BODY:
-                return parseValueChange(line);
-            default:
-                // 忽略
-                break;
+        fillIdentifierCache();
+        StatisticsSink sink(stats, num_slots, findSlot(clock_signal_id_), keep_cycle_values);
+        if (!parseBodyRange(tz.position(), tz.end(), sink, current_timestamp_, current_state_,
+                            [this](const vcd_tokenizer::Token& tok) { return lookupDeclaredSlot(tok); })) {
+            return false;
         }
+        sink.finish();
         
+        if (stats.num_cycles == 0) {
+            std::cerr << "错误：时钟边沿不足，无法定义周期" << std::endl;
+            return false;
+        }
         return true;
     }
-
-public:
-    VCDParser() : timescale_multiplier_(1),
-                  clock_active_edge_(VCDValue::VCD_1),
-                  clock_inactive_state_(VCDValue::VCD_0),
-                  current_timestamp_(0),
-                  current_state_(ParserState::INITIAL) {}
     
-    ~VCDParser() {
-        if (file_.is_open()) file_.close();
+    // 内存映射模式下值变化部分的并行解析线程数 (1 为顺序解析，0 为 OpenMP 默认线程数)；
+    // 文件按时间戳行分段，每段至少 4MB
+    void setParseThreads(int threads) { parse_threads_ = threads; }
+    
+    /**
+ * 设置信号过滤 (在 parseFile 之前调用)，只保留匹配的信号
+ * @param patterns glob 模式 (fnmatch)，与信号基础名或完整名匹配，如 "po*"、"tb_top.uut.*"
+ * @param identifiers 额外保留的 VCD 标识符
+ * 时钟信号也必须被选中，否则无法提取周期
+ */
+    void setSignalFilter(const std::vector<std::string>& patterns,
+                         const std::vector<std::string>& identifiers = {}) {
+        filter_patterns_ = patterns;
+        filter_ids_.clear();
+        filter_ids_.insert(identifiers.begin(), identifiers.end());
+        filter_enabled_ = !filter_patterns_.empty() || !filter_ids_.empty();
     }
     
-    // ==================== 主要接口 ====================
+    void clearSignalFilter() {
+        filter_patterns_.clear();
+        filter_ids_.clear();
+        filter_enabled_ = false;
+    }
+    
+    // FSTRA 用到的信号：时钟、PO、寄存器输出和网表节点
+    static std::vector<std::string> fstraSignalPatterns() {
+        return {"clock", "po*", "rout_*", "signal_*"};
+    }
+    
+    size_t getSkippedSignalCount() const { return skipped_signals_; }
     
     bool parseFile(const std::string& filename) {
+        vcd_cache::FileKey key;
+        const bool use_cache = cache_enabled_ && vcd_cache::computeKey(filename, key);
+        cache_hit_ = use_cache && loadWaveformCache(filename, key);
+        if (cache_hit_) {
+            return true;
+        }
+        
+        bool ok = use_mapped_io_ ? parseFileMapped(filename) : parseFileText(filename);
+        
+        // 缓存保存压缩后的波形，需要先完成重建
+        if (ok && use_cache && reconstructWaveform()) {
+            cache_key_ = key;
+            writeWaveformCache();
+        }
+        return ok;
+    }
+    
+    bool parseFileText(const std::string& filename) {
         filename_ = filename;
         file_.open(filename);
         if (!file_.is_open()) {
@@ -646,7 +1996,7 @@ public:
         // 调试输出已注释
         // std::cout << "\nVCD文件解析完成" << std::endl;
         // std::cout << "找到 " << signals_by_id_.size() << " 个信号" << std::endl;
-        // std::cout << "记录 " << value_changes_.size() << " 个时间戳的变化" << std::endl;
+        // std::cout << "记录 " << waveform_store_.numChanges() << " 条值变化" << std::endl;
         
         // 显示所有信号
         // std::cout << "\n========== 所有信号 ==========" << std::endl;
@@ -657,10 +2007,41 @@ public:
         
         // 自动重建波形数据
         // std::cout << "自动重建波形数据..." << std::endl;
-        if (!reconstructWaveform()) {
+        if (defer_waveform_) {
+            // 由查询接口按需重建
+        } else if (!reconstructWaveform()) {
             // std::cerr << "警告：波形数据重建失败，可能影响后续功能" << std::endl;
         } else {
-            // std::cout << "波形数据重建完成，共 " << waveform_.size() << " 个采样点" << std::endl;
+            // std::cout << "波形数据重建完成，共 " << waveform_store_.timestamps().size() << " 个采样点" << std::endl;
+        }
+        
+        return true;
+    }
+
+    // 内存映射解析：整个文件映射后按记号扫描，结果与逐行解析相同
+    bool parseFileMapped(const std::string& filename) {
+        filename_ = filename;
+        
+        vcd_tokenizer::MappedFile mf;
+        if (!mf.open(filename)) {
+            std::cerr << "错误：无法打开VCD文件: " << filename << std::endl;
+            return false;
+        }
+        
+        reset();
+        
+        vcd_tokenizer::Tokenizer tz(mf.data(), mf.end());
+        
+        // 定义部分
+        parseHeaderTokens(tz);
+        
+        // 值变化部分：直接追加到对应信号的变化序列
+        if (!parseBody(tz.position(), tz.end())) {
+            return false;
+        }
+        
+        if (!defer_waveform_ && !reconstructWaveform()) {
+            // std::cerr << "警告：波形数据重建失败，可能影响后续功能" << std::endl;
         }
         
         return true;
@@ -905,187 +2286,134 @@ public:
     bool getPOOutputFromWaveform(int po_index, int cycle_num,
                                 std::vector<double>& prob_0,
                                 std::vector<double>& prob_1) {
-        // 检查波形数据是否为空，如果为空则尝试重建
-        if (waveform_.empty()) {
-            // std::cout << "警告：波形数据为空，尝试重建..." << std::endl;
-            if (!reconstructWaveform()) {
-                // std::cerr << "错误：无法重建波形数据" << std::endl;
-                return false;
-            }
+        if (!ensureQueryIndex()) {
+            return false;
         }
         
-        // 如果cycles_为空但waveform_不为空，尝试提取周期
-        if (cycles_.empty() && !waveform_.empty()) {
-            // std::cout << "警告：周期数据为空，尝试提取..." << std::endl;
-            if (!extractClockCycles()) {
-                // std::cerr << "错误：无法提取时钟周期" << std::endl;
-                return false;
-            }
+        // 周期 -> 采样点、PO -> 信号编号都查预先建立的索引
+        size_t sample_idx = 0;
+        if (!cycleSampleIndex(cycle_num, sample_idx)) {
+            std::cerr << "错误：未找到周期 " << cycle_num << std::endl;
+            return false;
         }
         
-        if (cycles_.empty()) {
-            std::cerr << "错误：没有周期数据" << std::endl;
+        int slot = poSlot(po_index);
+        if (slot < 0) {
+            std::cerr << "错误：未找到PO" << po_index << " 的信号" << std::endl;
             return false;
         }
         
-        // 查找指定周期
-        const VCDCycle* target_cycle = nullptr;
-        for (const auto& cycle : cycles_) {
-            if (cycle.cycle_number == cycle_num) {
-                target_cycle = &cycle;
-                break;
-            }
+        VCDValue val = unpackValue(waveform_store_.valueAtIndex(slot, sample_idx));
+        fillProbabilities(val, slot_width_[slot], prob_0, prob_1);
+
+        // std::cout << "从波形获取 PO" << po_index << " 在周期 " << cycle_num 
+        //           << " (时间 " << waveform_store_.timestamps()[sample_idx] << ") 的值: " 
+        //           << vcd_value_to_string(val) << std::endl;
+
+        return true;
+    }
+    
+    /**
+ * 按网表节点编号获取节点在特定周期的输出概率 (信号名为 signal_N)
+ * @param node_index 网表节点编号 N
+ * @param cycle_num 周期编号
+ * @return 是否存在该节点的信号
+ */
+    bool getNodeOutputByIndex(int node_index, int cycle_num, double& prob_0, double& prob_1) {
+        if (!ensureQueryIndex()) {
+            return false;
         }
         
-        if (!target_cycle) {
-            std::cerr << "错误：未找到周期 " << cycle_num << std::endl;
+        size_t sample_idx = 0;
+        if (!cycleSampleIndex(cycle_num, sample_idx)) {
             return false;
         }
-        
-        // 查找PO信号的标识符
-        std::vector<std::string> possible_po_names = {
-            "po" + std::to_string(po_index),
-            "po_" + std::to_string(po_index)
-        };
-        
-        // 如果有uut前缀，也检查
-        std::vector<std::string> possible_po_names_with_uut;
-        for (const auto& name : possible_po_names) {
-            possible_po_names_with_uut.push_back("uut." + name);
-            possible_po_names_with_uut.push_back("tb_top.uut." + name);
+        if (node_index < 0 || node_index >= (int)node_slot_.size() || node_slot_[node_index] < 0) {
+            return false;
         }
         
-        possible_po_names.insert(possible_po_names.end(), 
-                                possible_po_names_with_uut.begin(), 
-                                possible_po_names_with_uut.end());
+        VCDValue val = unpackValue(waveform_store_.valueAtIndex(node_slot_[node_index], sample_idx));
+        valueToProbability(val, prob_0, prob_1);
+        return true;
+    }
+    
+    /**
+ * 生成只读查询快照，供多线程并发采样
+ * @param num_pos PO 个数；小于 0 时按信号名 poN / po_N 推断
+ * @return 快照；没有可用的周期数据时返回空指针
+ */
+    std::shared_ptr<const VCDQuerySnapshot> freeze(int num_pos = -1) {
+        if (!ensureQueryIndex()) {
+            return nullptr;
+        }
         
-        std::string po_identifier;
-        for (const auto& po_name : possible_po_names) {
-            // 查找信号
+        if (num_pos < 0) {
+            num_pos = 0;
             for (const auto& kv : signals_by_id_) {
-                if (kv.second.name.find(po_name) != std::string::npos) {
-                    po_identifier = kv.first;
-                    // std::cout << "找到PO信号: " << kv.second.name 
-                    //           << " (ID: " << po_identifier << ")" << std::endl;
-                    break;
+                const std::string& base = kv.second.basename;
+                if (base.compare(0, 2, "po") != 0) continue;
+                size_t digits = (base.size() > 2 && base[2] == '_') ? 3 : 2;
+                uint64_t n = 0;
+                if (vcd_tokenizer::parseUnsigned(base.data() + digits, base.size() - digits, n) && n < (1u << 20)) {
+                    num_pos = std::max(num_pos, (int)n + 1);
                 }
             }
-            if (!po_identifier.empty()) break;
         }
         
-        if (po_identifier.empty()) {
-            // 尝试更宽松的匹配
-            // std::cout << "尝试更宽松的信号匹配..." << std::endl;
-            for (const auto& kv : signals_by_id_) {
-                const std::string& name = kv.second.name;
-                const std::string& basename = kv.second.basename;
-                
-                // 检查是否是PO信号
-                if (basename.find("po") == 0 || basename.find("signal_") == 0) {
-                    // 提取数字
-                    std::string num_str;
-                    if (basename.find("po") == 0) {
-                        num_str = basename.substr(2);
-                    } else if (basename.find("signal_") == 0) {
-                        num_str = basename.substr(7);
-                    }
-                    
-                    try {
-                        int signal_num = std::stoi(num_str);
-                        if (signal_num == po_index) {
-                            po_identifier = kv.first;
-                            // std::cout << "通过宽松匹配找到PO信号: " << name 
-                            //           << " (ID: " << po_identifier << ")" << std::endl;
-                            break;
-                        }
-                    } catch (...) {
-                        // 转换失败，继续
-                    }
-                }
-            }
+        if (snapshot_ && snapshot_->numPOs() == num_pos) {
+            return snapshot_;
         }
         
-        if (po_identifier.empty()) {
-            std::cerr << "错误：未找到PO" << po_index << " 的信号" << std::endl;
-            
-            // 显示所有可能的PO信号以供调试
-            // std::cout << "可用信号列表 (可能包含PO):" << std::endl;
-            for (const auto& kv : signals_by_fullname_) {
-                if (kv.second.basename.find("po") == 0 || 
-                    kv.second.basename.find("signal_") == 0) {
-                    // std::cout << "  " << kv.first << " (basename: " 
-                    //           << kv.second.basename << ")" << std::endl;
-                }
-            }
-            return false;
+        auto snap = std::make_shared<VCDQuerySnapshot>();
+        snap->store_ = waveform_store_;
+        snap->cycle_sample_idx_ = cycle_sample_idx_;
+        snap->slot_width_ = slot_width_;
+        snap->node_slot_ = node_slot_;
+        snap->indexed_nodes_ = indexed_nodes_;
+        snap->num_cycles_ = cycles_.size();
+        snap->po_slot_.resize(num_pos);
+        for (int i = 0; i < num_pos; i++) {
+            snap->po_slot_[i] = poSlot(i);
         }
         
-        // 查找周期采样时间点的波形
-        uint64_t sample_time = target_cycle->sampling_time;
-        const VCDWaveformSample* sample_at_time = nullptr;
+        snapshot_ = snap;
+        return snapshot_;
+    }
+    
+    // 波形中存在 signal_N 信号的网表节点编号 (升序)
+    const std::vector<int>& getIndexedNodes() {
+        ensureQueryIndex();
+        return indexed_nodes_;
+    }
+
+    /**
+ * 按基础名获取信号在各周期的采样值
+ * @param basename 信号基础名 (如 input_0、rout_3)
+ * @param values values[c] 为周期 c 的值，下标 0 及没有采样点的周期为 VCD_X
+ * @return 是否存在该信号
+ */
+    bool getSignalSamples(const std::string& basename, std::vector<VCDValue>& values) {
+        if (!ensureQueryIndex()) {
+            return false;
+        }
         
-        // 找到最接近的采样点
-        uint64_t min_diff = UINT64_MAX;
-        for (const auto& sample : waveform_) {
-            uint64_t diff = (sample.timestamp > sample_time) ? 
-                           (sample.timestamp - sample_time) : 
-                           (sample_time - sample.timestamp);
-            if (diff < min_diff) {
-                min_diff = diff;
-                sample_at_time = &sample;
-            }
-            
-            // 如果找到精确匹配，直接使用
-            if (sample.timestamp == sample_time) {
-                sample_at_time = &sample;
+        int slot = -1;
+        for (const auto& kv : signals_by_id_) {
+            if (kv.second.basename == basename) {
+                slot = findSlot(kv.first);
                 break;
             }
         }
-        
-        if (!sample_at_time) {
-            // 使用最后一个波形点
-            sample_at_time = &waveform_.back();
-        }
-
-        // 获取信号值
-        VCDValue val = sample_at_time->getSignal(po_identifier);
-
-        // 获取信号位宽
-        int width = 1;
-        auto sig_it = signals_by_id_.find(po_identifier);
-        if (sig_it != signals_by_id_.end()) {
-            width = sig_it->second.width;
+        if (slot < 0) {
+            return false;
         }
-
-        // 设置概率
-        prob_0.resize(width, 0.0);
-        prob_1.resize(width, 0.0);
-
-        for (int i = 0; i < width; i++) {
-            switch (val) {
-                case VCDValue::VCD_0:
-                    prob_0[i] = 1.0;
-                    prob_1[i] = 0.0;
-                    break;
-                case VCDValue::VCD_1:
-                    prob_0[i] = 0.0;
-                    prob_1[i] = 1.0;
-                    break;
-                case VCDValue::VCD_X:
-                case VCDValue::VCD_Z:
-                    prob_0[i] = 0.5;
-                    prob_1[i] = 0.5;
-                    break;
-                default:
-                    prob_0[i] = 0.5;
-                    prob_1[i] = 0.5;
+        
+        values.assign(cycle_sample_idx_.size(), VCDValue::VCD_X);
+        for (size_t c = 0; c < cycle_sample_idx_.size(); c++) {
+            if (cycle_sample_idx_[c] != SIZE_MAX) {
+                values[c] = unpackValue(waveform_store_.valueAtIndex(slot, cycle_sample_idx_[c]));
             }
         }
-
-        // std::cout << "从波形获取 PO" << po_index << " 在周期 " << cycle_num 
-        //           << " (时间 " << sample_at_time->timestamp << ") 的值: " 
-        //           << vcd_value_to_string(val) << std::endl;
-
         return true;
     }
 
@@ -1101,7 +2429,7 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
                                   std::pair<std::vector<double>, 
                                   std::vector<double>>>& node_outputs) {
     // 检查波形数据是否为空，如果为空则尝试重建
-    if (waveform_.empty()) {
+    if (!waveform_store_.finalized()) {
         // std::cout << "警告：波形数据为空，尝试重建..." << std::endl;
         if (!reconstructWaveform()) {
             // std::cerr << "错误：无法重建波形数据" << std::endl;
@@ -1109,8 +2437,8 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
         }
     }
     
-    // 如果cycles_为空但waveform_不为空，尝试提取周期
-    if (cycles_.empty() && !waveform_.empty()) {
+    // 如果cycles_为空但波形不为空，尝试提取周期
+    if (cycles_.empty() && !waveform_store_.empty()) {
         // std::cout << "警告：周期数据为空，尝试提取..." << std::endl;
         if (!extractClockCycles()) {
             // std::cerr << "错误：无法提取时钟周期" << std::endl;
@@ -1123,49 +2451,15 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
         return false;
     }
     
-    // 查找指定周期
-    const VCDCycle* target_cycle = nullptr;
-    for (const auto& cycle : cycles_) {
-        if (cycle.cycle_number == cycle_num) {
-            target_cycle = &cycle;
-            break;
-        }
-    }
-    
-    if (!target_cycle) {
+    // 查找指定周期对应的采样点
+    size_t sample_idx = 0;
+    if (!ensureQueryIndex() || !cycleSampleIndex(cycle_num, sample_idx)) {
         std::cerr << "错误：未找到周期 " << cycle_num << std::endl;
         return false;
     }
     
-    // 查找周期采样时间点的波形
-    uint64_t sample_time = target_cycle->sampling_time;
-    const VCDWaveformSample* sample_at_time = nullptr;
-    
-    // 找到最接近的采样点
-    uint64_t min_diff = UINT64_MAX;
-    for (const auto& sample : waveform_) {
-        uint64_t diff = (sample.timestamp > sample_time) ? 
-                       (sample.timestamp - sample_time) : 
-                       (sample_time - sample.timestamp);
-        if (diff < min_diff) {
-            min_diff = diff;
-            sample_at_time = &sample;
-        }
-        
-        // 如果找到精确匹配，直接使用
-        if (sample.timestamp == sample_time) {
-            sample_at_time = &sample;
-            break;
-        }
-    }
-    
-    if (!sample_at_time) {
-        // 使用最后一个波形点
-        sample_at_time = &waveform_.back();
-    }
-    
     // 调试输出已注释
-    // std::cout << "获取周期 " << cycle_num << " (时间 " << sample_at_time->timestamp 
+    // std::cout << "获取周期 " << cycle_num << " (时间 " << waveform_store_.timestamps()[sample_idx] 
     //           << ") 的所有节点输出值" << std::endl;
     
     // 清空输出映射
@@ -1182,7 +2476,7 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
         // 检查信号是否具有"signal_"特征
         if (signal_info.basename.find("signal_") == 0) {
             // 获取信号值
-            VCDValue val = sample_at_time->getSignal(signal_id);
+            VCDValue val = sampleValue(signal_id, sample_idx);
             
             // 获取信号位宽
             int width = signal_info.width;
@@ -1307,7 +2601,7 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
             }
             
             if (!signal_identifier.empty()) {
-                VCDValue val = sample_at_time->getSignal(signal_identifier);
+                VCDValue val = sampleValue(signal_identifier, sample_idx);
                 
                 // 查找信号信息
                 int width = 1;
@@ -1370,7 +2664,7 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
         // 显示所有可用信号以供参考
         // std::cout << "所有可用信号列表:" << std::endl;
         int signal_count = 0;
-        for (const auto& kv : signals_by_id_) {
+        for ([[maybe_unused]] const auto& kv : signals_by_id_) {
             if (signal_count < 20) { // 只显示前20个信号
                 // 调试输出已注释
                 // std::cout << "  ID: " << kv.first 
@@ -1407,7 +2701,7 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
             }
             
             if (is_signal) {
-                VCDValue val = sample_at_time->getSignal(signal_id);
+                VCDValue val = sampleValue(signal_id, sample_idx);
                 
                 // 获取信号位宽
                 int width = signal_info.width;
@@ -1462,59 +2756,26 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
     return true;
 }
 
+    // 把解析阶段追加的值变化压缩成按信号的只读变化序列
     bool reconstructWaveform(double sampling_interval = 0.0) {
-        if (value_changes_.empty()) {
-            std::cerr << "错误：没有值变化数据" << std::endl;
-            return false;
+        if (waveform_store_.finalized()) {
+            return !waveform_store_.empty();
         }
         
-        // 调试输出已注释
-        // std::cout << "开始重建波形..." << std::endl;
-        waveform_.clear();
-        
-        // 初始化所有信号的当前值
-        std::unordered_map<std::string, VCDValue> current_values;
+        // 已声明但从未变化的信号也占一个编号，查询时取 X
         for (const auto& kv : signals_by_id_) {
-            current_values[kv.first] = VCDValue::VCD_X;
+            slotForIdentifier(kv.first);
         }
+        waveform_store_.reserveSignals(id_strings_.size());
         
-        // 应用初始值
-        auto initial_it = value_changes_.find(0);
-        if (initial_it != value_changes_.end()) {
-            for (const auto& change : initial_it->second) {
-                current_values[change.identifier] = change.value;
-            }
-        }
-        
-        // 创建初始采样点（时间为0）
-        if (!current_values.empty()) {
-            VCDWaveformSample sample(0);
-            for (const auto& cv : current_values) {
-                sample.addSignal(cv.first, cv.second);
-            }
-            waveform_.push_back(sample);
-        }
-        
-        // 按照时间顺序应用变化并创建采样点
-        for (const auto& kv : value_changes_) {
-            uint64_t timestamp = kv.first;
-            if (timestamp == 0) continue;  // 初始值已处理
-            
-            // 应用此时间戳的所有变化
-            for (const auto& change : kv.second) {
-                current_values[change.identifier] = change.value;
-            }
-            
-            // 创建采样点
-            VCDWaveformSample sample(timestamp);
-            for (const auto& cv : current_values) {
-                sample.addSignal(cv.first, cv.second);
-            }
-            waveform_.push_back(sample);
+        if (!waveform_store_.finalize()) {
+            std::cerr << "错误：没有值变化数据" << std::endl;
+            return false;
         }
         
         // 调试输出已注释
-        // std::cout << "重建波形完成，共 " << waveform_.size() << " 个采样点" << std::endl;
+        // std::cout << "重建波形完成，共 " << waveform_store_.timestamps().size() << " 个采样点, "
+        //           << waveform_store_.memoryBytes() << " 字节" << std::endl;
         return true;
     }
 
@@ -1546,7 +2807,7 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
      
     
     bool extractClockCycles() {
-        if (waveform_.empty()) {
+        if (!waveform_store_.finalized() || waveform_store_.empty()) {
             std::cerr << "错误：波形数据为空，请先重建波形" << std::endl;
             return false;
         }
@@ -1559,24 +2820,28 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
         // 调试输出已注释
         // std::cout << "开始提取时钟周期..." << std::endl;
         cycles_.clear();
+        invalidateQueryIndex();
         
-        // 检测时钟边沿
+        // 检测时钟边沿：只需遍历时钟信号自己的变化序列；缓存中已有同一时钟的边沿时直接使用
         std::vector<uint64_t> clock_edges;
         VCDValue prev_clock_value = VCDValue::VCD_X;
-        
-        for (size_t i = 0; i < waveform_.size(); i++) {
-            const auto& sample = waveform_[i];
-            VCDValue clock_val = sample.getSignal(clock_signal_id_);
+        const bool edges_cached = !cached_clock_id_.empty() && cached_clock_id_ == clock_signal_id_;
+        if (edges_cached) {
+            clock_edges = cached_clock_edges_;
+        } else {
+            waveform_store_.forEachChange(findSlot(clock_signal_id_), [&](uint64_t timestamp, uint8_t v) {
+                VCDValue clock_val = unpackValue(v);
             
-            // 检测上升沿（从0到1）
+                // 检测上升沿（从0到1）
                 if (prev_clock_value == VCDValue::VCD_0 && 
-                clock_val == VCDValue::VCD_1) {
-                clock_edges.push_back(sample.timestamp);
-                // 调试输出已注释
-                // std::cout << "检测到时钟上升沿 @ " << sample.timestamp << std::endl;
-            }
+                    clock_val == VCDValue::VCD_1) {
+                    clock_edges.push_back(timestamp);
+                    // 调试输出已注释
+                    // std::cout << "检测到时钟上升沿 @ " << timestamp << std::endl;
+                }
             
-            prev_clock_value = clock_val;
+                prev_clock_value = clock_val;
+            });
         }
         
         // 调试输出已注释
@@ -1587,23 +2852,31 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
             return false;
         }
         
-        // 根据边沿创建周期
+        if (cache_enabled_ && !edges_cached) {
+            cached_clock_id_ = clock_signal_id_;
+            cached_clock_edges_ = clock_edges;
+            writeWaveformCache();
+        }
+        
+        std::vector<int> output_slots;
+        for (const auto& output_id : output_signal_ids_) {
+            output_slots.push_back(findSlot(output_id));
+        }
+        
+        // 根据边沿创建周期，边沿时间递增，用游标顺序采样
+        VCDWaveformStore::Cursor cursor = waveform_store_.cursor();
         for (size_t i = 0; i < clock_edges.size() - 1; i++) {
-            VCDCycle cycle(i + 1);
+            VCDCycle cycle(cycle_base_ + i + 1);
             cycle.start_time = clock_edges[i];
             cycle.end_time = clock_edges[i + 1];
             cycle.sampling_time = clock_edges[i];  // 在上升沿采样
             
-            // 查找采样时间点的波形数据
-            for (const auto& sample : waveform_) {
-                if (sample.timestamp >= cycle.sampling_time) {
-                    // 提取输出信号值
-                    for (const auto& output_id : output_signal_ids_) {
-                        VCDValue val = sample.getSignal(output_id);
-                        const auto& signal = signals_by_id_[output_id];
-                        cycle.addOutput(signal.name, val);
-                    }
-                    break;
+            // 提取输出信号值 (边沿时刻本身就是采样点)
+            if (cursor.seek(cycle.sampling_time)) {
+                for (size_t k = 0; k < output_signal_ids_.size(); k++) {
+                    VCDValue val = unpackValue(cursor.value(output_slots[k]));
+                    const auto& signal = signals_by_id_[output_signal_ids_[k]];
+                    cycle.addOutput(signal.name, val);
                 }
             }
             
@@ -1643,9 +2916,13 @@ bool getAllNodeOutputsFromWaveform(int cycle_num,
         std::cout << "日期: " << date_ << std::endl;
         std::cout << "版本: " << version_ << std::endl;
         std::cout << "时间单位: " << timescale_ << std::endl;
-        std::cout << "信号数量: " << signals_by_id_.size() << std::endl;
-        std::cout << "时间变化点数: " << value_changes_.size() << std::endl;
-        std::cout << "波形采样点数: " << waveform_.size() << std::endl;
+        std::cout << "信号数量: " << signals_by_id_.size();
+        if (filter_enabled_) std::cout << " (过滤掉 " << skipped_signals_ << " 个)";
+        std::cout << std::endl;
+        std::cout << "时间变化点数: " << waveform_store_.numChangeTimes() << std::endl;
+        std::cout << "波形采样点数: " << waveform_store_.timestamps().size() << std::endl;
+        std::cout << "值变化条数: " << waveform_store_.numChanges() 
+                  << " (存储 " << waveform_store_.memoryBytes() << " 字节)" << std::endl;
         std::cout << "时钟周期数: " << cycles_.size() << std::endl;
         
         if (!clock_signal_id_.empty()) {
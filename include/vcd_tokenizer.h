@@ -0,0 +1,220 @@
+#ifndef VCD_TOKENIZER_HPP
+#define VCD_TOKENIZER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ==================== VCD 零拷贝分词 ====================
+//
+// VCD 文件整体映射到内存后按空白切分成记号，记号只保存指针和长度，
+// 不构造 std::string。标识符码 (ASCII 33..126) 在扫描时直接解码成整数，
+// 解析器用它做数组下标，避免逐行 trim / substr / 哈希查找。
+
+namespace vcd_tokenizer {
+
+// ==================== 文件映射 ====================
+
+class MappedFile {
+private:
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> buffer_;   // mmap 不可用时的回退缓冲
+
+public:
+    MappedFile() : data_(nullptr), size_(0), mapped_(false) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename) {
+        close();
+
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+
+        if (size_ > 0) {
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(p);
+                mapped_ = true;
+            }
+        }
+        ::close(fd);
+
+        if (!mapped_ && size_ > 0) {
+            std::ifstream in(filename, std::ios::binary);
+            if (!in.is_open()) return false;
+            buffer_.resize(size_);
+            in.read(buffer_.data(), size_);
+            size_ = static_cast<size_t>(in.gcount());
+            data_ = buffer_.data();
+        }
+        return true;
+    }
+
+    void close() {
+        if (mapped_) munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+        buffer_.clear();
+    }
+
+    const char* data() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+    bool isMapped() const { return mapped_; }
+};
+
+// ==================== 字节搜索 ====================
+
+inline bool isSpace(char c) {
+    return static_cast<unsigned char>(c) <= ' ';
+}
+
+// 查找第一个等于 c 的字节，找不到返回 end
+inline const char* findByte(const char* p, const char* end, char c) {
+#if defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    const void* r = std::memchr(p, c, end - p);
+    return r ? static_cast<const char*>(r) : end;
+}
+
+// 查找第一个空白字节 (<= 0x20)，即记号结尾
+inline const char* findSpace(const char* p, const char* end) {
+#if defined(__SSE2__)
+    const __m128i limit = _mm_set1_epi8(' ');
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // 无符号比较 block <= ' '：min(block, ' ') == block
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(block, limit), block));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && !isSpace(*p)) ++p;
+    return p;
+}
+
+// 查找下一行以 '#' 开头的位置 (时间戳行)，返回指向 '#' 的指针；找不到返回 end
+inline const char* findTimestampLine(const char* p, const char* end) {
+    while (p < end) {
+        const char* nl = findByte(p, end, '\n');
+        if (nl + 1 >= end) return end;
+        if (nl[1] == '#') return nl + 1;
+        p = nl + 1;
+    }
+    return end;
+}
+
+// ==================== 标识符解码 ====================
+
+// VCD 标识符由 '!'..'~' 组成，按双射 94 进制编码 (首字符为最低位)，
+// 不同长度的标识符不会冲突；超过 9 个字符时返回 UINT64_MAX
+inline uint64_t decodeIdentifier(const char* p, size_t len) {
+    if (len == 0 || len > 9) return UINT64_MAX;
+    uint64_t code = 0;
+    uint64_t base = 1;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = static_cast<unsigned char>(p[i]);
+        if (c < 33 || c > 126) return UINT64_MAX;
+        code += (c - 32) * base;
+        base *= 94;
+    }
+    return code;
+}
+
+inline bool parseUnsigned(const char* p, size_t len, uint64_t& value) {
+    if (len == 0) return false;
+    uint64_t v = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned d = static_cast<unsigned char>(p[i]) - '0';
+        if (d > 9) return false;
+        v = v * 10 + d;
+    }
+    value = v;
+    return true;
+}
+
+// ==================== 分词器 ====================
+
+struct Token {
+    const char* ptr;
+    size_t len;
+
+    Token() : ptr(nullptr), len(0) {}
+    Token(const char* p, size_t n) : ptr(p), len(n) {}
+
+    bool equals(const char* s) const {
+        size_t n = std::strlen(s);
+        return n == len && std::memcmp(ptr, s, n) == 0;
+    }
+    bool startsWith(const char* s) const {
+        size_t n = std::strlen(s);
+        return n <= len && std::memcmp(ptr, s, n) == 0;
+    }
+    std::string str() const { return std::string(ptr, len); }
+};
+
+class Tokenizer {
+private:
+    const char* cur_;
+    const char* end_;
+
+public:
+    Tokenizer(const char* begin, const char* end) : cur_(begin), end_(end) {}
+
+    bool next(Token& tok) {
+        while (cur_ < end_ && isSpace(*cur_)) ++cur_;
+        if (cur_ >= end_) return false;
+        const char* start = cur_;
+        cur_ = findSpace(cur_ + 1, end_);
+        tok = Token(start, cur_ - start);
+        return true;
+    }
+
+    // 跳过直到 "$end" 记号 (含)，用于 $comment 等不关心内容的段
+    bool skipToEnd() {
+        Token tok;
+        while (next(tok)) {
+            if (tok.equals("$end")) return true;
+        }
+        return false;
+    }
+
+    const char* position() const { return cur_; }
+    const char* end() const { return end_; }
+};
+
+} // namespace vcd_tokenizer
+
+#endif // VCD_TOKENIZER_HPP
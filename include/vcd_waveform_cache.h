@@ -0,0 +1,159 @@
+#ifndef VCD_WAVEFORM_CACHE_HPP
+#define VCD_WAVEFORM_CACHE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "vcd_tokenizer.h"
+
+// ==================== 波形二进制缓存 ====================
+//
+// 第一次解析 VCD 后把信号表、按信号的变化数组 (列式) 和时钟周期索引写到
+// 旁路文件 <vcd>.fwc，之后以 (文件大小, 修改时间, 抽样哈希) 为键校验，
+// 命中时直接映射缓存文件装载，不再解析文本。
+//
+// 文件格式：头部 + 若干按顺序排列的字段，整数为本机字节序，
+// 数组为 "长度 (uint64) + 原始数据"，字符串同理。格式变化时提高 kVersion。
+
+namespace vcd_cache {
+
+static constexpr char kMagic[8] = {'F', 'S', 'T', 'R', 'A', 'W', 'F', 'C'};
+static constexpr uint32_t kVersion = 1;
+
+// ==================== 源文件键 ====================
+
+struct FileKey {
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t hash;
+
+    FileKey() : size(0), mtime_sec(0), mtime_nsec(0), hash(0) {}
+
+    bool operator==(const FileKey& o) const {
+        return size == o.size && mtime_sec == o.mtime_sec && mtime_nsec == o.mtime_nsec && hash == o.hash;
+    }
+    bool operator!=(const FileKey& o) const { return !(*this == o); }
+};
+
+inline uint64_t fnv1a(const void* data, size_t len, uint64_t h = 1469598103934665603ull) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// 抽样哈希：首尾各 64KB 加中间均匀分布的 64 个 4KB 块，避免为校验读完整个文件
+inline uint64_t sampledHash(const char* data, size_t size) {
+    const size_t kEdge = 64u << 10;
+    const size_t kBlock = 4u << 10;
+    const size_t kBlocks = 64;
+
+    uint64_t h = fnv1a(&size, sizeof(size));
+    if (size <= 2 * kEdge + kBlocks * kBlock) return fnv1a(data, size, h);
+
+    h = fnv1a(data, kEdge, h);
+    for (size_t k = 1; k <= kBlocks; ++k) {
+        size_t off = kEdge + (size - 2 * kEdge - kBlock) * k / (kBlocks + 1);
+        h = fnv1a(data + off, kBlock, h);
+    }
+    return fnv1a(data + size - kEdge, kEdge, h);
+}
+
+inline bool statKey(const std::string& filename, FileKey& key) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return false;
+    key.size = static_cast<uint64_t>(st.st_size);
+    key.mtime_sec = st.st_mtim.tv_sec;
+    key.mtime_nsec = st.st_mtim.tv_nsec;
+    return true;
+}
+
+// 读取源文件的完整键 (含抽样哈希)
+inline bool computeKey(const std::string& filename, FileKey& key) {
+    if (!statKey(filename, key)) return false;
+    vcd_tokenizer::MappedFile mf;
+    if (!mf.open(filename)) return false;
+    key.hash = sampledHash(mf.data(), mf.size());
+    return true;
+}
+
+// ==================== 读写 ====================
+
+class Writer {
+private:
+    std::ofstream out_;
+
+public:
+    explicit Writer(const std::string& path) : out_(path, std::ios::binary | std::ios::trunc) {}
+
+    bool good() const { return out_.good(); }
+    void close() { out_.close(); }
+
+    void bytes(const void* p, size_t n) { out_.write(static_cast<const char*>(p), n); }
+
+    template <typename T>
+    void pod(const T& v) { bytes(&v, sizeof(T)); }
+
+    void str(const std::string& s) {
+        pod<uint64_t>(s.size());
+        bytes(s.data(), s.size());
+    }
+
+    template <typename T>
+    void array(const std::vector<T>& v) {
+        pod<uint64_t>(v.size());
+        bytes(v.data(), v.size() * sizeof(T));
+    }
+};
+
+// 在映射的缓存文件上顺序读取，越界时置失败标志，之后的读取都返回 false
+class Reader {
+private:
+    const char* p_;
+    const char* end_;
+    bool ok_;
+
+public:
+    Reader(const char* begin, const char* end) : p_(begin), end_(end), ok_(true) {}
+
+    bool ok() const { return ok_; }
+
+    bool bytes(void* dst, size_t n) {
+        if (!ok_ || static_cast<size_t>(end_ - p_) < n) return ok_ = false;
+        std::memcpy(dst, p_, n);
+        p_ += n;
+        return true;
+    }
+
+    template <typename T>
+    bool pod(T& v) { return bytes(&v, sizeof(T)); }
+
+    bool str(std::string& s) {
+        uint64_t n = 0;
+        if (!pod(n) || n > static_cast<uint64_t>(end_ - p_)) return ok_ = false;
+        s.assign(p_, n);
+        p_ += n;
+        return true;
+    }
+
+    template <typename T>
+    bool array(std::vector<T>& v) {
+        uint64_t n = 0;
+        if (!pod(n) || n > static_cast<uint64_t>(end_ - p_) / sizeof(T)) return ok_ = false;
+        v.resize(n);
+        return bytes(v.data(), n * sizeof(T));
+    }
+};
+
+} // namespace vcd_cache
+
+#endif // VCD_WAVEFORM_CACHE_HPP
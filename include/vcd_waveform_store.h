@@ -0,0 +1,366 @@
+#ifndef VCD_WAVEFORM_STORE_HPP
+#define VCD_WAVEFORM_STORE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+// ==================== 按信号存储的波形 ====================
+//
+// 只记录每个信号自己的变化序列 (时间, 值)，不再在每个时间戳复制全部信号的快照。
+// 信号用稠密整数编号；变化时间存为全局时间戳表中的下标 (uint32)，值按 2 bit 打包
+// (0/1/X/Z)，按 CSR 方式连续存放。点查询用二分，顺序按周期采样用 Cursor。
+//
+// 使用流程：append() 逐条追加 (允许时间乱序) -> finalize() 压缩成只读结构。
+// 值类型不依赖 VCDValue，编码约定 0='0' 1='1' 2='X' 3='Z'，由调用方转换。
+
+class VCDWaveformStore {
+public:
+    static constexpr uint8_t kValue0 = 0;
+    static constexpr uint8_t kValue1 = 1;
+    static constexpr uint8_t kValueX = 2;
+    static constexpr uint8_t kValueZ = 3;
+
+private:
+    // 构建阶段：所有变化按到达顺序记在一条日志里，finalize 时按信号计数排序成 CSR
+    struct LogEntry {
+        uint32_t signal_value;   // 高 30 位信号编号，低 2 位值
+        uint32_t time_idx;       // build_times_ 的下标
+    };
+    std::vector<LogEntry> log_;
+    std::vector<uint64_t> build_times_;      // 按到达顺序记录的时间戳 (通常单调递增)
+    bool times_monotonic_;
+    size_t build_signals_;
+
+    // 只读结构
+    std::vector<uint64_t> timestamps_;       // 所有出现过变化的时间 (含 0)，升序去重
+    std::vector<uint32_t> offsets_;          // 信号 s 的变化位于 [offsets_[s], offsets_[s+1])
+    std::vector<uint32_t> change_time_idx_;  // 每条变化对应 timestamps_ 的下标
+    std::vector<uint8_t> packed_values_;     // 每字节 4 个 2 bit 值
+    size_t num_change_times_;                // 实际有变化的时间戳个数
+    bool finalized_;
+
+    uint8_t packedValue(size_t g) const {
+        return (packed_values_[g >> 2] >> ((g & 3) * 2)) & 3;
+    }
+
+public:
+    VCDWaveformStore() : times_monotonic_(true), build_signals_(0), num_change_times_(0), finalized_(false) {}
+
+    void clear() {
+        log_.clear();
+        build_times_.clear();
+        times_monotonic_ = true;
+        build_signals_ = 0;
+        timestamps_.clear();
+        offsets_.clear();
+        change_time_idx_.clear();
+        packed_values_.clear();
+        num_change_times_ = 0;
+        finalized_ = false;
+    }
+
+    // ==================== 构建 ====================
+
+    void append(int signal, uint64_t time, uint8_t value) {
+        if (signal < 0) return;
+        if (finalized_) {
+            std::cerr << "错误：波形存储已压缩，不能继续追加" << std::endl;
+            return;
+        }
+        if (build_times_.empty() || build_times_.back() != time) {
+            if (!build_times_.empty() && time < build_times_.back()) times_monotonic_ = false;
+            build_times_.push_back(time);
+        }
+        if (static_cast<size_t>(signal) >= build_signals_) build_signals_ = signal + 1;
+        log_.push_back(LogEntry{(static_cast<uint32_t>(signal) << 2) | (value & 3u),
+                                static_cast<uint32_t>(build_times_.size() - 1)});
+    }
+
+    void reserveChanges(size_t n) { log_.reserve(n); }
+
+    // 构建阶段已追加的变化条数，配合 setSignal 修正占位的信号编号
+    size_t pendingChanges() const { return log_.size(); }
+
+    void setSignal(size_t entry, int signal) {
+        if (entry >= log_.size() || signal < 0) return;
+        if (static_cast<size_t>(signal) >= build_signals_) build_signals_ = signal + 1;
+        log_[entry].signal_value = (static_cast<uint32_t>(signal) << 2) | (log_[entry].signal_value & 3u);
+    }
+
+    // 把另一个构建阶段的存储 (时间上接在本存储之后的一段) 追加进来，other 被清空。
+    // 分段并行解析后按段顺序调用即可得到与顺序解析相同的日志
+    void append(VCDWaveformStore& other) {
+        if (finalized_ || other.finalized_) {
+            std::cerr << "错误：波形存储已压缩，不能合并" << std::endl;
+            return;
+        }
+        if (other.log_.empty() && other.build_times_.empty()) return;
+
+        // 衔接处时间相同时合并为同一个时间点
+        size_t first = 0;
+        uint32_t base = build_times_.size();
+        if (!build_times_.empty() && !other.build_times_.empty()) {
+            if (other.build_times_.front() == build_times_.back()) {
+                first = 1;
+                base -= 1;
+            } else if (other.build_times_.front() < build_times_.back()) {
+                times_monotonic_ = false;
+            }
+        }
+        times_monotonic_ = times_monotonic_ && other.times_monotonic_;
+        build_times_.insert(build_times_.end(), other.build_times_.begin() + first, other.build_times_.end());
+        build_signals_ = std::max(build_signals_, other.build_signals_);
+
+        log_.reserve(log_.size() + other.log_.size());
+        for (const auto& e : other.log_) {
+            log_.push_back(LogEntry{e.signal_value, e.time_idx + base});
+        }
+        other.clear();
+    }
+
+    void reserveSignals(size_t n) {
+        if (build_signals_ < n) build_signals_ = n;
+    }
+
+    // 压缩为只读结构；没有任何变化时返回 false
+    bool finalize() {
+        if (finalized_) return !timestamps_.empty();
+        if (log_.empty()) return false;
+
+        // 全局时间表：升序去重，并保证时间 0 (所有信号的初始状态) 是一个采样点
+        std::vector<uint32_t> remap(build_times_.size());
+        if (times_monotonic_) {
+            timestamps_ = build_times_;
+            num_change_times_ = timestamps_.size();
+            const uint32_t shift = timestamps_.front() != 0 ? 1 : 0;
+            if (shift) timestamps_.insert(timestamps_.begin(), 0);
+            for (size_t i = 0; i < remap.size(); ++i) remap[i] = i + shift;
+        } else {
+            timestamps_ = build_times_;
+            std::sort(timestamps_.begin(), timestamps_.end());
+            timestamps_.erase(std::unique(timestamps_.begin(), timestamps_.end()), timestamps_.end());
+            num_change_times_ = timestamps_.size();
+            if (timestamps_.front() != 0) timestamps_.insert(timestamps_.begin(), 0);
+            for (size_t i = 0; i < remap.size(); ++i) {
+                remap[i] = std::lower_bound(timestamps_.begin(), timestamps_.end(), build_times_[i])
+                           - timestamps_.begin();
+            }
+        }
+        build_times_.clear();
+        build_times_.shrink_to_fit();
+
+        // 按信号计数排序 (稳定，保持到达顺序)
+        const size_t n = build_signals_;
+        std::vector<uint32_t> count(n + 1, 0);
+        for (const auto& e : log_) ++count[(e.signal_value >> 2) + 1];
+        for (size_t s = 0; s < n; ++s) count[s + 1] += count[s];
+
+        std::vector<uint32_t> times(log_.size());
+        std::vector<uint8_t> values(log_.size());
+        {
+            std::vector<uint32_t> fill(count.begin(), count.end() - 1);
+            for (const auto& e : log_) {
+                uint32_t& k = fill[e.signal_value >> 2];
+                times[k] = remap[e.time_idx];
+                values[k] = e.signal_value & 3;
+                ++k;
+            }
+        }
+        log_.clear();
+        log_.shrink_to_fit();
+
+        // 每个信号内部按时间排序 (到达顺序单调时已有序)，同一时刻保留最后一次赋值
+        offsets_.assign(n + 1, 0);
+        size_t out = 0;
+        std::vector<size_t> order;
+        for (size_t s = 0; s < n; ++s) {
+            const size_t begin = count[s];
+            const size_t end = count[s + 1];
+            offsets_[s] = out;
+
+            bool sorted = true;
+            for (size_t k = begin + 1; k < end; ++k) {
+                if (times[k] < times[k - 1]) { sorted = false; break; }
+            }
+            if (!sorted) {
+                order.resize(end - begin);
+                std::iota(order.begin(), order.end(), begin);
+                std::stable_sort(order.begin(), order.end(),
+                                 [&](size_t a, size_t b) { return times[a] < times[b]; });
+                std::vector<uint32_t> t2(order.size());
+                std::vector<uint8_t> v2(order.size());
+                for (size_t i = 0; i < order.size(); ++i) {
+                    t2[i] = times[order[i]];
+                    v2[i] = values[order[i]];
+                }
+                std::copy(t2.begin(), t2.end(), times.begin() + begin);
+                std::copy(v2.begin(), v2.end(), values.begin() + begin);
+            }
+
+            for (size_t k = begin; k < end; ++k) {
+                if (out > offsets_[s] && times[out - 1] == times[k]) {
+                    values[out - 1] = values[k];
+                } else {
+                    times[out] = times[k];
+                    values[out] = values[k];
+                    ++out;
+                }
+            }
+        }
+        offsets_[n] = out;
+
+        times.resize(out);
+        times.shrink_to_fit();
+        change_time_idx_.swap(times);
+        packed_values_.assign((out + 3) / 4, 0);
+        for (size_t g = 0; g < out; ++g) {
+            packed_values_[g >> 2] |= values[g] << ((g & 3) * 2);
+        }
+
+        finalized_ = true;
+        return true;
+    }
+
+    // ==================== 查询 ====================
+
+    bool empty() const { return timestamps_.empty(); }
+    bool finalized() const { return finalized_; }
+    size_t numSignals() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    size_t numChanges() const { return change_time_idx_.size(); }
+    size_t numChangeTimes() const { return num_change_times_; }
+    const std::vector<uint64_t>& timestamps() const { return timestamps_; }
+
+    size_t memoryBytes() const {
+        return timestamps_.capacity() * sizeof(uint64_t) + offsets_.capacity() * sizeof(uint32_t) +
+               change_time_idx_.capacity() * sizeof(uint32_t) + packed_values_.capacity();
+    }
+
+    // 信号在时间下标 ti 时刻 (含该时刻的变化) 的值；之前没有变化时为 X
+    uint8_t valueAtIndex(int signal, size_t ti) const {
+        if (signal < 0 || static_cast<size_t>(signal) >= numSignals()) return kValueX;
+        auto first = change_time_idx_.begin() + offsets_[signal];
+        auto last = change_time_idx_.begin() + offsets_[signal + 1];
+        auto it = std::upper_bound(first, last, static_cast<uint32_t>(ti));
+        if (it == first) return kValueX;
+        return packedValue((it - change_time_idx_.begin()) - 1);
+    }
+
+    uint8_t valueAt(int signal, uint64_t time) const {
+        auto it = std::upper_bound(timestamps_.begin(), timestamps_.end(), time);
+        if (it == timestamps_.begin()) return kValueX;
+        return valueAtIndex(signal, (it - timestamps_.begin()) - 1);
+    }
+
+    // 与 time 最接近的采样时间下标，距离相同时取较早者
+    size_t nearestTimeIndex(uint64_t time) const {
+        auto it = std::lower_bound(timestamps_.begin(), timestamps_.end(), time);
+        if (it == timestamps_.end()) return timestamps_.size() - 1;
+        if (*it == time || it == timestamps_.begin()) return it - timestamps_.begin();
+        auto prev = it - 1;
+        return (time - *prev <= *it - time) ? prev - timestamps_.begin() : it - timestamps_.begin();
+    }
+
+    // 遍历某个信号的变化 fn(time, value)
+    template <typename Fn>
+    void forEachChange(int signal, Fn&& fn) const {
+        if (signal < 0 || static_cast<size_t>(signal) >= numSignals()) return;
+        for (size_t g = offsets_[signal]; g < offsets_[signal + 1]; ++g) {
+            fn(timestamps_[change_time_idx_[g]], packedValue(g));
+        }
+    }
+
+    // ==================== 序列化 ====================
+    //
+    // 只保存压缩后的列 (时间表、CSR 偏移、变化时间下标、打包值)，W/R 为 vcd_cache::Writer/Reader
+
+    template <typename W>
+    bool save(W& w) const {
+        if (!finalized_) return false;
+        w.template pod<uint64_t>(num_change_times_);
+        w.array(timestamps_);
+        w.array(offsets_);
+        w.array(change_time_idx_);
+        w.array(packed_values_);
+        return true;
+    }
+
+    template <typename R>
+    bool load(R& r) {
+        clear();
+        uint64_t change_times = 0;
+        if (!r.pod(change_times) || !r.array(timestamps_) || !r.array(offsets_) ||
+            !r.array(change_time_idx_) || !r.array(packed_values_)) {
+            clear();
+            return false;
+        }
+        // 结构校验：偏移单调且覆盖全部变化，打包值长度匹配
+        bool valid = !offsets_.empty() && offsets_.front() == 0 &&
+                     offsets_.back() == change_time_idx_.size() &&
+                     packed_values_.size() == (change_time_idx_.size() + 3) / 4;
+        for (size_t s = 1; valid && s < offsets_.size(); ++s) valid = offsets_[s - 1] <= offsets_[s];
+        for (size_t g = 0; valid && g < change_time_idx_.size(); ++g) valid = change_time_idx_[g] < timestamps_.size();
+        if (!valid) {
+            clear();
+            return false;
+        }
+        num_change_times_ = change_times;
+        build_signals_ = offsets_.size() - 1;
+        finalized_ = true;
+        return true;
+    }
+
+    // ==================== 顺序采样 ====================
+    //
+    // 时间单调前进时，每个信号只向前移动自己的指针，按周期采样的总代价与变化数成正比
+
+    class Cursor {
+    private:
+        const VCDWaveformStore* store_;
+        std::vector<uint32_t> pos_;    // 信号下一条未应用变化的全局下标
+        size_t time_idx_;
+        bool started_;
+
+    public:
+        explicit Cursor(const VCDWaveformStore& store)
+            : store_(&store), time_idx_(0), started_(false) {
+            pos_.assign(store.numSignals(), 0);
+            for (size_t s = 0; s < pos_.size(); ++s) pos_[s] = store.offsets_[s];
+        }
+
+        // 前进到 time (只能向后)，返回是否成功
+        bool seek(uint64_t time) {
+            auto it = std::upper_bound(store_->timestamps_.begin(), store_->timestamps_.end(), time);
+            if (it == store_->timestamps_.begin()) return false;
+            size_t ti = (it - store_->timestamps_.begin()) - 1;
+            if (started_ && ti < time_idx_) return false;
+            time_idx_ = ti;
+            started_ = true;
+            return true;
+        }
+
+        bool seekIndex(size_t ti) {
+            if (ti >= store_->timestamps_.size() || (started_ && ti < time_idx_)) return false;
+            time_idx_ = ti;
+            started_ = true;
+            return true;
+        }
+
+        uint64_t time() const { return store_->timestamps_[time_idx_]; }
+
+        uint8_t value(int signal) {
+            if (!started_ || signal < 0 || static_cast<size_t>(signal) >= pos_.size()) return kValueX;
+            uint32_t& p = pos_[signal];
+            const uint32_t last = store_->offsets_[signal + 1];
+            while (p < last && store_->change_time_idx_[p] <= time_idx_) ++p;
+            if (p == store_->offsets_[signal]) return kValueX;
+            return store_->packedValue(p - 1);
+        }
+    };
+
+    Cursor cursor() const { return Cursor(*this); }
+};
+
+#endif // VCD_WAVEFORM_STORE_HPP
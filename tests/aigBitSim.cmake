@@ -0,0 +1 @@
+target_sources(${basename} PRIVATE ${CMAKE_SOURCE_DIR}/work/aig_bit_simulator.cpp)
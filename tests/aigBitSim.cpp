@@ -0,0 +1,84 @@
+#include "aig_bit_simulator.h"
+#include "test_utils.h"
+#include <iostream>
+#include <vector>
+
+// 在一个随机生成的时序 AIG 上比较位并行仿真 (64 路与 256 路) 和逐通道的标量参考仿真。
+// 用法: aigBitSim [PI数] [寄存器数] [门数] [周期数]
+
+// 标量参考：按节点号 (拓扑序) 逐个求值，只看第 lane 个通道的激励
+static int checkLane(const mockturtle::aig_network& aig, const LevelizedAIG& lv, const GoldenTrace& trace, int lane) {
+    int errors = 0;
+    std::vector<bool> value(aig.size(), false);
+    std::vector<bool> state(lv.ros.size(), false);
+
+    for (int c = 1; c <= trace.numCycles(); ++c) {
+        for (uint32_t pi : lv.pis) value[pi] = trace.value(pi, c, lane);
+        for (size_t r = 0; r < lv.ros.size(); ++r) {
+            value[lv.ros[r]] = state[r];
+            if (trace.value(lv.ros[r], c, lane) != state[r]) ++errors;
+        }
+
+        aig.foreach_gate([&](auto node) {
+            bool out = true;
+            aig.foreach_fanin(node, [&](auto signal) {
+                out = out && (value[aig.get_node(signal)] != aig.is_complemented(signal));
+            });
+            value[aig.node_to_index(node)] = out;
+            if (trace.value(aig.node_to_index(node), c, lane) != out) ++errors;
+        });
+
+        aig.foreach_po([&](auto signal, auto i) {
+            bool v = value[aig.get_node(signal)] != aig.is_complemented(signal);
+            if (trace.getPOValue(i, c, lane) != v) ++errors;
+        });
+
+        aig.foreach_ri([&](auto signal, auto i) {
+            state[i] = value[aig.get_node(signal)] != aig.is_complemented(signal);
+        });
+    }
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    int num_pis = argc > 1 ? std::atoi(argv[1]) : 8;
+    int num_regs = argc > 2 ? std::atoi(argv[2]) : 6;
+    int num_gates = argc > 3 ? std::atoi(argv[3]) : 300;
+    int num_cycles = argc > 4 ? std::atoi(argv[4]) : 20;
+
+    mockturtle::aig_network aig = makeRandomSequentialAIG(num_pis, num_regs, num_gates, 4);
+    LevelizedAIG lv = LevelizedAIG::build(aig);
+    std::cout << "AIG: " << lv.pis.size() << " PIs, " << lv.ros.size() << " registers, "
+              << lv.numGates() << " gates, depth " << lv.depth << std::endl;
+
+    int errors = 0;
+    for (int lanes : {64, 256}) {
+        AigBitSimulator sim(lv, lanes);
+        sim.setRandomStimulus(99);
+        GoldenTrace trace;
+        if (!sim.run(num_cycles, trace)) return 1;
+
+        int lane_errors = 0;
+        for (int lane = 0; lane < trace.numLanes(); lane += 13) {
+            lane_errors += checkLane(aig, lv, trace, lane);
+        }
+        std::cout << lanes << " lanes: " << lane_errors << " mismatches" << std::endl;
+        errors += lane_errors;
+    }
+
+    // 显式激励广播到所有通道，P(1) 只能是 0 或 1
+    std::vector<std::vector<bool>> seq(num_cycles, std::vector<bool>(num_pis));
+    for (int c = 0; c < num_cycles; ++c)
+        for (int i = 0; i < num_pis; ++i) seq[c][i] = ((c * 31 + i * 17) % 5) < 2;
+    AigBitSimulator sim(lv, 64);
+    sim.setStimulus(seq);
+    GoldenTrace trace;
+    if (!sim.run(num_cycles, trace)) return 1;
+    for (uint32_t node : lv.gates) {
+        int ones = trace.countOnes(node, num_cycles);
+        if (ones != 0 && ones != 64) ++errors;
+    }
+    errors += checkLane(aig, lv, trace, 5);
+
+    return reportResults(errors);
+}
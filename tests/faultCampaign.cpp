@@ -0,0 +1,85 @@
+#include "fault_campaign.h"
+#include "test_utils.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 比较 PPSFP 故障仿真与逐故障、逐向量的标量全量仿真：
+// 不丢弃故障时每个故障的激活数、检出数、首次检出向量都应一致；
+// 丢弃故障时检出集合与首次检出向量一致。
+// 用法: faultCampaign [门数] [向量数]
+
+// 标量参考：逐向量求值，固定值节点取故障值，比较 PO 与寄存器输入
+static void evaluate(const LevelizedAIG& lv, const std::vector<bool>& pattern, int stuck_node, bool stuck_value,
+                     std::vector<uint8_t>& v) {
+    v.assign(lv.num_nodes, 0);
+    for (size_t i = 0; i < lv.pis.size(); ++i) v[lv.pis[i]] = pattern[i];
+    for (size_t r = 0; r < lv.ros.size(); ++r) v[lv.ros[r]] = pattern[lv.pis.size() + r];
+    if (stuck_node >= 0 && !lv.isGate(stuck_node)) v[stuck_node] = stuck_value;
+    for (size_t g = 0; g < lv.gates.size(); ++g) {
+        const uint32_t n = lv.gates[g];
+        v[n] = (int)n == stuck_node ? stuck_value
+             : (v[lv.fanin0[g] >> 1] ^ (lv.fanin0[g] & 1)) & (v[lv.fanin1[g] >> 1] ^ (lv.fanin1[g] & 1));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int num_gates = argc > 1 ? std::atoi(argv[1]) : 400;
+    const int num_patterns = argc > 2 ? std::atoi(argv[2]) : 150;
+
+    mockturtle::aig_network aig = makeRandomSequentialAIG(10, 6, num_gates, 5, 11, 30);
+    LevelizedAIG lv = LevelizedAIG::build(aig);
+
+    std::mt19937 gen(5);
+    std::vector<std::vector<bool>> patterns(num_patterns, std::vector<bool>(lv.pis.size() + lv.ros.size()));
+    for (auto& p : patterns)
+        for (size_t i = 0; i < p.size(); ++i) p[i] = gen() & 1;
+
+    FaultCampaign campaign(lv);
+    campaign.set_fault_dropping(false);
+    if (!campaign.run(patterns)) return 1;
+    campaign.print_summary();
+
+    int errors = 0;
+    std::vector<uint8_t> good, bad;
+    for (const auto& r : campaign.get_results()) {
+        long long activations = 0, detections = 0, first = -1;
+        for (int p = 0; p < num_patterns; ++p) {
+            evaluate(lv, patterns[p], -1, false, good);
+            if (good[r.fault.node] == r.fault.value) continue;
+            ++activations;
+            evaluate(lv, patterns[p], r.fault.node, r.fault.value, bad);
+            bool detected = false;
+            for (uint32_t lit : lv.pos) detected |= good[lit >> 1] != bad[lit >> 1];
+            for (uint32_t lit : lv.ris) detected |= good[lit >> 1] != bad[lit >> 1];
+            if (detected) {
+                ++detections;
+                if (first < 0) first = p;
+            }
+        }
+        if (activations != r.activations || detections != r.detections || first != r.first_detection) ++errors;
+    }
+    std::cout << "no dropping: " << errors << " mismatches" << std::endl;
+
+    // 丢弃故障后检出结果不变
+    FaultCampaign dropping(lv);
+    dropping.run(patterns);
+    int drop_errors = 0;
+    for (size_t i = 0; i < dropping.get_results().size(); ++i) {
+        if (dropping.get_results()[i].first_detection != campaign.get_results()[i].first_detection) ++drop_errors;
+    }
+    std::cout << "fault dropping: " << drop_errors << " mismatches" << std::endl;
+    errors += drop_errors;
+
+    // 随机向量：同一种子两次运行结果相同
+    FaultCampaign r1(lv), r2(lv);
+    r1.run_random(1000, 42);
+    r2.run_random(1000, 42);
+    for (size_t i = 0; i < r1.get_results().size(); ++i) {
+        if (r1.get_results()[i].first_detection != r2.get_results()[i].first_detection) ++errors;
+    }
+    r1.print_summary();
+
+    return reportResults(errors);
+}
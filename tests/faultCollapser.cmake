@@ -0,0 +1,4 @@
+target_sources(${basename} PRIVATE
+    ${CMAKE_SOURCE_DIR}/work/fault_collapser.cpp
+    ${CMAKE_SOURCE_DIR}/work/fault_campaign.cpp
+    ${CMAKE_SOURCE_DIR}/work/aig_bit_simulator.cpp)
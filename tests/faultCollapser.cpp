@@ -0,0 +1,68 @@
+#include "fault_collapser.h"
+#include "test_utils.h"
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// 在不丢弃故障的全故障仿真上检查压缩关系：同一等价类中的故障检出数与首次检出向量相同；
+// 被支配丢弃的故障在其依赖的代表检出时也被检出，且检出不晚于代表。
+// 再只仿真代表故障并展开，检出结果应与全故障仿真一致 (支配丢弃的故障只检查蕴含方向)。
+// 用法: faultCollapser [门数] [向量数]
+
+int main(int argc, char* argv[]) {
+    const int num_gates = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int num_patterns = argc > 2 ? std::atoi(argv[2]) : 4000;
+
+    mockturtle::aig_network aig = makeRandomSequentialAIG(12, 8, num_gates, 8, 23, 200);
+    LevelizedAIG lv = LevelizedAIG::build(aig);
+
+    FaultCollapser collapser(lv);
+    collapser.print_summary();
+
+    FaultCampaign full(lv);
+    full.set_fault_dropping(false);
+    full.set_fault_list(collapser.faults());
+    if (!full.run_random(num_patterns, 3)) return 1;
+    const auto& truth = full.get_results();
+
+    int errors = 0;
+    for (size_t r = 0; r < collapser.representatives().size(); ++r) {
+        const auto& members = collapser.members(r);
+        const auto& rep = truth[members.front()];
+        for (uint32_t f : members) {
+            if (truth[f].detections != rep.detections || truth[f].first_detection != rep.first_detection) ++errors;
+        }
+        for (uint32_t f : collapser.implied(r)) {
+            if (rep.detected() && (!truth[f].detected() || truth[f].first_detection > rep.first_detection)) ++errors;
+        }
+    }
+    std::cout << "collapse relations: " << errors << " violations" << std::endl;
+
+    // 只仿真代表故障 (丢弃检出故障) 再展开
+    FaultCampaign collapsed(lv);
+    collapsed.set_fault_list(collapser.representatives());
+    if (!collapsed.run_random(num_patterns, 3)) return 1;
+    const auto expanded = collapser.expand(collapsed.get_results());
+    std::vector<uint8_t> dominated(truth.size(), 0);
+    for (size_t r = 0; r < collapser.representatives().size(); ++r)
+        for (uint32_t f : collapser.implied(r)) dominated[f] = 1;
+
+    int expand_errors = 0;
+    for (size_t f = 0; f < truth.size(); ++f) {
+        if (dominated[f] ? expanded[f].detected() && !truth[f].detected()
+                         : expanded[f].first_detection != truth[f].first_detection) ++expand_errors;
+    }
+    std::cout << "expanded results: " << expand_errors << " mismatches" << std::endl;
+    errors += expand_errors;
+
+    full.print_summary();
+    collapsed.print_summary();
+
+    // 展开结果写回后按全部故障汇总
+    collapsed.set_results(expanded);
+    if (collapsed.get_results().size() != truth.size() || collapsed.get_fault_list().size() != truth.size() ||
+        collapsed.get_num_detected() > full.get_num_detected()) ++errors;
+    collapsed.print_summary();
+
+    return reportResults(errors);
+}
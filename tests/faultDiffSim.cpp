@@ -0,0 +1,108 @@
+#include "fault_injector.h"
+#include "test_utils.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 比较差分故障仿真 (只沿故障扇出锥传播差异) 与逐节点全量重算：
+//   单周期：与 simulate_with_faults 的 PO 值一致；
+//   多周期：与带故障的全量时序参考仿真一致 (寄存器差异带入下一周期)。
+// 同时报告平均求值门数占总门数的比例。
+// 用法: faultDiffSim [门数] [周期数] [故障场景数]
+
+// 全量参考：每周期按节点号顺序重算所有门，固定值节点取故障值
+static std::vector<std::vector<bool>> referenceSequence(const LevelizedAIG& lv, const std::vector<std::vector<uint8_t>>& golden,
+                                                        const std::vector<int8_t>& stuck, int first, int count) {
+    std::vector<std::vector<bool>> outputs;
+    std::vector<uint8_t> v;
+    std::vector<uint8_t> latched;
+    for (int c = first; c < first + count; ++c) {
+        v = golden[c];
+        if (c > first) {
+            for (size_t r = 0; r < lv.ros.size(); ++r) v[lv.ros[r]] = latched[r];
+        }
+        for (uint32_t n = 0; n < lv.num_nodes; ++n) {
+            if (stuck[n] >= 0 && !lv.isGate(n)) v[n] = stuck[n];
+        }
+        for (size_t g = 0; g < lv.gates.size(); ++g) {
+            const uint32_t n = lv.gates[g];
+            v[n] = stuck[n] >= 0 ? stuck[n]
+                 : (v[lv.fanin0[g] >> 1] ^ (lv.fanin0[g] & 1)) & (v[lv.fanin1[g] >> 1] ^ (lv.fanin1[g] & 1));
+        }
+        std::vector<bool> po;
+        for (uint32_t lit : lv.pos) po.push_back(v[lit >> 1] ^ (lit & 1));
+        outputs.push_back(po);
+        latched.clear();
+        for (uint32_t lit : lv.ris) latched.push_back(v[lit >> 1] ^ (lit & 1));
+    }
+    return outputs;
+}
+
+int main(int argc, char* argv[]) {
+    const int num_gates = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int num_cycles = argc > 2 ? std::atoi(argv[2]) : 30;
+    const int scenarios = argc > 3 ? std::atoi(argv[3]) : 300;
+
+    CircuitReliabilitySimulator sim;
+    auto& aig = sim.get_circuit();
+    const int num_pis = 6;
+    std::mt19937 circuit_gen(3);
+    buildRandomSequentialAIG(aig, num_pis, 8, num_gates, 6, circuit_gen, 40);   // 偏向最近的节点，形成较深的锥
+
+    // 无故障时序仿真，记录每周期全部节点值
+    std::mt19937 gen(17);
+    std::vector<std::vector<bool>> inputs(num_cycles, std::vector<bool>(num_pis));
+    for (auto& row : inputs)
+        for (int i = 0; i < num_pis; ++i) row[i] = gen() & 1;
+    sim.set_trace_keyframe_interval(16);
+    sim.simulate_sequential_circuit(inputs, num_cycles);
+    const LevelizedAIG& lv = sim.get_levelized();
+    std::vector<std::vector<uint8_t>> golden(num_cycles);
+    for (int c = 0; c < num_cycles; ++c) {
+        if (!sim.get_trace().values_at(c, golden[c])) return 1;
+    }
+
+    FaultInjector injector(aig);
+    if (!injector.set_golden_trace(sim.get_trace())) return 1;
+
+    int errors = 0;
+    double evaluated = 0, full = 0;
+    for (int s = 0; s < scenarios; ++s) {
+        injector.clear_faults();
+        std::vector<int8_t> stuck(lv.num_nodes, -1);
+        const int faults = 1 + s % 3;
+        for (int f = 0; f < faults; ++f) {
+            // 大多数故障在门上，少数在 PI/寄存器输出上
+            uint32_t n = (s % 10 == 0 && f == 0) ? (gen() & 1 ? lv.pis[gen() % lv.pis.size()] : lv.ros[gen() % lv.ros.size()])
+                                                 : lv.gates[gen() % lv.gates.size()];
+            const bool value = gen() & 1;
+            stuck[n] = value;
+            injector.set_stuck_at_fault(aig.index_to_node(n), value);
+        }
+
+        // 单周期与 simulate_with_faults 比较
+        const int cycle = s % num_cycles;
+        std::unordered_map<mockturtle::aig_network::node, bool> node_values;
+        for (uint32_t n = 0; n < lv.num_nodes; ++n) node_values[aig.index_to_node(n)] = golden[cycle][n];
+        for (uint32_t n : lv.pis) {
+            if (stuck[n] >= 0) node_values[aig.index_to_node(n)] = stuck[n];
+        }
+        for (uint32_t n : lv.ros) {
+            if (stuck[n] >= 0) node_values[aig.index_to_node(n)] = stuck[n];
+        }
+        if (injector.simulate_with_faults_differential(cycle) != injector.simulate_with_faults(inputs[cycle], node_values)) ++errors;
+        if (injector.simulate_with_faults_differential(cycle) != referenceSequence(lv, golden, stuck, cycle, 1)[0]) ++errors;
+
+        // 多周期时序传播
+        const int first = s % 5;
+        const int count = num_cycles - first;
+        if (injector.simulate_sequence_differential(first, count) != referenceSequence(lv, golden, stuck, first, count)) ++errors;
+        evaluated += injector.get_last_evaluated_gates();
+        full += (double)lv.gates.size() * count;
+    }
+
+    std::cout << lv.gates.size() << " gates, " << scenarios << " scenarios: " << errors << " mismatches, "
+              << "differential evaluated " << 100.0 * evaluated / full << "% of gate evaluations" << std::endl;
+    return reportResults(errors);
+}
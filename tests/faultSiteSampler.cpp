@@ -0,0 +1,119 @@
+#include "fault_site_sampler.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 比较几何跳跃抽样 / 按字掩码抽样与逐位置 Bernoulli 抽样的统计量：
+// 每次抽样的故障数 (均值、方差)、各位置的边缘频率、相邻位置同时出错的频率。
+// 用法: faultSiteSampler [位置数] [抽样次数]
+
+struct Stats {
+    std::vector<double> site;    // 各位置出错次数
+    double adjacent = 0;         // 相邻两位置同时出错的次数
+    double sum = 0, sumSq = 0;   // 每次抽样故障数的和、平方和
+    int trials = 0;
+
+    explicit Stats(int n) : site(n, 0.0) {}
+
+    void add(const std::vector<uint8_t>& hit) {
+        int count = 0;
+        for (size_t i = 0; i < hit.size(); ++i) {
+            site[i] += hit[i];
+            count += hit[i];
+            if (i + 1 < hit.size() && hit[i] && hit[i + 1]) adjacent += 1;
+        }
+        sum += count;
+        sumSq += double(count) * count;
+        ++trials;
+    }
+    double mean() const { return sum / trials; }
+    double variance() const { return sumSq / trials - mean() * mean(); }
+};
+
+// 观测值与期望值相差超过 z 个标准差则报错
+static bool within(const char* what, double observed, double expected, double sigma, double z = 5.0) {
+    bool ok = std::fabs(observed - expected) <= z * sigma + 1e-12;
+    if (!ok) {
+        std::cerr << "  " << what << ": observed " << observed << ", expected " << expected
+                  << " (sigma " << sigma << ")" << std::endl;
+    }
+    return ok;
+}
+
+// 对照理论值检查一组抽样结果
+static int check(const char* name, const Stats& s, int n, double p) {
+    int errors = 0;
+    const double t = s.trials;
+    const double mean = n * p;
+    const double var = n * p * (1 - p);
+
+    errors += !within("mean", s.mean(), mean, std::sqrt(var / t));
+    // 样本方差的标准误 sqrt((mu4 - var^2) / t)，mu4 取二项分布四阶中心矩
+    const double mu4 = var * (1 + 3 * (n - 2) * p * (1 - p));
+    errors += !within("variance", s.variance(), var, std::sqrt((mu4 - var * var) / t));
+
+    // 各位置边缘频率：卡方统计量应接近自由度 n
+    double chi2 = 0;
+    for (int i = 0; i < n; ++i) {
+        double e = t * p;
+        chi2 += (s.site[i] - e) * (s.site[i] - e) / (e * (1 - p));
+    }
+    errors += !within("site chi-square", chi2, n, std::sqrt(2.0 * n));
+
+    // 相邻位置独立：同时出错的次数应为 t * (n-1) * p^2
+    double pairs = t * (n - 1);
+    errors += !within("adjacent pairs", s.adjacent, pairs * p * p, std::sqrt(pairs * p * p * (1 - p * p)));
+
+    std::cout << "  " << name << ": mean " << s.mean() << " (" << mean << "), var "
+              << s.variance() << " (" << var << "), chi2/n " << chi2 / n
+              << ", adjacent " << s.adjacent << " (" << pairs * p * p << ")"
+              << (errors ? "  FAIL" : "") << std::endl;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 256;
+    int trials = argc > 2 ? std::atoi(argv[2]) : 200000;
+    n = (n + 63) / 64 * 64;
+
+    int errors = 0;
+    for (double p : {1e-4, 1e-3, 0.05, 0.3}) {
+        std::cout << "p = " << p << ", " << n << " sites, " << trials << " trials" << std::endl;
+        std::mt19937_64 rng(12345);
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        FaultSiteSampler sampler(p);
+        std::vector<uint8_t> hit(n);
+
+        Stats naive(n), geometric(n), mask(n);
+        std::vector<uint64_t> sites;
+        for (int t = 0; t < trials; ++t) {
+            for (int i = 0; i < n; ++i) hit[i] = dist(rng) < p;
+            naive.add(hit);
+
+            sites.clear();
+            sampler.sample(n, rng, sites);
+            std::fill(hit.begin(), hit.end(), 0);
+            for (size_t k = 0; k < sites.size(); ++k) {
+                if (sites[k] >= (uint64_t)n || (k > 0 && sites[k] <= sites[k - 1])) ++errors;
+                else hit[sites[k]] = 1;
+            }
+            geometric.add(hit);
+
+            for (int w = 0; w < n / 64; ++w) {
+                uint64_t m = sampler.mask64(rng);
+                for (int b = 0; b < 64; ++b) hit[w * 64 + b] = (m >> b) & 1;
+            }
+            mask.add(hit);
+        }
+
+        errors += check("naive", naive, n, p);
+        errors += check("geometric", geometric, n, p);
+        errors += check("mask64", mask, n, p);
+    }
+
+    return reportResults(errors);
+}
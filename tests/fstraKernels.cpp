@@ -0,0 +1,126 @@
+#include "fstra_kernels.h"
+#include "test_utils.h"
+#include <unsupported/Eigen/KroneckerProduct>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// fstra_kernels 的编译期特化内核与 FSTRAAnalyzer 动态路径的逐元素比较：
+//   combine 对应 removeDuplicateElements (按合并编码拆出子编码，取两行的 Kronecker 积)，
+//   contract 对应 del_rMr (约去的源乘 opV^T，保留的源乘 I2，再左乘 optM)；
+// n = 0..kMaxFixedFsL 的每个实例随机取列表和矩阵，超出特化范围时分派必须返回 false。
+// 用法: fstraKernels [每个 n 的随机轮数]
+
+using fstra_kernels::kMaxFixedCols;
+using fstra_kernels::kMaxFixedFsL;
+
+// 合并编码中属于 sub 的各位组成子编码 (MSB 在前)
+static int subCode(int code, const std::vector<int>& com, const std::vector<int>& sub) {
+    int result = 0;
+    for (size_t i = 0; i < sub.size(); ++i) {
+        const int pos = std::find(com.begin(), com.end(), sub[i]) - com.begin();
+        if ((code >> (com.size() - 1 - pos)) & 1) result |= 1 << (sub.size() - 1 - i);
+    }
+    return result;
+}
+
+static Eigen::MatrixXd combineReference(const Eigen::MatrixXd& A, const std::vector<int>& fsA,
+                                        const Eigen::MatrixXd& B, const std::vector<int>& fsB,
+                                        const std::vector<int>& com) {
+    Eigen::MatrixXd out(1 << com.size(), A.cols() * B.cols());
+    for (int code = 0; code < out.rows(); ++code) {
+        Eigen::RowVectorXd a = A.row(subCode(code, com, fsA) % A.rows());
+        Eigen::RowVectorXd b = B.row(subCode(code, com, fsB) % B.rows());
+        out.row(code) = Eigen::kroneckerProduct(a, b);
+    }
+    return out;
+}
+
+static Eigen::MatrixXd contractReference(const Eigen::MatrixXd& M, const std::vector<const Eigen::Vector2d*>& opv) {
+    Eigen::MatrixXd left = Eigen::MatrixXd::Identity(1, 1);
+    for (const Eigen::Vector2d* v : opv) {
+        Eigen::MatrixXd next = v ? Eigen::MatrixXd(Eigen::kroneckerProduct(left, v->transpose()))
+                                 : Eigen::MatrixXd(Eigen::kroneckerProduct(left, Eigen::Matrix2d::Identity()));
+        left = next;
+    }
+    return left * M;
+}
+
+static Eigen::MatrixXd randomMatrix(Eigen::Index rows, Eigen::Index cols, std::mt19937& gen) {
+    std::uniform_real_distribution<double> value(0.0, 1.0);
+    Eigen::MatrixXd m(rows, cols);
+    for (Eigen::Index i = 0; i < m.size(); ++i) m.data()[i] = value(gen);
+    return m;
+}
+
+static bool same(const Eigen::MatrixXd& a, const Eigen::MatrixXd& b) {
+    return a.rows() == b.rows() && a.cols() == b.cols() && (a - b).cwiseAbs().maxCoeff() <= 1e-12;
+}
+
+int main(int argc, char* argv[]) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 50;
+    std::mt19937 gen(99);
+    int errors = 0;
+
+    for (int n = 0; n <= kMaxFixedFsL + 1; ++n) {
+        int combine_checked = 0, contract_checked = 0;
+        for (int round = 0; round < rounds; ++round) {
+            // 合并：com 为 n 个不同的源，A、B 各取其中一部分 (可重叠，顺序打乱)
+            std::vector<int> com(n);
+            for (int i = 0; i < n; ++i) com[i] = 10 * i + static_cast<int>(gen() % 10);
+            std::vector<int> fsA, fsB;
+            for (int e : com) {
+                const unsigned pick = gen() % 3;
+                if (pick != 1) fsA.push_back(e);
+                if (pick != 0) fsB.push_back(e);
+            }
+            std::shuffle(fsB.begin(), fsB.end(), gen);
+            // 合并后的列表与 removeDuplicateElements 相同：A 在前，B 中新出现的在后
+            std::vector<int> comFsL = fsA;
+            for (int e : fsB) {
+                if (std::find(comFsL.begin(), comFsL.end(), e) == comFsL.end()) comFsL.push_back(e);
+            }
+
+            const int ca = 1 + static_cast<int>(gen() % 2);
+            const int cb = 1 + static_cast<int>(gen() % 2);
+            Eigen::MatrixXd A = randomMatrix(Eigen::Index(1) << fsA.size(), ca, gen);
+            Eigen::MatrixXd B = randomMatrix(Eigen::Index(1) << fsB.size(), cb, gen);
+            Eigen::MatrixXd out;
+            const bool dispatched = fstra_kernels::combine(A, fsA, B, fsB, comFsL, out);
+            if (dispatched != (n <= kMaxFixedFsL)) ++errors;
+            if (dispatched) {
+                if (!same(out, combineReference(A, fsA, B, fsB, comFsL))) ++errors;
+                ++combine_checked;
+            }
+
+            // 约简：n 个源中随机约去一部分
+            std::vector<Eigen::Vector2d> vectors(n);
+            std::vector<const Eigen::Vector2d*> opv(n, nullptr);
+            for (int i = 0; i < n; ++i) {
+                const double p = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+                vectors[i] << 1.0 - p, p;
+                if (gen() & 1) opv[i] = &vectors[i];
+            }
+            Eigen::MatrixXd M = randomMatrix(Eigen::Index(1) << n, 1 + gen() % kMaxFixedCols, gen);
+            Eigen::MatrixXd reduced;
+            const bool contracted = fstra_kernels::contract(M, opv, reduced);
+            if (contracted != (n <= kMaxFixedFsL)) ++errors;
+            if (contracted) {
+                if (!same(reduced, contractReference(M, opv))) ++errors;
+                ++contract_checked;
+            }
+        }
+        std::cout << "n = " << n << ": " << combine_checked << " combine, " << contract_checked
+                  << " contract cases checked" << std::endl;
+    }
+
+    // 列数超出栈上矩阵容量时退回动态路径
+    Eigen::MatrixXd wide = randomMatrix(4, kMaxFixedCols + 1, gen), unused;
+    Eigen::Vector2d v(0.5, 0.5);
+    if (fstra_kernels::contract(wide, {&v, nullptr}, unused)) ++errors;
+    if (fstra_kernels::combine(wide, {1, 2}, randomMatrix(2, 2, gen), {3}, {1, 2, 3}, unused)) ++errors;
+
+    return reportResults(errors);
+}
@@ -0,0 +1,65 @@
+#include "fstra.h"
+#include "test_utils.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 稀疏化 optM 与稠密计算比较：同一电路、同一激励下，每个周期每个 PO 的稀疏可靠度
+// 与稠密可靠度之差不超过 getSparseErrorBound 报告的上界；阈值足够大时确实有概率项被丢弃。
+// 用法: fstraSparse [周期数] [阈值] [最大扇出源数]
+
+int main(int argc, char* argv[]) {
+    const int cycles = argc > 1 ? std::atoi(argv[1]) : 4;
+    const double threshold = argc > 2 ? std::atof(argv[2]) : 0.02;
+    const int mn_fs = argc > 3 ? std::atoi(argv[3]) : 16;
+
+    auto aig = makeRandomSequentialAIG(5, 3, 40, 4, 17, 12);
+    LevelizedAIG lv = LevelizedAIG::build(aig);
+
+    std::mt19937 gen(2024);
+    std::vector<std::vector<bool>> stimulus(cycles, std::vector<bool>(aig.num_pis()));
+    for (auto& inputs : stimulus) {
+        for (size_t i = 0; i < inputs.size(); ++i) inputs[i] = gen() & 1;
+    }
+    AigBitSimulator bit_sim(lv, 64);
+    bit_sim.setStimulus(stimulus);
+    auto golden = std::make_shared<GoldenTrace>();
+    bit_sim.run(cycles, *golden);
+
+    IverilogSimulator sim("fstra_sparse_sim");
+    VCDParser vcd;
+    FSTRAAnalyzer dense(aig, sim, vcd), sparse(aig, sim, vcd);
+    dense.setGoldenTrace(golden);
+    sparse.setGoldenTrace(golden);
+    sparse.setSparsification(true, threshold, 4);
+    dense.initializeFSNodes(cycles);
+    sparse.initializeFSNodes(cycles);
+    dense.FS_TRAMethodByCycle(cycles, mn_fs);
+    sparse.FS_TRAMethodByCycle(cycles, mn_fs);
+
+    int errors = 0;
+    double max_bound = 0.0;
+    for (int c = 1; c <= cycles; ++c) {
+        for (uint32_t p = 0; p < aig.num_pos(); ++p) {
+            const double r_dense = dense.getReliability(c, p);
+            const double r_sparse = sparse.getReliability(c, p);
+            const double bound = sparse.getSparseErrorBound(c, p);
+            max_bound = std::max(max_bound, bound);
+            const bool ok = std::abs(r_dense - r_sparse) <= bound + 1e-12;
+            std::cout << "Cycle " << c << ", PO " << p << ": dense " << r_dense << ", sparse " << r_sparse
+                      << ", bound " << bound << (ok ? "" : "  EXCEEDED") << std::endl;
+            if (!ok) ++errors;
+        }
+    }
+    // 不降维的约简路径也要读取稀疏化节点
+    sparse.runIterativeReductionParallel(cycles);
+
+    if (max_bound < 1e-9) {
+        std::cout << "no probability mass dropped, threshold " << threshold << " too small" << std::endl;
+        ++errors;
+    }
+    return reportResults(errors);
+}
@@ -0,0 +1,5 @@
+target_sources(${basename} PRIVATE
+    ${CMAKE_SOURCE_DIR}/work/mc_fault_simulator.cpp
+    ${CMAKE_SOURCE_DIR}/work/circuit_simulator.cpp
+    ${CMAKE_SOURCE_DIR}/work/fault_injector.cpp
+    ${CMAKE_SOURCE_DIR}/work/aig_bit_simulator.cpp)
@@ -0,0 +1,106 @@
+#include "mc_fault_simulator.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <set>
+
+// 结构优先级与直接按定义计算的参考比较：扇出源列表用集合递归求并、到输出的距离用
+// 记忆化 DFS 求最长路径、优先级按论文公式5-7 并按最大值归一化。
+// 网络修改并重新展开后缓存应随之更新。
+// 用法: mcPriorities [门数]
+
+static const double kDecay = 0.8;
+
+static int check(MCFaultSimulator& mc, const LevelizedAIG& lv) {
+    const uint32_t n = lv.num_nodes;
+    std::vector<int> fanout(n, 0), gate_of(n, -1);
+    std::vector<std::vector<uint32_t>> fanout_gates(n);
+    for (size_t g = 0; g < lv.gates.size(); ++g) {
+        gate_of[lv.gates[g]] = (int)g;
+        for (uint32_t lit : {lv.fanin0[g], lv.fanin1[g]}) {
+            fanout[lit >> 1]++;
+            fanout_gates[lit >> 1].push_back(lv.gates[g]);
+        }
+    }
+    std::vector<uint8_t> observed(n, 0);
+    for (uint32_t lit : lv.pos) { fanout[lit >> 1]++; observed[lit >> 1] = 1; }
+    for (uint32_t lit : lv.ris) { fanout[lit >> 1]++; observed[lit >> 1] = 1; }
+
+    std::vector<std::set<uint32_t>> fsl(n);
+    std::vector<double> pre(n, 0.0);
+    std::vector<int> dist(n, -2);
+    std::function<int(uint32_t)> distance = [&](uint32_t node) {
+        if (dist[node] != -2) return dist[node];
+        int d = observed[node] ? 0 : -1;
+        for (uint32_t g : fanout_gates[node]) {
+            const int dg = distance(g);
+            if (dg >= 0) d = std::max(d, dg + 1);
+        }
+        return dist[node] = d;
+    };
+    for (size_t g = 0; g < lv.gates.size(); ++g) {
+        const uint32_t node = lv.gates[g];
+        for (uint32_t lit : {lv.fanin0[g], lv.fanin1[g]}) {
+            const uint32_t f = lit >> 1;
+            if (f == 0) continue;
+            if (fanout[f] != 1) fsl[node].insert(f);
+            else fsl[node].insert(fsl[f].begin(), fsl[f].end());
+            pre[node] += kDecay * pre[f];
+        }
+        pre[node] += fsl[node].size();
+    }
+    double max1 = 0.0, max2 = 0.0;
+    for (uint32_t node : lv.gates) {
+        max1 = std::max(max1, pre[node] + std::max(0, distance(node)));
+        max2 = std::max(max2, (double)(lv.depth - lv.level[node]));
+    }
+
+    int errors = 0;
+    auto lengths = mc.get_fanout_source_lengths();
+    auto distances = mc.get_topological_distances();
+    auto priorities = mc.calculate_gate_priorities();
+    for (uint32_t node : lv.gates) {
+        const double expect = 0.75 * (pre[node] + std::max(0, distance(node))) / max1
+                            + 0.25 * (lv.depth - lv.level[node]) / max2;
+        errors += lengths[node] != (double)std::min<size_t>(fsl[node].size(), 32);
+        errors += distances[node] != distance(node);
+        errors += std::fabs(priorities[node] - expect) > 1e-9;
+    }
+    errors += priorities.size() != lv.gates.size();
+
+    // 低优先级节点恰为阈值以下的门
+    const double threshold = 0.3;
+    const std::vector<int> low = mc.get_low_priority_nodes(threshold);
+    size_t below = 0;
+    for (const auto& [node, p] : priorities) below += p < threshold;
+    errors += low.size() != below || !std::is_sorted(low.begin(), low.end());
+    for (int node : low) errors += !(priorities[node] < threshold);
+    std::cout << lv.gates.size() << " gates, " << low.size() << " below " << threshold
+              << ": " << errors << " mismatches" << std::endl;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    const int num_gates = argc > 1 ? std::atoi(argv[1]) : 500;
+
+    CircuitReliabilitySimulator sim;
+    auto& aig = sim.get_circuit();
+    std::mt19937 gen(17);
+    auto pool = buildRandomSequentialAIG(aig, 8, 6, num_gates, 4, gen, 40);
+    sim.levelize();
+
+    MCFaultSimulator mc(sim);
+    int errors = check(mc, sim.get_levelized());
+
+    // 加门后重新展开，缓存按新网络重算
+    addRandomGates(aig, pool, num_gates / 2, gen, 40);
+    aig.create_po(pool.back());
+    sim.levelize();
+    errors += check(mc, sim.get_levelized());
+
+    return reportResults(errors);
+}
@@ -0,0 +1,104 @@
+#include "mc_fault_simulator.h"
+#include "test_utils.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// 在一个 3 门的小时序电路上穷举所有 (周期, 门) 故障组合求出精确的 PO 失效概率，
+// 与重要性抽样、分层抽样和 (故障率较高时的) 普通蒙特卡洛比较。
+// 用法: mcRareEvent [故障率]
+
+static const int kCycles = 4;
+
+// 精确值：枚举 2^N 种故障组合，N = 门数 * 周期数
+static std::vector<double> exactFailure(const LevelizedAIG& lv, const std::vector<std::vector<bool>>& seq, double eps) {
+    const int gates = (int)lv.gates.size();
+    const int sites = gates * kCycles;
+    const size_t pos = lv.pos.size();
+    std::vector<double> exact(kCycles * pos, 0.0);
+    std::vector<int> golden(kCycles * pos, 0);
+
+    for (int pattern = 0; pattern < (1 << sites); ++pattern) {
+        const int k = __builtin_popcount(pattern);
+        const double prob = std::pow(eps, k) * std::pow(1 - eps, sites - k);
+        std::vector<int> v(lv.num_nodes, 0), state(lv.ros.size(), 0);
+        auto lit = [&](uint32_t l) { return v[l >> 1] ^ (int)(l & 1); };
+        for (int c = 0; c < kCycles; ++c) {
+            for (size_t i = 0; i < lv.pis.size(); ++i) v[lv.pis[i]] = seq[c][i];
+            for (size_t r = 0; r < lv.ros.size(); ++r) v[lv.ros[r]] = state[r];
+            for (int g = 0; g < gates; ++g) {
+                v[lv.gates[g]] = (lit(lv.fanin0[g]) & lit(lv.fanin1[g])) ^ ((pattern >> (c * gates + g)) & 1);
+            }
+            for (size_t p = 0; p < pos; ++p) {
+                if (pattern == 0) golden[c * pos + p] = lit(lv.pos[p]);
+                else if (lit(lv.pos[p]) != golden[c * pos + p]) exact[c * pos + p] += prob;
+            }
+            for (size_t r = 0; r < lv.ris.size(); ++r) state[r] = lit(lv.ris[r]);
+        }
+    }
+    return exact;
+}
+
+// 估计值与精确值相差不超过 5 个标准误
+static int compare(const char* name, const std::vector<std::vector<MCFaultSimulator::RareEventEstimate>>& est,
+                   const std::vector<double>& exact, size_t pos) {
+    int errors = 0;
+    double worst = 0.0;
+    for (int c = 0; c < kCycles; ++c) {
+        for (size_t p = 0; p < pos; ++p) {
+            const auto& e = est[c][p];
+            const double z = std::fabs(e.probability - exact[c * pos + p]) / std::max(e.std_error, 1e-300);
+            worst = std::max(worst, z);
+            if (z > 5.0 || e.relative_error() > 0.05) ++errors;
+        }
+    }
+    std::cout << "  " << name << ": " << est[0][0].trials << " trials, worst deviation "
+              << worst << " sigma" << (errors ? "  FAIL" : "") << std::endl;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    const double eps = argc > 1 ? std::atof(argv[1]) : 1e-6;
+
+    CircuitReliabilitySimulator sim;
+    auto& aig = sim.get_circuit();
+    auto a = aig.create_pi(), b = aig.create_pi();
+    auto r = aig.create_ro();
+    auto g1 = aig.create_and(a, b);
+    auto g2 = aig.create_and(!g1, r);
+    auto g3 = aig.create_and(g2, !a);
+    aig.create_po(g1);
+    aig.create_po(!g3);
+    aig.create_ri(!g2);
+    const std::vector<std::vector<bool>> seq = {{1, 1}, {0, 1}, {1, 0}, {0, 0}};
+
+    sim.initialize_sequential_simulation();
+    const LevelizedAIG& lv = sim.get_levelized();
+    const std::vector<double> exact = exactFailure(lv, seq, eps);
+    const size_t pos = lv.pos.size();
+
+    int errors = 0;
+    for (int lanes : {64, 256}) {
+        std::cout << "eps = " << eps << ", " << lanes << " lanes" << std::endl;
+        MCFaultSimulator mc(sim);
+        mc.set_lanes(lanes);
+        mc.set_seed(11);
+        errors += compare("importance", mc.run_importance_sampling(10000000, kCycles, seq, eps, 0.0, 0.02), exact, pos);
+        errors += compare("stratified", mc.run_stratified_sampling(10000000, kCycles, seq, eps, 0, 0.02), exact, pos);
+    }
+
+    // 故障率较高时普通蒙特卡洛也能给出同一精确值
+    MCFaultSimulator mc(sim);
+    mc.set_seed(5);
+    mc.run_mc_simulations(200000, kCycles, seq, 0.05);
+    const std::vector<double> exact_mc = exactFailure(lv, seq, 0.05);
+    for (const auto& cycle : mc.get_po_statistics()) {
+        for (const auto& s : cycle) {
+            const double e = exact_mc[s.cycle * pos + s.po_index];
+            const double se = std::sqrt(e * (1 - e) / s.trials);
+            if (std::fabs(s.failure_probability() - e) > 5 * se) ++errors;
+        }
+    }
+
+    return reportResults(errors);
+}
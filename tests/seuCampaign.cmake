@@ -0,0 +1,3 @@
+target_sources(${basename} PRIVATE
+    ${CMAKE_SOURCE_DIR}/work/seu_campaign.cpp
+    ${CMAKE_SOURCE_DIR}/work/aig_bit_simulator.cpp)
@@ -0,0 +1,126 @@
+#include "seu_campaign.h"
+#include "test_utils.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 比较位并行 SEU 仿真与逐场景的标量参考：对每个 (寄存器/与门, 周期) 翻转，
+// 从注入周期起逐周期求值到序列末尾，结果 (失效/屏蔽/潜伏) 与延迟应一致。
+// 参考不做提前停止，屏蔽场景还要检查收敛之后确实不再偏离。
+// 用法: seuCampaign [门数] [周期数]
+
+// 标量参考：一个周期的求值，flip_node 在该周期取反
+static void evaluate(const LevelizedAIG& lv, const std::vector<bool>& inputs, const std::vector<uint8_t>& state,
+                     int flip_node, std::vector<uint8_t>& v) {
+    v.assign(lv.num_nodes, 0);
+    for (size_t i = 0; i < lv.pis.size(); ++i) v[lv.pis[i]] = inputs[i];
+    for (size_t r = 0; r < lv.ros.size(); ++r) v[lv.ros[r]] = state[r];
+    for (size_t g = 0; g < lv.gates.size(); ++g) {
+        const uint32_t n = lv.gates[g];
+        v[n] = (v[lv.fanin0[g] >> 1] ^ (lv.fanin0[g] & 1)) & (v[lv.fanin1[g] >> 1] ^ (lv.fanin1[g] & 1));
+        if ((int)n == flip_node) v[n] ^= 1;
+    }
+}
+
+static std::vector<uint8_t> nextState(const LevelizedAIG& lv, const std::vector<uint8_t>& v) {
+    std::vector<uint8_t> s(lv.ris.size());
+    for (size_t r = 0; r < s.size(); ++r) s[r] = v[lv.ris[r] >> 1] ^ (lv.ris[r] & 1);
+    return s;
+}
+
+static bool sameOutputs(const LevelizedAIG& lv, const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    for (uint32_t lit : lv.pos) if (a[lit >> 1] != b[lit >> 1]) return false;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const int num_gates = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int num_cycles = argc > 2 ? std::atoi(argv[2]) : 24;
+
+    mockturtle::aig_network aig = makeRandomSequentialAIG(6, 12, num_gates, 3, 31, 60);
+    LevelizedAIG lv = LevelizedAIG::build(aig);
+
+    std::mt19937 gen(9);
+    std::vector<std::vector<bool>> inputs(num_cycles, std::vector<bool>(lv.pis.size()));
+    for (auto& c : inputs)
+        for (size_t i = 0; i < c.size(); ++i) c[i] = gen() & 1;
+    std::vector<bool> initial(lv.ros.size());
+    for (size_t r = 0; r < initial.size(); ++r) initial[r] = gen() & 1;
+
+    SEUCampaign campaign(lv);
+    if (!campaign.set_stimulus(inputs, initial)) return 1;
+    std::vector<int> cycles;
+    for (int c = 0; c < num_cycles; c += 3) cycles.push_back(c);
+    if (!campaign.run_all(cycles, true)) return 1;
+    campaign.print_summary();
+
+    // 无故障状态序列
+    std::vector<std::vector<uint8_t>> golden_state(num_cycles + 1);
+    std::vector<std::vector<uint8_t>> golden_values(num_cycles);
+    golden_state[0].assign(initial.begin(), initial.end());
+    for (int c = 0; c < num_cycles; ++c) {
+        evaluate(lv, inputs[c], golden_state[c], -1, golden_values[c]);
+        golden_state[c + 1] = nextState(lv, golden_values[c]);
+    }
+
+    int errors = 0;
+    std::vector<uint8_t> v;
+    for (const auto& r : campaign.get_results()) {
+        const int t = r.injection.cycle;
+        std::vector<uint8_t> state = golden_state[t];
+        int flip = (int)r.injection.node;
+        for (size_t i = 0; i < lv.ros.size(); ++i) {
+            if (lv.ros[i] == r.injection.node) {
+                state[i] ^= 1;
+                flip = -1;
+            }
+        }
+        SEUCampaign::Outcome outcome = SEUCampaign::Outcome::Latent;
+        int latency = -1;
+        bool diverged_after_convergence = false;
+        for (int c = t; c < num_cycles; ++c) {
+            evaluate(lv, inputs[c], state, c == t ? flip : -1, v);
+            state = nextState(lv, v);
+            const bool fail = !sameOutputs(lv, v, golden_values[c]);
+            if (outcome == SEUCampaign::Outcome::Latent) {
+                if (fail) {
+                    outcome = SEUCampaign::Outcome::Failure;
+                    latency = c - t;
+                } else if (state == golden_state[c + 1]) {
+                    outcome = SEUCampaign::Outcome::Masked;
+                    latency = c - t + 1;
+                }
+            } else if (outcome == SEUCampaign::Outcome::Masked) {
+                diverged_after_convergence |= fail || state != golden_state[c + 1];
+            }
+        }
+        if (outcome != r.outcome || latency != r.latency || diverged_after_convergence) ++errors;
+    }
+    std::cout << "outcomes: " << errors << " mismatches" << std::endl;
+
+    // 跟踪上限：超过上限的场景记为潜伏，其余不变
+    SEUCampaign limited(lv);
+    limited.set_stimulus(inputs, initial);
+    limited.set_horizon(2);
+    limited.run_all(cycles, true);
+    int horizon_errors = 0;
+    for (size_t i = 0; i < limited.get_results().size(); ++i) {
+        const auto& a = limited.get_results()[i];
+        const auto& b = campaign.get_results()[i];
+        const bool within = b.outcome != SEUCampaign::Outcome::Latent
+                            && b.latency < (b.outcome == SEUCampaign::Outcome::Failure ? 2 : 3);
+        if (within ? a.outcome != b.outcome || a.latency != b.latency
+                   : a.outcome != SEUCampaign::Outcome::Latent) ++horizon_errors;
+    }
+    std::cout << "horizon: " << horizon_errors << " mismatches" << std::endl;
+    errors += horizon_errors;
+
+    long long failures = 0;
+    for (const auto& t : campaign.get_target_stats()) failures += t.failures;
+    long long histogram = 0;
+    for (long long n : campaign.get_failure_latency_histogram()) histogram += n;
+    errors += failures != histogram;
+
+    return reportResults(errors);
+}
@@ -0,0 +1,105 @@
+#include "circuit_simulator.h"
+#include "test_utils.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 关键帧 + 翻转增量记录的重放检查：
+//   时序仿真记录的各周期节点值与独立的标量参考仿真逐值一致 (不同关键帧间隔)；
+//   不同翻转率的合成序列 (含全翻转、触发关键帧的大量翻转) 重放与原值一致；
+//   越界周期/节点、非正的间隔、长度不符的记录被拒绝。
+// 用法: simulationTrace [门数] [周期数]
+
+// 标量参考：寄存器初值为 0，每周期求值后寄存器取寄存器输入的值
+static std::vector<std::vector<uint8_t>> referenceSequence(const LevelizedAIG& lv,
+                                                           const std::vector<std::vector<bool>>& inputs) {
+    std::vector<std::vector<uint8_t>> values;
+    std::vector<uint8_t> state(lv.ros.size(), 0);
+    for (const auto& row : inputs) {
+        std::vector<uint8_t> v(lv.num_nodes, 0);
+        for (size_t i = 0; i < lv.pis.size(); ++i) v[lv.pis[i]] = row[i];
+        for (size_t r = 0; r < lv.ros.size(); ++r) v[lv.ros[r]] = state[r];
+        for (size_t g = 0; g < lv.gates.size(); ++g) {
+            v[lv.gates[g]] = (v[lv.fanin0[g] >> 1] ^ (lv.fanin0[g] & 1)) & (v[lv.fanin1[g] >> 1] ^ (lv.fanin1[g] & 1));
+        }
+        for (size_t r = 0; r < lv.ris.size(); ++r) state[r] = v[lv.ris[r] >> 1] ^ (lv.ris[r] & 1);
+        values.push_back(std::move(v));
+    }
+    return values;
+}
+
+static int compareTrace(const SimulationTrace& trace, const std::vector<std::vector<uint8_t>>& expected) {
+    int errors = 0;
+    if (trace.num_cycles() != (int)expected.size()) return 1;
+    std::vector<uint8_t> values;
+    for (int c = 0; c < trace.num_cycles(); ++c) {
+        if (!trace.values_at(c, values) || values != expected[c]) ++errors;
+        // 单点查询抽查
+        for (uint32_t n = c % 7; n < values.size(); n += 7) {
+            bool v;
+            if (!trace.value(n, c, v) || v != (expected[c][n] != 0)) ++errors;
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    const int num_gates = argc > 1 ? std::atoi(argv[1]) : 500;
+    const int num_cycles = argc > 2 ? std::atoi(argv[2]) : 200;
+    int errors = 0;
+
+    // 时序仿真记录与参考仿真对照
+    const int num_pis = 8;
+    std::mt19937 gen(41);
+    for (int interval : {1, 5, 64}) {
+        CircuitReliabilitySimulator sim;
+        std::mt19937 circuit_gen(9);
+        buildRandomSequentialAIG(sim.get_circuit(), num_pis, 10, num_gates, 6, circuit_gen, 50);
+        std::vector<std::vector<bool>> inputs(num_cycles, std::vector<bool>(num_pis));
+        for (auto& row : inputs)
+            for (int i = 0; i < num_pis; ++i) row[i] = gen() & 1;
+
+        if (!sim.set_trace_keyframe_interval(interval)) return 1;
+        sim.simulate_sequential_circuit(inputs, num_cycles);
+        const int e = compareTrace(sim.get_trace(), referenceSequence(sim.get_levelized(), inputs));
+        std::cout << "interval " << interval << ": " << e << " mismatches, "
+                  << sim.get_trace().memory_bytes() << " bytes" << std::endl;
+        errors += e;
+    }
+
+    // 合成序列：逐周期按给定翻转率翻转，覆盖只有增量、增量超过位图改存关键帧两种情况
+    const uint32_t num_nodes = 300;
+    for (double rate : {0.0, 0.01, 0.2, 1.0}) {
+        SimulationTrace trace;
+        if (!trace.reset(num_nodes, 16)) return 1;
+        std::bernoulli_distribution flip(rate);
+        std::vector<uint8_t> v(num_nodes, 0);
+        std::vector<std::vector<uint8_t>> expected;
+        for (int c = 0; c < 100; ++c) {
+            for (auto& x : v) if (flip(gen)) x ^= 1;
+            if (!trace.record(v)) ++errors;
+            expected.push_back(v);
+        }
+        const int e = compareTrace(trace, expected);
+        std::cout << "toggle rate " << rate << ": " << e << " mismatches" << std::endl;
+        errors += e;
+    }
+
+    // 非法输入
+    SimulationTrace trace;
+    std::vector<uint8_t> values;
+    bool v;
+    if (trace.reset(10, 0) || trace.reset(10, -3)) ++errors;
+    if (trace.values_at(0, values)) ++errors;                      // 尚无周期
+    if (!trace.reset(10, 4)) ++errors;
+    if (trace.record(std::vector<uint8_t>(9, 0))) ++errors;         // 长度不符
+    if (!trace.record(std::vector<uint8_t>(10, 1))) ++errors;
+    if (trace.values_at(-1, values) || trace.values_at(1, values)) ++errors;
+    if (trace.value(10, 0, v) || trace.value(0, 1, v)) ++errors;
+    if (!trace.value(9, 0, v) || !v) ++errors;
+    CircuitReliabilitySimulator sim;
+    if (sim.set_trace_keyframe_interval(-1)) ++errors;
+
+    return reportResults(errors);
+}
@@ -0,0 +1,81 @@
+#include "circuit_simulator.h"
+#include "test_utils.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 关键帧 + 翻转增量记录的吞吐量与内存：按给定翻转率生成节点值序列，测量逐周期记录、
+// 随机周期查询的速率，与每周期存一整份 uint8_t 节点值相比的内存，并抽查重放结果。
+// 用法: simulation_trace_bench [节点数] [周期数] [翻转率] [关键帧间隔]
+
+// 每周期翻转 flips 个随机节点；同一种子重新生成即可得到同一序列
+class ToggleSequence {
+public:
+    ToggleSequence(uint32_t num_nodes, double rate, unsigned seed)
+        : values_(num_nodes, 0), gen_(seed), pick_(0, num_nodes - 1),
+          flips_(static_cast<int>(rate * num_nodes + 0.5)) {}
+
+    const std::vector<uint8_t>& next() {
+        for (int i = 0; i < flips_; ++i) values_[pick_(gen_)] ^= 1;
+        return values_;
+    }
+
+private:
+    std::vector<uint8_t> values_;
+    std::mt19937 gen_;
+    std::uniform_int_distribution<uint32_t> pick_;
+    int flips_;
+};
+
+int main(int argc, char* argv[]) {
+    const uint32_t num_nodes = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int num_cycles = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    const double rate = argc > 3 ? std::atof(argv[3]) : 0.02;
+    const int interval = argc > 4 ? std::atoi(argv[4]) : 64;
+
+    SimulationTrace trace;
+    if (num_nodes == 0 || num_cycles <= 0 || !trace.reset(num_nodes, interval)) return 1;
+
+    ToggleSequence seq(num_nodes, rate, 2024);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int c = 0; c < num_cycles; ++c) {
+        if (!trace.record(seq.next())) return 1;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    const double t_record = std::chrono::duration<double>(t1 - t0).count();
+
+    // 随机周期的整帧重放
+    const int queries = std::min(num_cycles, 100000);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pick_cycle(0, num_cycles - 1);
+    std::vector<uint8_t> values;
+    uint64_t ones = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; ++q) {
+        if (!trace.values_at(pick_cycle(gen), values)) return 1;
+        ones += values[q % num_nodes];
+    }
+    t1 = std::chrono::steady_clock::now();
+    const double t_query = std::chrono::duration<double>(t1 - t0).count();
+
+    const double dense = static_cast<double>(num_nodes) * num_cycles;
+    std::cout << num_nodes << " nodes, " << num_cycles << " cycles, toggle rate " << rate
+              << ", keyframe interval " << interval << std::endl;
+    std::cout << "record : " << t_record << " s, " << num_cycles / t_record / 1e6 << " M cycles/s" << std::endl;
+    std::cout << "replay : " << t_query << " s, " << queries / t_query / 1e6 << " M frames/s (" << ones
+              << " ones sampled)" << std::endl;
+    std::cout << "memory : " << trace.memory_bytes() / (1024.0 * 1024.0) << " MB, "
+              << dense / trace.memory_bytes() << "x smaller than one byte per node per cycle" << std::endl;
+
+    // 重新生成同一序列，抽查重放结果
+    ToggleSequence replay(num_nodes, rate, 2024);
+    long long errors = 0;
+    for (int c = 0; c < num_cycles; ++c) {
+        const std::vector<uint8_t>& expected = replay.next();
+        if (c % 997 != 0) continue;
+        if (!trace.values_at(c, values) || values != expected) ++errors;
+    }
+    return reportResults(errors);
+}
@@ -0,0 +1,5 @@
+target_sources(${basename} PRIVATE
+    ${CMAKE_SOURCE_DIR}/work/fstra.cpp
+    ${CMAKE_SOURCE_DIR}/work/tensor_network.cpp
+    ${CMAKE_SOURCE_DIR}/work/iverilog_simulator.cpp
+    ${CMAKE_SOURCE_DIR}/work/aig_bit_simulator.cpp)
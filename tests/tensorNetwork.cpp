@@ -0,0 +1,71 @@
+#include "fstra.h"
+#include "test_utils.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 张量网络缩并与 FS-TRA 的对照：
+//   小电路上 FS-TRA 不做降维 (Mn_fs 足够大) 时是精确的，TensorNetworkMethodByCycle 在宽度
+//   不受限时也是精确的，两者每个周期每个 PO 的可靠度应一致；
+//   宽度超过上限又没有可切断的变量时 marginal 必须失败，而不是照常精确缩并。
+// 用法: tensorNetwork [周期数] [最大扇出源数]
+
+int main(int argc, char* argv[]) {
+    const int cycles = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int mn_fs = argc > 2 ? std::atoi(argv[2]) : 16;
+    int errors = 0;
+
+    auto aig = makeRandomSequentialAIG(4, 2, 24, 3, 5, 8);
+    LevelizedAIG lv = LevelizedAIG::build(aig);
+
+    std::mt19937 gen(77);
+    std::vector<std::vector<bool>> stimulus(cycles, std::vector<bool>(aig.num_pis()));
+    for (auto& inputs : stimulus) {
+        for (size_t i = 0; i < inputs.size(); ++i) inputs[i] = gen() & 1;
+    }
+    AigBitSimulator bit_sim(lv, 64);
+    bit_sim.setStimulus(stimulus);
+    auto golden = std::make_shared<GoldenTrace>();
+    bit_sim.run(cycles, *golden);
+
+    IverilogSimulator sim("tensor_network_sim");
+    VCDParser vcd;
+    FSTRAAnalyzer analyzer(aig, sim, vcd);
+    analyzer.setGoldenTrace(golden);
+    analyzer.initializeFSNodes(cycles);
+    analyzer.FS_TRAMethodByCycle(cycles, mn_fs);
+    if (!analyzer.TensorNetworkMethodByCycle(cycles, 0)) {
+        std::cout << "tensor network contraction failed" << std::endl;
+        ++errors;
+    }
+
+    for (int c = 1; c <= cycles; ++c) {
+        for (uint32_t p = 0; p < aig.num_pos(); ++p) {
+            const double r_fstra = analyzer.getReliability(c, p);
+            const double r_tn = analyzer.getTensorNetworkReliability(c, p);
+            const bool ok = std::abs(r_fstra - r_tn) <= 1e-9;
+            std::cout << "Cycle " << c << ", PO " << p << ": FS-TRA " << r_fstra << ", TN " << r_tn
+                      << (ok ? "" : "  MISMATCH") << std::endl;
+            if (!ok) ++errors;
+        }
+    }
+
+    // 链 x0 -> x1 -> ... -> x5 再汇聚到 y：没有先验可切断，宽度限制为 2 时缩并必须失败
+    TensorNetwork tn;
+    tn.addFactor({0}, {0.5, 0.5}, 0);
+    for (int v = 1; v <= 5; ++v) tn.addFactor({v - 1, v}, {0.9, 0.1, 0.1, 0.9}, v);
+    tn.addFactor({0, 3, 5, 6}, std::vector<double>(16, 0.5), 6);
+    Eigen::Vector2d m;
+    tn.setMaxWidth(0);
+    if (!tn.marginal(6, m) || std::abs(m.sum() - 1.0) > 1e-12) ++errors;
+    tn.setMaxWidth(2);
+    if (tn.marginal(6, m)) {
+        std::cout << "width limit exceeded without a prior, but marginal succeeded" << std::endl;
+        ++errors;
+    }
+
+    return reportResults(errors);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mockturtle/mockturtle.hpp>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// ==================== 测试公用工具 ====================
+//
+// 随机电路、合成 VCD 的生成与结论输出，各测试程序共用。
+
+// 向 pool 追加 num_gates 个与门：扇入取自 pool 最近的 window 个信号 (0 表示不限)，各自随机取反。
+// window 越小锥越深
+inline void addRandomGates(mockturtle::aig_network& aig, std::vector<mockturtle::aig_network::signal>& pool,
+                           int num_gates, std::mt19937& gen, size_t window = 0) {
+    for (int g = 0; g < num_gates; ++g) {
+        const size_t first = (window > 0 && pool.size() > window) ? pool.size() - window : 0;
+        std::uniform_int_distribution<size_t> pick(first, pool.size() - 1);
+        auto a = pool[pick(gen)], b = pool[pick(gen)];
+        if (gen() & 1) a = aig.create_not(a);
+        if (gen() & 1) b = aig.create_not(b);
+        pool.push_back(aig.create_and(a, b));
+    }
+}
+
+// 在 aig 中生成随机时序电路：PI、寄存器输出、num_gates 个随机门；PO 取最后生成的门 (每隔 3 个取一个，
+// 奇数号取反)，寄存器输入分散取自门序列。返回的 pool 依次为 PI、寄存器输出、各门，可继续追加门
+inline std::vector<mockturtle::aig_network::signal> buildRandomSequentialAIG(
+    mockturtle::aig_network& aig, int num_pis, int num_regs, int num_gates, int num_pos,
+    std::mt19937& gen, size_t window = 0) {
+    std::vector<mockturtle::aig_network::signal> pool;
+    for (int i = 0; i < num_pis; ++i) pool.push_back(aig.create_pi());
+    for (int i = 0; i < num_regs; ++i) pool.push_back(aig.create_ro());
+    addRandomGates(aig, pool, num_gates, gen, window);
+
+    for (int i = 0; i < num_pos; ++i) {
+        auto s = pool[pool.size() - 1 - (size_t)(i * 3) % num_gates];
+        aig.create_po((i & 1) ? aig.create_not(s) : s);
+    }
+    for (int i = 0; i < num_regs; ++i) {
+        aig.create_ri(pool[num_pis + num_regs + (i * 13) % num_gates]);
+    }
+    return pool;
+}
+
+inline mockturtle::aig_network makeRandomSequentialAIG(int num_pis, int num_regs, int num_gates, int num_pos,
+                                                       unsigned seed = 7, size_t window = 0) {
+    mockturtle::aig_network aig;
+    std::mt19937 gen(seed);
+    buildRandomSequentialAIG(aig, num_pis, num_regs, num_gates, num_pos, gen, window);
+    return aig;
+}
+
+// VCD 标识符：可打印字符 '!'..'~' 组成的 94 进制数
+inline std::string makeVCDIdentifier(int n) {
+    std::string id;
+    do {
+        id += static_cast<char>(33 + n % 94);
+        n /= 94;
+    } while (n > 0);
+    return id;
+}
+
+// 与 iverilog 输出格式相同的合成 VCD：信号 0 为时钟 (周期 1000，上升沿在 c*1000)，
+// 其余为 signal_i，每 10 个中有一个命名为 po i；每周期上升沿后 100 时刻各信号以 0.3 的概率翻转
+inline void writeSyntheticVCD(const std::string& path, int num_signals, int num_cycles, unsigned seed = 12345) {
+    std::ofstream out(path);
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution toggle(0.3);
+
+    out << "$date\n\tsynthetic\n$end\n$version\n\tvcd_parse_bench\n$end\n$timescale\n\t1ps\n$end\n";
+    out << "$scope module tb_top $end\n$scope module uut $end\n";
+    out << "$var wire 1 " << makeVCDIdentifier(0) << " clock $end\n";
+    for (int i = 1; i < num_signals; ++i) {
+        const char* prefix = (i % 10 == 0) ? "po" : "signal_";
+        out << "$var wire 1 " << makeVCDIdentifier(i) << " " << prefix << i << " $end\n";
+    }
+    out << "$upscope $end\n$upscope $end\n$enddefinitions $end\n";
+
+    std::vector<char> value(num_signals, '0');
+    out << "#0\n$dumpvars\n";
+    for (int i = 0; i < num_signals; ++i) out << value[i] << makeVCDIdentifier(i) << "\n";
+    out << "$end\n";
+
+    for (int c = 1; c <= num_cycles; ++c) {
+        out << "#" << c * 1000 << "\n1" << makeVCDIdentifier(0) << "\n";
+        out << "#" << c * 1000 + 100 << "\n";
+        for (int i = 1; i < num_signals; ++i) {
+            if (toggle(gen)) {
+                value[i] = value[i] == '0' ? '1' : '0';
+                out << value[i] << makeVCDIdentifier(i) << "\n";
+            }
+        }
+        out << "#" << c * 1000 + 500 << "\n0" << makeVCDIdentifier(0) << "\n";
+    }
+    out << "#" << (num_cycles + 1) * 1000 << "\n1" << makeVCDIdentifier(0) << "\n";
+}
+
+// 输出结论并给出退出码：没有差异时为 0
+inline int reportResults(long long errors) {
+    std::cout << (errors == 0 ? "results match" : "RESULTS DIFFER") << std::endl;
+    return errors == 0 ? 0 : 1;
+}
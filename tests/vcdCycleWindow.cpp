@@ -0,0 +1,88 @@
+#include "vcd_parser.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 按 .fwi 定位索引加载周期窗口：
+//   窗口内各信号的逐周期采样与完整解析中相同周期的采样一致 (含文件首尾的窗口)；
+//   有索引时只加载窗口附近的周期；VCD 改写后旧索引被识别为过期并重建，结果与新内容一致。
+// 用法: vcdCycleWindow [VCD文件] [周期数]
+
+static const size_t kInterval = 64;   // 检查点间隔 (时间戳行数)，取小以产生较多检查点
+
+// 窗口 [first, last] 内全部信号的采样与完整解析比较，返回不一致的个数
+static int compareWindow(VCDParser& full, VCDParser& window, int first, int last) {
+    int errors = 0;
+    for (const auto& name : full.getAllSignalBaseNames()) {
+        std::vector<VCDValue> expected, actual;
+        if (!full.getSignalSamples(name, expected) || !window.getSignalSamples(name, actual) ||
+            (int)expected.size() <= last || (int)actual.size() <= last) {
+            ++errors;
+            continue;
+        }
+        for (int c = first; c <= last; ++c) {
+            if (expected[c] != actual[c]) ++errors;
+        }
+    }
+    return errors;
+}
+
+// 有采样点的周期数
+static int loadedCycles(VCDParser& parser) {
+    std::vector<VCDValue> clock;
+    if (!parser.getSignalSamples("clock", clock)) return -1;
+    int n = 0;
+    for (VCDValue v : clock) n += v != VCDValue::VCD_X;
+    return n;
+}
+
+static bool fileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+int main(int argc, char* argv[]) {
+    const std::string path = argc > 1 ? argv[1] : "vcd_window_test.vcd";
+    const int num_cycles = argc > 2 ? std::atoi(argv[2]) : 3000;
+    const std::string index = path + ".fwi";
+    std::remove(index.c_str());
+    int errors = 0;
+
+    // 加载一个窗口并与完整解析比较；expect_full 表示这次应当退回完整解析 (建立索引)
+    auto check = [&](int first, int last, bool expect_full) {
+        VCDParser full, window;
+        if (!full.parseFile(path) || !full.setClockSignal("clock") ||
+            !window.parseCycleWindow(path, "clock", first, last, kInterval)) {
+            std::cout << "[" << first << ", " << last << "]: load failed" << std::endl;
+            ++errors;
+            return;
+        }
+        const int loaded = loadedCycles(window);
+        const bool was_full = loaded == loadedCycles(full);
+        const int e = compareWindow(full, window, first, last);
+        std::cout << "[" << first << ", " << last << "]: " << loaded << " cycles loaded"
+                  << (was_full ? " (index built)" : "") << ", " << e << " mismatches" << std::endl;
+        if (was_full != expect_full || !fileExists(index)) ++errors;
+        errors += e;
+    };
+
+    writeSyntheticVCD(path, 40, num_cycles, 3);
+    check(1000, 1100, true);                               // 没有索引：完整解析并建立索引
+    check(1000, 1100, false);
+    check(1, 50, false);                                   // 第一个检查点之前
+    check(num_cycles - 30, num_cycles, false);             // 最后一个检查点之后
+    check(num_cycles / 2, num_cycles / 2, false);          // 单个周期
+
+    // 同名文件改写后索引过期：重建一次，之后再次按窗口加载
+    writeSyntheticVCD(path, 40, num_cycles + 200, 4);
+    check(2000, 2100, true);
+    check(2000, 2100, false);
+    check(num_cycles + 100, num_cycles + 200, false);
+
+    std::remove(index.c_str());
+    std::remove(path.c_str());
+    return reportResults(errors);
+}
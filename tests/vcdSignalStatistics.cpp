@@ -0,0 +1,83 @@
+#include "vcd_parser.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// computeSignalStatistics 单遍统计与完整解析后逐周期采样的穷举计数比较：
+// 逐周期采样值、每个窗口的平均 P(1) (最后一个窗口不满)、全程平均 P(1)、signal_N 的列映射，
+// 以及数据信号在窗口内的翻转次数 (合成波形每周期至多翻转一次，由相邻周期采样之差得到)。
+// 用法: vcdSignalStatistics [VCD文件] [周期数] [窗口周期数]
+
+static double probabilityOne(VCDValue v) {
+    return v == VCDValue::VCD_1 ? 1.0 : (v == VCDValue::VCD_0 ? 0.0 : 0.5);
+}
+
+int main(int argc, char* argv[]) {
+    const std::string path = argc > 1 ? argv[1] : "vcd_stats_test.vcd";
+    const int num_cycles = argc > 2 ? std::atoi(argv[2]) : 1000;
+    const int window = argc > 3 ? std::atoi(argv[3]) : 7;
+    writeSyntheticVCD(path, 60, num_cycles, 5);
+
+    VCDSignalStatistics stats;
+    VCDParser full;
+    if (!VCDParser().computeSignalStatistics(path, "clock", window, stats) ||
+        !full.parseFile(path) || !full.setClockSignal("clock")) {
+        std::remove(path.c_str());
+        return 1;
+    }
+    std::remove(path.c_str());
+
+    int errors = 0;
+    const int expected_windows = (num_cycles + window - 1) / window;
+    if (stats.num_cycles != num_cycles || stats.num_windows != expected_windows) {
+        std::cout << "cycles " << stats.num_cycles << ", windows " << stats.num_windows << std::endl;
+        ++errors;
+    }
+
+    const int columns = stats.numSignals();
+    for (int col = 0; col < columns; ++col) {
+        const std::string& name = stats.names[col];
+        const std::string base = name.substr(name.rfind('.') + 1);
+        std::vector<VCDValue> samples;
+        if (!full.getSignalSamples(base, samples) || (int)samples.size() <= stats.num_cycles) {
+            ++errors;
+            continue;
+        }
+
+        double total = 0.0;
+        for (int w = 0; w < stats.num_windows; ++w) {
+            const int first = w * window + 1;
+            const int last = std::min(first + window - 1, stats.num_cycles);
+            double sum = 0.0;
+            long long toggles = 0;
+            for (int c = first; c <= last; ++c) {
+                const double p1 = probabilityOne(samples[c]);
+                sum += p1;
+                double stored;
+                if (!stats.probability(col, c, false, stored) || stored != p1) ++errors;
+                if (c < stats.num_cycles && samples[c] != samples[c + 1]) ++toggles;
+            }
+            total += sum;
+            const size_t k = (size_t)w * columns + col;
+            if (std::abs(stats.window_p1[k] - sum / (last - first + 1)) > 1e-6) ++errors;
+            double averaged;
+            if (!stats.probability(col, first, true, averaged) || averaged != stats.window_p1[k]) ++errors;
+            // 最后一个周期的翻转发生在最后一个上升沿之后，采样看不到，只比较之前的窗口；
+            // 时钟每周期翻转两次而采样恒为 1，不参与比较
+            if (base != "clock" && last < stats.num_cycles && stats.window_toggles[k] != toggles) ++errors;
+        }
+        if (std::abs(stats.total_p1[col] - total / stats.num_cycles) > 1e-9) ++errors;
+
+        // signal_N 列映射
+        if (base.compare(0, 7, "signal_") == 0 && stats.columnOfNode(std::atoi(base.c_str() + 7)) != col) ++errors;
+    }
+
+    std::cout << columns << " signals, " << stats.num_cycles << " cycles, " << stats.num_windows
+              << " windows of " << window << ": " << errors << " mismatches" << std::endl;
+    return reportResults(errors);
+}
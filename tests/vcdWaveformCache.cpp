@@ -0,0 +1,106 @@
+#include "vcd_parser.h"
+#include "test_utils.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 二进制波形缓存 (.fwc) 的往返与失效：
+//   首次解析写出缓存，再次解析直接装载，两者的逐周期采样与不用缓存的解析一致；
+//   VCD 改写 (含长度不变的单个值修改) 或信号过滤改变后不使用旧缓存，结果与新内容一致。
+// 用法: vcdWaveformCache [VCD文件]
+
+using Samples = std::map<std::string, std::vector<VCDValue>>;
+
+// 全部信号按基础名的逐周期采样
+static bool parseSamples(const std::string& path, bool use_cache, Samples& samples, bool& from_cache,
+                         const std::vector<std::string>& filter = {}) {
+    VCDParser parser;
+    parser.setWaveformCache(use_cache);
+    if (!filter.empty()) parser.setSignalFilter(filter);
+    if (!parser.parseFile(path) || !parser.setClockSignal("clock")) return false;
+    from_cache = parser.loadedFromCache();
+
+    samples.clear();
+    for (const auto& name : parser.getAllSignalBaseNames()) {
+        if (!parser.getSignalSamples(name, samples[name])) return false;
+    }
+    return !samples.empty();
+}
+
+static bool fileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+// 原地把第一个数据信号在 #1100 处的值取反，文件长度不变
+static bool flipOneValue(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+    size_t pos = text.find("\n#1100\n");
+    if (pos == std::string::npos) return false;
+    pos += 7;
+    if (text[pos] != '0' && text[pos] != '1') return false;
+    text[pos] = text[pos] == '0' ? '1' : '0';
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+    return out.good();
+}
+
+int main(int argc, char* argv[]) {
+    const std::string path = argc > 1 ? argv[1] : "vcd_cache_test.vcd";
+    const std::string cache = path + ".fwc";
+    std::remove(cache.c_str());
+    int errors = 0;
+
+    auto check = [&](const char* step, bool use_cache, bool expect_cache,
+                     const std::vector<std::string>& filter = {}) {
+        Samples reference, cached;
+        bool from_cache = false, unused = false;
+        if (!parseSamples(path, false, reference, unused, filter) ||
+            !parseSamples(path, use_cache, cached, from_cache, filter)) {
+            std::cout << step << ": parse failed" << std::endl;
+            ++errors;
+            return;
+        }
+        const bool ok = from_cache == expect_cache && cached == reference;
+        std::cout << step << ": " << (from_cache ? "loaded from cache" : "parsed") << ", "
+                  << reference.size() << " signals, " << (ok ? "ok" : "MISMATCH") << std::endl;
+        if (!ok) ++errors;
+    };
+
+    writeSyntheticVCD(path, 80, 400, 1);
+    check("first parse", true, false);
+    if (!fileExists(cache)) {
+        std::cout << "cache file not written: " << cache << std::endl;
+        ++errors;
+    }
+    check("reload", true, true);
+
+    // 内容整体改变
+    writeSyntheticVCD(path, 80, 450, 2);
+    check("rewritten VCD", true, false);
+    check("reload after rewrite", true, true);
+
+    // 长度不变的单个值修改：采样确实改变，旧缓存若被误用即可发现
+    Samples before, after;
+    bool unused = false;
+    if (!parseSamples(path, false, before, unused) || !flipOneValue(path) ||
+        !parseSamples(path, false, after, unused) || before == after) {
+        std::cout << "failed to modify " << path << std::endl;
+        ++errors;
+    }
+    check("one value flipped", true, false);
+    check("reload after flip", true, true);
+
+    // 过滤设置是缓存键的一部分
+    check("different filter", true, false, {"clock", "po*"});
+
+    std::remove(cache.c_str());
+    std::remove(path.c_str());
+    return reportResults(errors);
+}
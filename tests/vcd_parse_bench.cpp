@@ -0,0 +1,93 @@
+#include "vcd_parser.h"
+#include "test_utils.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// 生成与 iverilog 输出格式相同的合成 VCD，比较逐行解析、内存映射解析与分段并行解析的吞吐量，
+// 并检查各模式得到的周期采样结果一致。
+// 用法: vcd_parse_bench [信号数] [时钟周期数] [输出文件]
+
+static double parseSeconds(VCDParser& parser, const std::string& path) {
+    // 只计解析阶段，波形在首次查询时重建
+    parser.setDeferWaveform(true);
+    auto t0 = std::chrono::steady_clock::now();
+    if (!parser.parseFile(path)) return -1.0;
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+// 纯分词吞吐量 (不存储值变化)，反映扫描本身的上限；标识符解码值累加进 checksum 并输出，避免被优化掉
+static double tokenizeSeconds(const std::string& path, size_t& tokens, uint64_t& checksum) {
+    auto t0 = std::chrono::steady_clock::now();
+    vcd_tokenizer::MappedFile mf;
+    if (!mf.open(path)) return -1.0;
+    vcd_tokenizer::Tokenizer tz(mf.data(), mf.end());
+    vcd_tokenizer::Token tok;
+    checksum = 0;
+    tokens = 0;
+    while (tz.next(tok)) {
+        if (tok.ptr[0] != '#' && tok.ptr[0] != '$' && tok.len > 1) {
+            checksum += vcd_tokenizer::decodeIdentifier(tok.ptr + 1, tok.len - 1);
+        }
+        ++tokens;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char* argv[]) {
+    int num_signals = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int num_cycles = argc > 2 ? std::atoi(argv[2]) : 20000;
+    std::string path = argc > 3 ? argv[3] : "vcd_parse_bench.vcd";
+
+    writeSyntheticVCD(path, num_signals, num_cycles);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    double mb = static_cast<double>(in.tellg()) / (1024.0 * 1024.0);
+    std::cout << "VCD: " << path << " (" << mb << " MB, " << num_signals << " signals, "
+              << num_cycles << " cycles)" << std::endl;
+
+    VCDParser line_parser;
+    line_parser.setMappedIO(false);
+    double t_line = parseSeconds(line_parser, path);
+
+    VCDParser mapped_parser;
+    mapped_parser.setMappedIO(true);
+    double t_mapped = parseSeconds(mapped_parser, path);
+
+    VCDParser parallel_parser;
+    parallel_parser.setMappedIO(true);
+    parallel_parser.setParseThreads(0);
+    double t_parallel = parseSeconds(parallel_parser, path);
+
+    size_t tokens = 0;
+    uint64_t checksum = 0;
+    double t_tok = tokenizeSeconds(path, tokens, checksum);
+
+    if (t_line < 0 || t_mapped < 0 || t_parallel < 0 || t_tok < 0) {
+        std::cerr << "parse failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "getline parser: " << t_line << " s, " << mb / t_line << " MB/s" << std::endl;
+    std::cout << "mapped parser : " << t_mapped << " s, " << mb / t_mapped << " MB/s" << std::endl;
+    std::cout << "parallel parser: " << t_parallel << " s, " << mb / t_parallel << " MB/s" << std::endl;
+    std::cout << "tokenizer only: " << t_tok << " s, " << mb / t_tok << " MB/s (" << tokens << " tokens, checksum "
+              << checksum << ")" << std::endl;
+
+    // 结果一致性
+    line_parser.setClockSignal("clock");
+    mapped_parser.setClockSignal("clock");
+    parallel_parser.setClockSignal("clock");
+    int mismatches = 0;
+    for (int c = 1; c <= std::min(num_cycles, 20); ++c) {
+        std::unordered_map<std::string, std::pair<std::vector<double>, std::vector<double>>> a, b, p;
+        line_parser.getAllNodeOutputsFromWaveform(c, a);
+        mapped_parser.getAllNodeOutputsFromWaveform(c, b);
+        parallel_parser.getAllNodeOutputsFromWaveform(c, p);
+        if (a != b || a != p) ++mismatches;
+    }
+    return reportResults(mismatches);
+}
@@ -0,0 +1,284 @@
+#include "aig_bit_simulator.h"
+#include "vcd_parser.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+// ==================== LevelizedAIG ====================
+
+LevelizedAIG LevelizedAIG::build(const mockturtle::aig_network& circuit) {
+    LevelizedAIG aig;
+    aig.num_nodes = circuit.size();
+    aig.level.assign(aig.num_nodes, 0);
+
+    circuit.foreach_pi([&](auto node) {
+        aig.pis.push_back(circuit.node_to_index(node));
+    });
+    circuit.foreach_ro([&](auto node) {
+        aig.ros.push_back(circuit.node_to_index(node));
+    });
+    circuit.foreach_ri([&](auto signal) {
+        aig.ris.push_back(literal(circuit.node_to_index(circuit.get_node(signal)), circuit.is_complemented(signal)));
+    });
+    circuit.foreach_po([&](auto signal) {
+        aig.pos.push_back(literal(circuit.node_to_index(circuit.get_node(signal)), circuit.is_complemented(signal)));
+    });
+
+    // 节点号即拓扑序，一遍求出层级
+    std::vector<uint32_t> order;
+    std::vector<std::pair<uint32_t, uint32_t>> fanins(aig.num_nodes, {0, 0});
+    circuit.foreach_gate([&](auto node) {
+        const uint32_t index = circuit.node_to_index(node);
+        uint32_t lits[2] = {0, 0};
+        uint32_t lv = 0;
+        circuit.foreach_fanin(node, [&](auto signal, auto i) {
+            const uint32_t fi = circuit.node_to_index(circuit.get_node(signal));
+            lits[i] = literal(fi, circuit.is_complemented(signal));
+            lv = std::max(lv, aig.level[fi]);
+        });
+        aig.level[index] = lv + 1;
+        fanins[index] = {lits[0], lits[1]};
+        order.push_back(index);
+        aig.depth = std::max(aig.depth, lv + 1);
+    });
+
+    // 按层级计数排序，同层保持原有顺序
+    aig.level_begin.assign(aig.depth + 2, 0);
+    for (uint32_t index : order) aig.level_begin[aig.level[index] + 1]++;
+    for (uint32_t l = 1; l < aig.level_begin.size(); ++l) aig.level_begin[l] += aig.level_begin[l - 1];
+
+    aig.gates.resize(order.size());
+    aig.fanin0.resize(order.size());
+    aig.fanin1.resize(order.size());
+    std::vector<uint32_t> next(aig.level_begin.begin(), aig.level_begin.end() - 1);
+    for (uint32_t index : order) {
+        const uint32_t pos = next[aig.level[index]]++;
+        aig.gates[pos] = index;
+        aig.fanin0[pos] = fanins[index].first;
+        aig.fanin1[pos] = fanins[index].second;
+    }
+    return aig;
+}
+
+// ==================== GoldenTrace ====================
+
+GoldenTrace::GoldenTrace() : num_cycles_(0), num_nodes_(0), words_(1) {
+}
+
+int GoldenTrace::countOnes(int node, int cycle) const {
+    const uint64_t* w = nodeWords(node, cycle);
+    int ones = 0;
+    for (int i = 0; i < words_; ++i) ones += __builtin_popcountll(w[i]);
+    return ones;
+}
+
+bool GoldenTrace::getNodeOutputByIndex(int node, int cycle, double& prob_0, double& prob_1) const {
+    if (!hasCycle(cycle) || node < 0 || node >= num_nodes_) return false;
+    prob_1 = static_cast<double>(countOnes(node, cycle)) / numLanes();
+    prob_0 = 1.0 - prob_1;
+    return true;
+}
+
+bool GoldenTrace::getPOOutput(int po, int cycle, std::vector<double>& prob_0, std::vector<double>& prob_1) const {
+    if (!hasCycle(cycle) || po < 0 || po >= numPOs()) return false;
+    const uint32_t lit = po_literals_[po];
+    int ones = countOnes(LevelizedAIG::literalNode(lit), cycle);
+    if (LevelizedAIG::literalComplemented(lit)) ones = numLanes() - ones;
+    const double p1 = static_cast<double>(ones) / numLanes();
+    prob_0.assign(1, 1.0 - p1);
+    prob_1.assign(1, p1);
+    return true;
+}
+
+bool GoldenTrace::getPOValue(int po, int cycle, int lane) const {
+    const uint32_t lit = po_literals_[po];
+    return value(LevelizedAIG::literalNode(lit), cycle, lane) != LevelizedAIG::literalComplemented(lit);
+}
+
+// ==================== AigBitSimulator ====================
+
+AigBitSimulator::AigBitSimulator(const LevelizedAIG& aig, int lanes)
+    : aig_(aig), words_(std::max(1, (lanes + 63) / 64)), clock_pi_(-1),
+      mode_(StimulusMode::Random), seed_(12345) {
+}
+
+void AigBitSimulator::setRandomStimulus(uint64_t seed) {
+    mode_ = StimulusMode::Random;
+    seed_ = seed;
+    sequence_.clear();
+}
+
+void AigBitSimulator::setStimulus(const std::vector<std::vector<bool>>& input_sequence) {
+    mode_ = StimulusMode::Explicit;
+    sequence_ = input_sequence;
+}
+
+bool AigBitSimulator::loadStimulusFromWaveform(VCDParser& vcd, int num_cycles) {
+    std::vector<std::vector<bool>> sequence(num_cycles, std::vector<bool>(aig_.pis.size(), false));
+
+    int input = 0;
+    std::vector<VCDValue> samples;
+    for (size_t i = 0; i < aig_.pis.size(); ++i) {
+        if ((int)i == clock_pi_) {
+            for (int c = 0; c < num_cycles; ++c) sequence[c][i] = true;
+            continue;
+        }
+        const std::string name = "input_" + std::to_string(input++);
+        if (!vcd.getSignalSamples(name, samples)) {
+            std::cerr << "AigBitSimulator: signal " << name << " not found in waveform" << std::endl;
+            return false;
+        }
+        if ((int)samples.size() <= num_cycles) {
+            std::cerr << "AigBitSimulator: waveform has only " << (int)samples.size() - 1
+                      << " cycles, " << num_cycles << " requested" << std::endl;
+            return false;
+        }
+        for (int c = 1; c <= num_cycles; ++c) sequence[c - 1][i] = samples[c] == VCDValue::VCD_1;
+    }
+
+    // 寄存器初值取第 1 周期的 rout_k；波形中没有时保持全 0
+    std::vector<bool> state(aig_.ros.size(), false);
+    for (size_t r = 0; r < aig_.ros.size(); ++r) {
+        if (vcd.getSignalSamples("rout_" + std::to_string(r), samples) && samples.size() > 1) {
+            state[r] = samples[1] == VCDValue::VCD_1;
+        }
+    }
+
+    setStimulus(sequence);
+    setInitialState(state);
+    return true;
+}
+
+template <int W>
+void AigBitSimulator::evaluateGates(uint64_t* values) const {
+    // W 为编译期常量，内层循环可展开；W = 4 时编译器在 -mavx2 下生成 256 位向量指令
+    const size_t n = aig_.gates.size();
+    const uint32_t* gates = aig_.gates.data();
+    const uint32_t* f0 = aig_.fanin0.data();
+    const uint32_t* f1 = aig_.fanin1.data();
+    for (size_t g = 0; g < n; ++g) {
+        const uint64_t m0 = 0 - static_cast<uint64_t>(f0[g] & 1);
+        const uint64_t m1 = 0 - static_cast<uint64_t>(f1[g] & 1);
+        const uint64_t* a = values + static_cast<size_t>(f0[g] >> 1) * W;
+        const uint64_t* b = values + static_cast<size_t>(f1[g] >> 1) * W;
+        uint64_t* out = values + static_cast<size_t>(gates[g]) * W;
+        for (int w = 0; w < W; ++w) {
+            out[w] = (a[w] ^ m0) & (b[w] ^ m1);
+        }
+    }
+}
+
+void AigBitSimulator::evaluateGatesGeneric(uint64_t* values) const {
+    const size_t n = aig_.gates.size();
+    const int W = words_;
+    for (size_t g = 0; g < n; ++g) {
+        const uint32_t l0 = aig_.fanin0[g];
+        const uint32_t l1 = aig_.fanin1[g];
+        const uint64_t m0 = 0 - static_cast<uint64_t>(l0 & 1);
+        const uint64_t m1 = 0 - static_cast<uint64_t>(l1 & 1);
+        const uint64_t* a = values + static_cast<size_t>(l0 >> 1) * W;
+        const uint64_t* b = values + static_cast<size_t>(l1 >> 1) * W;
+        uint64_t* out = values + static_cast<size_t>(aig_.gates[g]) * W;
+        for (int w = 0; w < W; ++w) {
+            out[w] = (a[w] ^ m0) & (b[w] ^ m1);
+        }
+    }
+}
+
+bool AigBitSimulator::run(int num_cycles, GoldenTrace& trace) {
+    if (num_cycles < 1) {
+        std::cerr << "AigBitSimulator: cycle count must be positive" << std::endl;
+        return false;
+    }
+    if (mode_ == StimulusMode::Explicit && (int)sequence_.size() < num_cycles) {
+        std::cerr << "AigBitSimulator: stimulus has " << sequence_.size()
+                  << " cycles, " << num_cycles << " requested" << std::endl;
+        return false;
+    }
+
+    const int W = words_;
+    trace.num_cycles_ = num_cycles;
+    trace.num_nodes_ = aig_.num_nodes;
+    trace.words_ = W;
+    trace.po_literals_ = aig_.pos;
+    trace.bits_.assign(static_cast<size_t>(num_cycles) * aig_.num_nodes * W, 0);
+
+    std::vector<uint64_t> state(aig_.ros.size() * W, 0);
+    for (size_t r = 0; r < aig_.ros.size() && r < initial_state_.size(); ++r) {
+        if (initial_state_[r]) std::fill_n(state.begin() + r * W, W, ~uint64_t(0));
+    }
+
+    std::mt19937_64 rng(seed_);
+
+    for (int c = 1; c <= num_cycles; ++c) {
+        uint64_t* values = trace.mutableWords(0, c);
+
+        for (size_t i = 0; i < aig_.pis.size(); ++i) {
+            uint64_t* v = values + static_cast<size_t>(aig_.pis[i]) * W;
+            if ((int)i == clock_pi_) {
+                std::fill_n(v, W, ~uint64_t(0));
+            } else if (mode_ == StimulusMode::Random) {
+                for (int w = 0; w < W; ++w) v[w] = rng();
+            } else {
+                const std::vector<bool>& in = sequence_[c - 1];
+                std::fill_n(v, W, (i < in.size() && in[i]) ? ~uint64_t(0) : 0);
+            }
+        }
+        for (size_t r = 0; r < aig_.ros.size(); ++r) {
+            std::copy_n(state.begin() + r * W, W, values + static_cast<size_t>(aig_.ros[r]) * W);
+        }
+
+        switch (W) {
+            case 1: evaluateGates<1>(values); break;
+            case 4: evaluateGates<4>(values); break;
+            default: evaluateGatesGeneric(values); break;
+        }
+
+        // 寄存器输入在本周期的值即下一周期的状态
+        for (size_t r = 0; r < aig_.ris.size(); ++r) {
+            const uint32_t lit = aig_.ris[r];
+            const uint64_t m = 0 - static_cast<uint64_t>(lit & 1);
+            const uint64_t* v = values + static_cast<size_t>(lit >> 1) * W;
+            for (int w = 0; w < W; ++w) state[r * W + w] = v[w] ^ m;
+        }
+    }
+    return true;
+}
+
+int AigBitSimulator::compareWithWaveform(const LevelizedAIG& aig, const GoldenTrace& trace, VCDParser& vcd,
+                                         int num_cycles, int max_report) {
+    if (num_cycles > trace.numCycles()) {
+        std::cerr << "AigBitSimulator: trace has only " << trace.numCycles() << " cycles" << std::endl;
+        return -1;
+    }
+
+    int mismatches = 0;
+    int compared = 0;
+    auto report = [&](const std::string& what, int cycle, bool native, double vcd_p1) {
+        if (mismatches++ < max_report) {
+            std::cerr << "Cycle " << cycle << ", " << what << ": native " << native
+                      << ", VCD P(1) " << vcd_p1 << std::endl;
+        }
+    };
+
+    for (int c = 1; c <= num_cycles; ++c) {
+        for (uint32_t node : aig.gates) {
+            double p0, p1;
+            if (!vcd.getNodeOutputByIndex(node, c, p0, p1) || p0 == p1) continue;
+            ++compared;
+            const bool native = trace.value(node, c);
+            if (native != (p1 > 0.5)) report("signal_" + std::to_string(node), c, native, p1);
+        }
+        for (int po = 0; po < trace.numPOs(); ++po) {
+            std::vector<double> p0, p1;
+            if (!vcd.getPOOutputFromWaveform(po, c, p0, p1) || p1.empty() || p0.back() == p1.back()) continue;
+            ++compared;
+            const bool native = trace.getPOValue(po, c);
+            if (native != (p1.back() > 0.5)) report("po" + std::to_string(po), c, native, p1.back());
+        }
+    }
+
+    std::cout << "Native simulation vs VCD: " << compared << " values compared, "
+              << mismatches << " mismatches" << std::endl;
+    return compared == 0 ? -1 : mismatches;
+}
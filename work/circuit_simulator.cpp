@@ -1,6 +1,113 @@
 #include "circuit_simulator.h"
+#include <algorithm>
+#include <iostream>
 
-CircuitReliabilitySimulator::CircuitReliabilitySimulator() {
+// ==================== SimulationTrace ====================
+
+bool SimulationTrace::reset(uint32_t num_nodes, int keyframe_interval) {
+    if (keyframe_interval <= 0) {
+        std::cerr << "SimulationTrace: keyframe interval must be positive, got " << keyframe_interval << std::endl;
+        return false;
+    }
+    num_nodes_ = num_nodes;
+    interval_ = keyframe_interval;
+    words_ = (num_nodes + 63) / 64;
+    keyframes_.clear();
+    key_cycle_.clear();
+    frame_offset_.clear();
+    changes_.clear();
+    change_begin_.assign(1, 0);
+    last_.assign(words_, 0);
+    packed_.assign(words_, 0);
+    return true;
+}
+
+bool SimulationTrace::record(const std::vector<uint8_t>& values) {
+    if (values.size() != num_nodes_) {
+        std::cerr << "SimulationTrace: expected " << num_nodes_ << " node values, got " << values.size() << std::endl;
+        return false;
+    }
+    const int cycle = num_cycles();
+
+    // 压缩成位图后与上一周期异或，翻转个数由 popcount 得到
+    size_t flips = 0;
+    for (size_t w = 0; w < words_; ++w) {
+        const uint32_t begin = w * 64;
+        const uint32_t end = std::min<uint32_t>(begin + 64, num_nodes_);
+        uint64_t bits = 0;
+        for (uint32_t n = begin; n < end; ++n) {
+            bits |= static_cast<uint64_t>(values[n] & 1) << (n - begin);
+        }
+        packed_[w] = bits;
+        flips += __builtin_popcountll(bits ^ last_[w]);
+    }
+
+    // 翻转节点的增量编码超过一帧位图，或距上一关键帧已满间隔时存关键帧
+    const bool key = cycle == 0 || cycle - key_cycle_.back() >= interval_
+                  || flips * sizeof(uint32_t) > words_ * sizeof(uint64_t);
+    if (key) {
+        key_cycle_.push_back(cycle);
+        frame_offset_.push_back(keyframes_.size());
+        keyframes_.insert(keyframes_.end(), packed_.begin(), packed_.end());
+    } else {
+        for (size_t w = 0; w < words_; ++w) {
+            for (uint64_t diff = packed_[w] ^ last_[w]; diff; diff &= diff - 1) {
+                changes_.push_back(w * 64 + __builtin_ctzll(diff));
+            }
+        }
+        key_cycle_.push_back(key_cycle_.back());
+        frame_offset_.push_back(-1);
+    }
+    last_.swap(packed_);
+    change_begin_.push_back(changes_.size());
+    return true;
+}
+
+bool SimulationTrace::checkCycle(int cycle) const {
+    if (cycle < 0 || cycle >= num_cycles()) {
+        std::cerr << "SimulationTrace: cycle " << cycle << " out of range [0, " << num_cycles() << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SimulationTrace::value(uint32_t node, int cycle, bool& v) const {
+    if (!checkCycle(cycle)) return false;
+    if (node >= num_nodes_) {
+        std::cerr << "SimulationTrace: node " << node << " out of range [0, " << num_nodes_ << ")" << std::endl;
+        return false;
+    }
+    const int key = key_cycle_[cycle];
+    v = (keyframes_[frame_offset_[key] + (node >> 6)] >> (node & 63)) & 1;
+    for (size_t i = change_begin_[key + 1]; i < change_begin_[cycle + 1]; ++i) {
+        if (changes_[i] == node) v = !v;
+    }
+    return true;
+}
+
+bool SimulationTrace::values_at(int cycle, std::vector<uint8_t>& values) const {
+    if (!checkCycle(cycle)) return false;
+    const int key = key_cycle_[cycle];
+    values.resize(num_nodes_);
+    const uint64_t* frame = keyframes_.data() + frame_offset_[key];
+    for (uint32_t n = 0; n < num_nodes_; ++n) {
+        values[n] = (frame[n >> 6] >> (n & 63)) & 1;
+    }
+    for (size_t i = change_begin_[key + 1]; i < change_begin_[cycle + 1]; ++i) {
+        values[changes_[i]] ^= 1;
+    }
+    return true;
+}
+
+size_t SimulationTrace::memory_bytes() const {
+    return keyframes_.size() * sizeof(uint64_t) + changes_.size() * sizeof(uint32_t)
+         + change_begin_.size() * sizeof(size_t) + key_cycle_.size() * (sizeof(int) + sizeof(int64_t));
+}
+
+// ==================== CircuitReliabilitySimulator ====================
+
+CircuitReliabilitySimulator::CircuitReliabilitySimulator()
+    : trace_interval_(64), current_cycle_(0), clock_period_(1), clock_duty_cycle_(0.5) {
     set_fault_probability(0.01);
 }
 
@@ -11,60 +118,68 @@ bool CircuitReliabilitySimulator::read_circuit(const std::string& filename) {
       std::cout << "Read benchmark failed\n";
       return false;
     }
-    
+
     std::cout << "Successfully read Verilog circuit: " << filename << std::endl;
     std::cout << "  Inputs: " << get_num_inputs() << std::endl;
     std::cout << "  Outputs: " << get_num_outputs() << std::endl;
     std::cout << "  Gates: " << get_num_gates() << std::endl;
-    
+
+    identify_registers();
+    levelize();
     return true;
 }
 
 bool CircuitReliabilitySimulator::write_verilog(const std::string& filename){
     mockturtle::write_verilog(circuit_,filename);
+    return true;
+}
+
+
+void CircuitReliabilitySimulator::identify_registers() {
+    registers_.clear();
+    node_to_register_map_.clear();
+    index_to_register_map_.clear();
+
+    // AIG 中寄存器即 RO/RI 对，按寄存器序号对齐；时钟隐含在周期中，无复位/预置
+    circuit_.foreach_ro([&](auto node, auto index) {
+        RegisterInfo reg_info(node, index);
+        reg_info.output = circuit_.make_signal(node);
+        reg_info.data_input = circuit_.ri_at(index);
+        registers_.push_back(reg_info);
+    });
+
+    // registers_ 填充完成后再建立指针映射，避免扩容使指针失效
+    for (auto& reg : registers_) {
+        node_to_register_map_[reg.node] = &reg;
+        index_to_register_map_[reg.index] = &reg;
+    }
+
+    if (registers_.empty()) {
+        std::cout << "No registers found in the circuit (combinational circuit)" << std::endl;
+    } else {
+        std::cout << "Identified " << registers_.size() << " registers" << std::endl;
+    }
 }
 
+void CircuitReliabilitySimulator::levelize() {
+    levelized_ = LevelizedAIG::build(circuit_);
+    values_.assign(levelized_.num_nodes, 0);
+    if (registers_.size() != levelized_.ros.size()) {
+        identify_registers();
+    }
+}
 
-// void CircuitReliabilitySimulator::identify_registers() {
-//     registers_.clear();
-//     node_to_register_map_.clear();
-
-//     //todo:
-//     // 使用 Mockturtle 的 foreach_register 来识别寄存器
-//     circuit_.foreach_register([&](auto const& reg) {
-//         RegisterInfo reg_info(circuit_.ro_at(reg.second), reg.second);
-        
-//         // 存储寄存器信号
-//         reg_info.data_input = reg.first;
-//         reg_info.clock_input = reg.clock;
-//         reg_info.output = reg.output;
-        
-//         // 检查是否有复位和预置信号
-//         if (reg.reset != mockturtle::aig_network::signal{}) {
-//             reg_info.reset = reg.reset;
-//         }
-//         if (reg.preset != mockturtle::aig_network::signal{}) {
-//             reg_info.preset = reg.preset;
-//         }
-        
-//         registers_.push_back(reg_info);
-//         node_to_register_map_[circuit_.get_node(reg.output)] = &registers_.back();
-        
-//         std::cout << "Identified register: " << reg.name 
-//                   << " (output node: " << circuit_.get_node(reg.output) << ")" << std::endl;
-//     });
-    
-//     if (registers_.empty()) {
-//         std::cout << "No registers found in the circuit (combinational circuit)" << std::endl;
-//     } else {
-//         std::cout << "Identified " << registers_.size() << " registers using Mockturtle" << std::endl;
-//     }
-// }
+void CircuitReliabilitySimulator::ensure_levelized() {
+    if (levelized_.num_nodes != circuit_.size()) {
+        levelize();
+    }
+}
 
 void CircuitReliabilitySimulator::initialize_sequential_simulation() {
+    ensure_levelized();
     current_cycle_ = 0;
-    node_values_.clear();
-    
+    std::fill(values_.begin(), values_.end(), 0);
+
     // 设置初始状态
     for (auto& reg : registers_) {
         auto it = initial_register_state_.find(reg.index);
@@ -74,17 +189,28 @@ void CircuitReliabilitySimulator::initialize_sequential_simulation() {
             reg.current_state = false; // 默认初始状态为0
         }
         reg.next_state = reg.current_state;
-        
+
         // 设置寄存器输出的初始值
-        auto output_node = circuit_.get_node(reg.output);
-        node_values_[output_node] = reg.current_state;
+        values_[circuit_.node_to_index(reg.node)] = reg.current_state;
     }
-    
+
     setup_constant_nodes();
-    std::cout << "Sequential simulation initialized with " 
+    if (trace_interval_ > 0) {
+        trace_.reset(levelized_.num_nodes, trace_interval_);
+    }
+    std::cout << "Sequential simulation initialized with "
               << registers_.size() << " registers" << std::endl;
 }
 
+bool CircuitReliabilitySimulator::set_trace_keyframe_interval(int interval) {
+    if (interval < 0) {
+        std::cerr << "Keyframe interval must be >= 0 (0 disables the trace), got " << interval << std::endl;
+        return false;
+    }
+    trace_interval_ = interval;
+    return true;
+}
+
 void CircuitReliabilitySimulator::set_clock_sequence(const std::vector<bool>& clock_sequence) {
     clock_sequence_ = clock_sequence;
 }
@@ -95,97 +221,72 @@ void CircuitReliabilitySimulator::set_initial_state(const std::unordered_map<int
 
 CircuitReliabilitySimulator::SimulationCycle CircuitReliabilitySimulator::simulate_sequential_cycle(
     const std::vector<bool>& inputs, int cycle) {
-    
+
+    ensure_levelized();
     SimulationCycle sim_cycle(cycle);
     current_cycle_ = cycle;
-    
+
     // 生成时钟信号
-    bool clock_value = generate_clock_signal(cycle);
-    sim_cycle.clock_value = clock_value;
-    
+    sim_cycle.clock_value = generate_clock_signal(cycle);
+
     // 设置主输入值
-    int input_idx = 0;
-    circuit_.foreach_pi([&](auto node) {
-        bool value = false;
-        if (input_idx < inputs.size()) {
-            value = inputs[input_idx];
-        }
-        
-        node_values_[node] = value;
-        sim_cycle.primary_inputs.push_back(value);
-        input_idx++;
-    });
-    
+    set_inputs(inputs);
+    sim_cycle.primary_inputs.assign(inputs.begin(), inputs.end());
+    sim_cycle.primary_inputs.resize(levelized_.pis.size(), false);
+
     // 设置寄存器的当前状态值
     for (const auto& reg : registers_) {
-        auto output_node = circuit_.get_node(reg.output);
-        node_values_[output_node] = reg.current_state;
-        sim_cycle.register_states[reg.index] = reg.current_state;
-    }
-    
-    // 按拓扑顺序计算组合逻辑
-    // auto topo_order = sequential_topological_sort();
-    // for (auto node : topo_order) {
-    //     if (!circuit_.is_pi(node) && !circuit_.is_constant(node) && 
-    //         !is_register_output(node)) {
-    //         compute_gate_output(node);
-    //     }
-    // }
-    
+        values_[circuit_.node_to_index(reg.node)] = reg.current_state;
+    }
+
+    // 按层级顺序计算组合逻辑
+    evaluate_gates();
+
     // 更新寄存器的下一个状态
     update_register_next_states();
-    
+
     // 收集主输出值
-    circuit_.foreach_po([&](auto po) {
-        auto po_node = circuit_.get_node(po);
-        bool value = node_values_[po_node];
-        if (circuit_.is_complemented(po)) {
-            value = !value;
-        }
-        sim_cycle.primary_outputs.push_back(value);
-    });
-    
+    sim_cycle.primary_outputs.reserve(levelized_.pos.size());
+    for (uint32_t lit : levelized_.pos) {
+        sim_cycle.primary_outputs.push_back(literal_value(lit));
+    }
+
     // 收集寄存器输出值
+    sim_cycle.register_outputs.reserve(registers_.size());
     for (const auto& reg : registers_) {
-        auto output_node = circuit_.get_node(reg.output);
-        sim_cycle.register_outputs.push_back(node_values_[output_node]);
+        sim_cycle.register_outputs.push_back(reg.current_state);
     }
-    
-    // 记录所有节点值
-    for (const auto& [node, value] : node_values_) {
-        sim_cycle.node_values[node] = value;
+
+    // 记录所有节点值 (关键帧 + 翻转增量)
+    if (trace_interval_ > 0) {
+        trace_.record(values_);
     }
-    
+
     // 在时钟上升沿更新寄存器状态
-    bool previous_clock = generate_clock_signal(cycle - 1);
     if (is_clock_edge(cycle)) {
         propagate_register_values();
     }
-    
+
     return sim_cycle;
 }
 
-std::vector<CircuitReliabilitySimulator::SimulationCycle> 
+std::vector<CircuitReliabilitySimulator::SimulationCycle>
 CircuitReliabilitySimulator::simulate_sequential_circuit(
-    const std::vector<std::vector<bool>>& input_sequence, 
+    const std::vector<std::vector<bool>>& input_sequence,
     int num_cycles,
     bool reset_between_cycles) {
-    
+
     std::vector<SimulationCycle> simulation_result;
+    simulation_result.reserve(num_cycles);
     initialize_sequential_simulation();
-    
+
+    const std::vector<bool> default_inputs(get_num_inputs(), false);
     for (int cycle = 0; cycle < num_cycles; cycle++) {
-        std::vector<bool> inputs;
-        if (cycle < input_sequence.size()) {
-            inputs = input_sequence[cycle];
-        } else {
-            // 如果没有提供输入，使用默认值
-            inputs = std::vector<bool>(get_num_inputs(), false);
-        }
-        
-        auto sim_cycle = simulate_sequential_cycle(inputs, cycle);
-        simulation_result.push_back(sim_cycle);
-        
+        // 如果没有提供输入，使用默认值
+        const std::vector<bool>& inputs = cycle < (int)input_sequence.size() ? input_sequence[cycle] : default_inputs;
+
+        simulation_result.push_back(simulate_sequential_cycle(inputs, cycle));
+
         if (reset_between_cycles) {
             // 重置寄存器状态
             for (auto& reg : registers_) {
@@ -193,36 +294,22 @@ CircuitReliabilitySimulator::simulate_sequential_circuit(
             }
         }
     }
-    
+
     std::cout << "Sequential simulation completed for " << num_cycles << " cycles" << std::endl;
     return simulation_result;
 }
 
 void CircuitReliabilitySimulator::update_register_next_states() {
     for (auto& reg : registers_) {
-        if (reg.data_input != mockturtle::aig_network::signal{}) {
-            auto data_node = circuit_.get_node(reg.data_input);
-            auto it = node_values_.find(data_node);
-            if (it != node_values_.end()) {
-                reg.next_state = it->second;
-            }
-        }
-        
+        reg.next_state = get_fanin_value(reg.data_input);
+
         // 检查复位和预置信号
-        if (reg.reset != mockturtle::aig_network::signal{}) {
-            auto reset_node = circuit_.get_node(reg.reset);
-            auto reset_it = node_values_.find(reset_node);
-            if (reset_it != node_values_.end() && reset_it->second) {
-                reg.next_state = false; // 复位有效，下一个状态为0
-            }
+        if (reg.reset != mockturtle::aig_network::signal{} && get_fanin_value(reg.reset)) {
+            reg.next_state = false; // 复位有效，下一个状态为0
         }
-        
-        if (reg.preset != mockturtle::aig_network::signal{}) {
-            auto preset_node = circuit_.get_node(reg.preset);
-            auto preset_it = node_values_.find(preset_node);
-            if (preset_it != node_values_.end() && preset_it->second) {
-                reg.next_state = true; // 预置有效，下一个状态为1
-            }
+
+        if (reg.preset != mockturtle::aig_network::signal{} && get_fanin_value(reg.preset)) {
+            reg.next_state = true; // 预置有效，下一个状态为1
         }
     }
 }
@@ -236,8 +323,7 @@ CircuitReliabilitySimulator::RegisterInfo* CircuitReliabilitySimulator::get_regi
 void CircuitReliabilitySimulator::propagate_register_values() {
     for (auto& reg : registers_) {
         reg.current_state = reg.next_state;
-        auto output_node = circuit_.get_node(reg.output);
-        node_values_[output_node] = reg.current_state;
+        values_[circuit_.node_to_index(reg.node)] = reg.current_state;
     }
 }
 
@@ -253,6 +339,10 @@ bool CircuitReliabilitySimulator::generate_clock_signal(int cycle, int phase) co
 }
 
 bool CircuitReliabilitySimulator::is_clock_edge(int cycle) const {
+    // 未给出时钟序列时每个仿真周期对应一个时钟周期，寄存器在周期末更新
+    if (clock_sequence_.empty()) {
+        return true;
+    }
     bool current_clock = generate_clock_signal(cycle);
     bool previous_clock = generate_clock_signal(cycle - 1);
     return current_clock && !previous_clock; // 检测上升沿
@@ -280,8 +370,7 @@ void CircuitReliabilitySimulator::set_register_state(int register_index, bool st
     auto reg_ptr = get_register_by_index(register_index);
     if (reg_ptr) {
         reg_ptr->current_state = state;
-        auto output_node = circuit_.get_node(reg_ptr->output);
-        node_values_[output_node] = state;
+        values_[circuit_.node_to_index(reg_ptr->node)] = state;
     } else {
         std::cerr << "Warning: Register index " << register_index << " not found" << std::endl;
     }
@@ -295,6 +384,33 @@ std::vector<mockturtle::aig_network::node> CircuitReliabilitySimulator::get_regi
     return outputs;
 }
 
+std::vector<mockturtle::aig_network::node> CircuitReliabilitySimulator::get_primary_inputs() const {
+    std::vector<mockturtle::aig_network::node> nodes;
+    circuit_.foreach_pi([&](auto node) { nodes.push_back(node); });
+    return nodes;
+}
+
+std::vector<mockturtle::aig_network::node> CircuitReliabilitySimulator::get_primary_outputs() const {
+    std::vector<mockturtle::aig_network::node> nodes;
+    circuit_.foreach_po([&](auto signal) { nodes.push_back(circuit_.get_node(signal)); });
+    return nodes;
+}
+
+std::vector<mockturtle::aig_network::node> CircuitReliabilitySimulator::get_gates() const {
+    std::vector<mockturtle::aig_network::node> nodes;
+    circuit_.foreach_gate([&](auto node) { nodes.push_back(node); });
+    return nodes;
+}
+
+void CircuitReliabilitySimulator::print_circuit_info() const {
+    std::cout << "=== Circuit Info ===" << std::endl;
+    std::cout << "  Inputs: " << get_num_inputs() << std::endl;
+    std::cout << "  Outputs: " << get_num_outputs() << std::endl;
+    std::cout << "  Gates: " << get_num_gates() << std::endl;
+    std::cout << "  Registers: " << get_num_registers() << std::endl;
+    std::cout << "  Depth: " << levelized_.depth << std::endl;
+}
+
 void CircuitReliabilitySimulator::print_registers() const {
     std::cout << "=== Registers (using Mockturtle) ===" << std::endl;
     for (size_t i = 0; i < registers_.size(); i++) {
@@ -303,43 +419,37 @@ void CircuitReliabilitySimulator::print_registers() const {
         std::cout << "  Output node: " << circuit_.get_node(reg.output) << std::endl;
         std::cout << "  Data input node: " << circuit_.get_node(reg.data_input) << std::endl;
         std::cout << "  Clock input node: " << circuit_.get_node(reg.clock_input) << std::endl;
-        
+
         if (reg.reset != mockturtle::aig_network::signal{}) {
             std::cout << "  Reset node: " << circuit_.get_node(reg.reset) << std::endl;
         }
         if (reg.preset != mockturtle::aig_network::signal{}) {
             std::cout << "  Preset node: " << circuit_.get_node(reg.preset) << std::endl;
         }
-        
+
         std::cout << "  Current state: " << reg.current_state << std::endl;
     }
 }
 
 void CircuitReliabilitySimulator::print_simulation_state(int cycle) const {
     std::cout << "=== Simulation State (Cycle " << cycle << ") ===" << std::endl;
-    
+
     // 打印寄存器状态
     std::cout << "Register States: ";
     for (const auto& reg : registers_) {
         std::cout << "[" << reg.index << "]=" << reg.current_state << " ";
     }
     std::cout << std::endl;
-    
+
     // 打印主输出
     std::cout << "Primary Outputs: ";
-    circuit_.foreach_po([&](auto po) {
-        auto po_node = circuit_.get_node(po);
-        auto it = node_values_.find(po_node);
-        if (it != node_values_.end()) {
-            bool value = it->second;
-            if (circuit_.is_complemented(po)) {
-                value = !value;
-            }
-            std::cout << value << " ";
+    if (levelized_.num_nodes == values_.size()) {
+        for (uint32_t lit : levelized_.pos) {
+            std::cout << literal_value(lit) << " ";
         }
-    });
+    }
     std::cout << std::endl;
-    
+
     // 打印时钟状态
     std::cout << "Clock: " << generate_clock_signal(cycle) << std::endl;
 }
@@ -350,7 +460,7 @@ void CircuitReliabilitySimulator::set_fault_probability(double fp) {
     circuit_.foreach_gate([&](auto node) {
         fault_probabilities_[node] = fp;
     });
-    
+
 }
 
 void CircuitReliabilitySimulator::set_node_fault_probability(
@@ -359,23 +469,9 @@ void CircuitReliabilitySimulator::set_node_fault_probability(
 }
 
 void CircuitReliabilitySimulator::setup_constant_nodes() {
-    try {
-        // 设置常数0节点
-        auto constant0_signal = circuit_.get_constant(false);
-        auto constant0_node = circuit_.get_node(constant0_signal);
-        if (circuit_.is_constant(constant0_node)) {
-            node_values_[constant0_node] = false;
-        }
-        
-        // 设置常数1节点（如果存在独立的节点）
-        auto constant1_signal = circuit_.get_constant(true);
-        auto constant1_node = circuit_.get_node(constant1_signal);
-        if (circuit_.is_constant(constant1_node) && constant1_node != constant0_node) {
-            node_values_[constant1_node] = true;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Error setting up constant nodes: " << e.what() << std::endl;
-    }
+    // AIG 只有常量 0 节点，常量 1 由取反文字表示
+    auto constant0_node = circuit_.get_node(circuit_.get_constant(false));
+    values_[circuit_.node_to_index(constant0_node)] = 0;
 }
 
 double CircuitReliabilitySimulator::get_node_fault_probability(
@@ -385,104 +481,65 @@ double CircuitReliabilitySimulator::get_node_fault_probability(
 }
 
 std::vector<bool> CircuitReliabilitySimulator::fault_free_simulation_iverilog(const std::vector<bool>& inputs){
-    
+
 }
 
 
 std::vector<bool> CircuitReliabilitySimulator::fault_free_simulation(const std::vector<bool>& inputs) {
     // 对于时序电路，单次仿真使用当前状态
-    node_values_.clear();
+    ensure_levelized();
     setup_constant_nodes();
-    
+
     // 设置输入值
-    int input_idx = 0;
-    circuit_.foreach_pi([&](auto node) {
-        if (input_idx < inputs.size()) {
-            node_values_[node] = inputs[input_idx++];
-        } else {
-            node_values_[node] = false;
-        }
-    });
-    
+    set_inputs(inputs);
+
     // 设置寄存器当前状态
     for (const auto& reg : registers_) {
-        auto output_node = circuit_.get_node(reg.output);
-        node_values_[output_node] = reg.current_state;
+        values_[circuit_.node_to_index(reg.node)] = reg.current_state;
     }
-    
+
     // 计算组合逻辑
-    // auto topo_order = sequential_topological_sort();
-    // for (auto node : topo_order) {
-    //     if (!circuit_.is_pi(node) && !circuit_.is_constant(node) && 
-    //         !is_register_output(node)) {
-    //         compute_gate_output(node);
-    //     }
-    // }
-    
+    evaluate_gates();
+
     // 收集输出
     std::vector<bool> outputs;
-    circuit_.foreach_po([&](auto po) {
-        auto po_node = circuit_.get_node(po);
-        bool value = node_values_[po_node];
-        if (circuit_.is_complemented(po)) {
-            value = !value;
-        }
-        outputs.push_back(value);
-    });
-    
+    outputs.reserve(levelized_.pos.size());
+    for (uint32_t lit : levelized_.pos) {
+        outputs.push_back(literal_value(lit));
+    }
+
     return outputs;
 }
 
-
-void CircuitReliabilitySimulator::compute_gate_output(mockturtle::aig_network::node node) {
-    if (circuit_.is_constant(node)) {
-        node_values_[node] = circuit_.constant_value(node);
-        return;
-    }
-    
-    if (circuit_.is_pi(node)) {
-        return; 
-    }
-    
-    // 获取所有扇入的值
-    std::vector<bool> fanin_values = get_fanin_values(node);
-    
-    // 根据门类型计算输出
-    if (circuit_.is_and(node)) {
-        node_values_[node] = compute_and_gate(fanin_values);
-    }
-    // 可以扩展其他门类型
-    else {
-        // 默认为 AND 门
-        node_values_[node] = compute_and_gate(fanin_values);
+std::unordered_map<mockturtle::aig_network::node, bool> CircuitReliabilitySimulator::get_node_values() const {
+    std::unordered_map<mockturtle::aig_network::node, bool> values;
+    values.reserve(values_.size());
+    for (uint32_t n = 0; n < values_.size(); ++n) {
+        values[circuit_.index_to_node(n)] = values_[n];
     }
+    return values;
 }
 
-bool CircuitReliabilitySimulator::compute_and_gate(const std::vector<bool>& inputs) {
-    bool result = true;
-    for (bool val : inputs) {
-        result &= val;
+void CircuitReliabilitySimulator::set_inputs(const std::vector<bool>& inputs) {
+    for (size_t i = 0; i < levelized_.pis.size(); ++i) {
+        values_[levelized_.pis[i]] = i < inputs.size() && inputs[i];
     }
-    return result;
 }
 
-bool CircuitReliabilitySimulator::get_fanin_value(mockturtle::aig_network::signal fanin) const {
-    auto node = circuit_.get_node(fanin);
-    bool value = node_values_.at(node);
-    if (circuit_.is_complemented(fanin)) {
-        value = !value;
+void CircuitReliabilitySimulator::evaluate_gates() {
+    // 与门数组按层级排序，扇入一定已经求值；取反位直接异或
+    uint8_t* v = values_.data();
+    const uint32_t* gates = levelized_.gates.data();
+    const uint32_t* f0 = levelized_.fanin0.data();
+    const uint32_t* f1 = levelized_.fanin1.data();
+    const size_t n = levelized_.gates.size();
+    for (size_t g = 0; g < n; ++g) {
+        v[gates[g]] = (v[f0[g] >> 1] ^ (f0[g] & 1)) & (v[f1[g] >> 1] ^ (f1[g] & 1));
     }
-    return value;
 }
 
-std::vector<bool> CircuitReliabilitySimulator::get_fanin_values(
-    mockturtle::aig_network::node node) const {
-    
-    std::vector<bool> values;
-    circuit_.foreach_fanin(node, [&](auto fanin) {
-        values.push_back(get_fanin_value(fanin));
-    });
-    return values;
+bool CircuitReliabilitySimulator::get_fanin_value(mockturtle::aig_network::signal fanin) const {
+    return values_[circuit_.node_to_index(circuit_.get_node(fanin))] ^ circuit_.is_complemented(fanin);
 }
 
 
@@ -496,4 +553,4 @@ size_t CircuitReliabilitySimulator::get_num_outputs() const {
 
 size_t CircuitReliabilitySimulator::get_num_gates() const {
     return circuit_.num_gates();
-}
\ No newline at end of file
+}
@@ -0,0 +1,236 @@
+#include "fault_campaign.h"
+#include "philox_rng.h"
+#include <omp.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+FaultCampaign::FaultCampaign(const LevelizedAIG& aig)
+    : aig_(aig), dropping_(true), num_patterns_(0) {
+    const uint32_t n = aig_.num_nodes;
+
+    // 扇出表
+    fanout_begin_.assign(n + 1, 0);
+    for (size_t g = 0; g < aig_.gates.size(); g++) {
+        const uint32_t a = aig_.fanin0[g] >> 1, b = aig_.fanin1[g] >> 1;
+        fanout_begin_[a + 1]++;
+        if (b != a) fanout_begin_[b + 1]++;
+    }
+    for (uint32_t i = 0; i < n; i++) fanout_begin_[i + 1] += fanout_begin_[i];
+    fanout_gates_.resize(fanout_begin_[n]);
+    std::vector<uint32_t> fill(fanout_begin_.begin(), fanout_begin_.end() - 1);
+    for (size_t g = 0; g < aig_.gates.size(); g++) {
+        const uint32_t a = aig_.fanin0[g] >> 1, b = aig_.fanin1[g] >> 1;
+        fanout_gates_[fill[a]++] = g;
+        if (b != a) fanout_gates_[fill[b]++] = g;
+    }
+
+    observed_.assign(n, 0);
+    for (uint32_t lit : aig_.pos) observed_[lit >> 1] = 1;
+    for (uint32_t lit : aig_.ris) observed_[lit >> 1] = 1;
+
+    enumerate_faults();
+}
+
+void FaultCampaign::enumerate_faults() {
+    faults_.clear();
+    auto add = [&](uint32_t node) {
+        faults_.push_back({node, false});
+        faults_.push_back({node, true});
+    };
+    for (uint32_t node : aig_.pis) add(node);
+    for (uint32_t node : aig_.ros) add(node);
+    for (uint32_t node : aig_.gates) add(node);
+}
+
+void FaultCampaign::set_fault_list(const std::vector<StuckAtFault>& faults) {
+    faults_.clear();
+    for (const auto& f : faults) {
+        if (f.node > 0 && f.node < aig_.num_nodes) faults_.push_back(f);
+    }
+}
+
+void FaultCampaign::set_results(const std::vector<FaultResult>& results) {
+    results_ = results;
+    faults_.clear();
+    for (const auto& r : results_) faults_.push_back(r.fault);
+}
+
+bool FaultCampaign::run_random(long long num_patterns, uint64_t seed) {
+    return run_words(num_patterns, [&](long long word, size_t ci, uint64_t valid) {
+        PhiloxStream rng(seed, (uint32_t)ci, (uint32_t)word, (uint32_t)(word >> 32));
+        return rng() & valid;
+    });
+}
+
+bool FaultCampaign::run(const std::vector<std::vector<bool>>& patterns) {
+    const size_t cis = aig_.pis.size() + aig_.ros.size();
+    for (size_t p = 0; p < patterns.size(); p++) {
+        if (patterns[p].size() != cis) {
+            std::cerr << "Error: pattern " << p << " has " << patterns[p].size()
+                      << " values, expected " << cis << " (PIs then registers)" << std::endl;
+            return false;
+        }
+    }
+    return run_words((long long)patterns.size(), [&](long long word, size_t ci, uint64_t valid) {
+        uint64_t bits = 0;
+        for (int b = 0; b < 64 && ((valid >> b) & 1); b++) {
+            bits |= uint64_t(patterns[word * 64 + b][ci]) << b;
+        }
+        return bits;
+    });
+}
+
+template <typename Fill>
+bool FaultCampaign::run_words(long long num_patterns, Fill fill) {
+    if (num_patterns <= 0) {
+        std::cerr << "Error: fault campaign needs at least one pattern" << std::endl;
+        return false;
+    }
+    num_patterns_ = num_patterns;
+    results_.assign(faults_.size(), FaultResult());
+    for (size_t i = 0; i < faults_.size(); i++) results_[i].fault = faults_[i];
+
+    std::vector<uint32_t> active(faults_.size());
+    for (size_t i = 0; i < active.size(); i++) active[i] = i;
+
+    scratch_.resize(omp_get_max_threads());
+    for (auto& s : scratch_) {
+        s.value.assign(aig_.num_nodes, 0);
+        s.stamp.assign(aig_.num_nodes, 0);
+        s.queued.assign(aig_.gates.size(), 0);
+        s.levels.assign(aig_.depth + 1, {});
+        s.current = 0;
+    }
+    good_.assign(aig_.num_nodes, 0);
+
+    const long long words = (num_patterns + 63) / 64;
+    for (long long word = 0; word < words && !active.empty(); word++) {
+        const long long bits = std::min<long long>(64, num_patterns - word * 64);
+        const uint64_t valid = bits == 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+
+        for (size_t i = 0; i < aig_.pis.size(); i++) good_[aig_.pis[i]] = fill(word, i, valid);
+        for (size_t r = 0; r < aig_.ros.size(); r++) good_[aig_.ros[r]] = fill(word, aig_.pis.size() + r, valid);
+        simulate_good(valid);
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (size_t k = 0; k < active.size(); k++) {
+            simulate_fault(active[k], word, valid, scratch_[omp_get_thread_num()]);
+        }
+
+        if (dropping_) {
+            active.erase(std::remove_if(active.begin(), active.end(),
+                                        [&](uint32_t i) { return results_[i].detected(); }),
+                         active.end());
+        }
+    }
+    return true;
+}
+
+void FaultCampaign::simulate_good(uint64_t valid) {
+    good_[0] = 0;
+    for (size_t g = 0; g < aig_.gates.size(); g++) {
+        const uint32_t f0 = aig_.fanin0[g], f1 = aig_.fanin1[g];
+        const uint64_t a = good_[f0 >> 1] ^ (0 - (uint64_t)(f0 & 1));
+        const uint64_t b = good_[f1 >> 1] ^ (0 - (uint64_t)(f1 & 1));
+        good_[aig_.gates[g]] = a & b & valid;
+    }
+}
+
+// 故障点与无故障值不同的位作为初始事件，按层级沿扇出锥传播，差异消失处停止
+void FaultCampaign::simulate_fault(size_t index, long long word, uint64_t valid, Scratch& s) {
+    const StuckAtFault& fault = faults_[index];
+    FaultResult& result = results_[index];
+    const uint64_t stuck = fault.value ? valid : 0;
+    const uint64_t excite = (good_[fault.node] ^ stuck) & valid;
+    if (excite == 0) return;
+
+    if (++s.current == 0) {
+        std::fill(s.stamp.begin(), s.stamp.end(), 0);
+        std::fill(s.queued.begin(), s.queued.end(), 0);
+        s.current = 1;
+    }
+    size_t pending = 0;   // 队列中尚未求值的门数，为 0 时锥内差异已全部消失
+    auto value = [&](uint32_t node) { return s.stamp[node] == s.current ? s.value[node] : good_[node]; };
+    auto mark = [&](uint32_t node, uint64_t v) {
+        s.stamp[node] = s.current;
+        s.value[node] = v;
+        for (uint32_t i = fanout_begin_[node]; i < fanout_begin_[node + 1]; i++) {
+            const uint32_t g = fanout_gates_[i];
+            if (s.queued[g] != s.current) {
+                s.queued[g] = s.current;
+                s.levels[aig_.level[aig_.gates[g]]].push_back(g);
+                pending++;
+            }
+        }
+    };
+
+    uint64_t detect = observed_[fault.node] ? excite : 0;
+    mark(fault.node, stuck);
+    for (uint32_t level = aig_.level[fault.node] + 1; pending > 0 && level < s.levels.size(); level++) {
+        auto& queue = s.levels[level];
+        pending -= queue.size();
+        for (size_t i = 0; i < queue.size(); i++) {
+            const uint32_t g = queue[i];
+            const uint32_t node = aig_.gates[g];
+            const uint32_t f0 = aig_.fanin0[g], f1 = aig_.fanin1[g];
+            const uint64_t v = (value(f0 >> 1) ^ (0 - (uint64_t)(f0 & 1)))
+                             & (value(f1 >> 1) ^ (0 - (uint64_t)(f1 & 1))) & valid;
+            const uint64_t diff = v ^ good_[node];
+            if (diff == 0) continue;
+            mark(node, v);
+            if (observed_[node]) detect |= diff;
+        }
+        queue.clear();
+    }
+
+    result.activations += __builtin_popcountll(excite);
+    result.detections += __builtin_popcountll(detect);
+    if (detect && result.first_detection < 0) {
+        result.first_detection = word * 64 + __builtin_ctzll(detect);
+    }
+}
+
+size_t FaultCampaign::get_num_detected() const {
+    return std::count_if(results_.begin(), results_.end(), [](const FaultResult& r) { return r.detected(); });
+}
+
+double FaultCampaign::get_fault_coverage() const {
+    return results_.empty() ? 0.0 : static_cast<double>(get_num_detected()) / results_.size();
+}
+
+void FaultCampaign::print_summary() const {
+    size_t never_activated = 0;
+    long long activations = 0, masked = 0;
+    for (const auto& r : results_) {
+        if (r.activations < 0) continue;  // 展开结果中激活数未知
+        if (r.activations == 0) never_activated++;
+        activations += r.activations;
+        masked += r.masked();
+    }
+    std::cout << "Stuck-at fault campaign: " << results_.size() << " faults, "
+              << num_patterns_ << " patterns" << (dropping_ ? " (fault dropping)" : "") << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Detected: " << get_num_detected() << " (" << 100.0 * get_fault_coverage() << "%)"
+              << ", never activated: " << never_activated << std::endl;
+    if (activations > 0) {
+        std::cout << "  Masked activations: " << masked << "/" << activations
+                  << " (" << 100.0 * masked / activations << "%)" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+bool FaultCampaign::write_report(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+    file << "# node stuck_at activations detections masked first_detection\n";
+    for (const auto& r : results_) {
+        file << r.fault.node << " " << (r.fault.value ? 1 : 0) << " " << r.activations << " "
+             << r.detections << " " << r.masked() << " " << r.first_detection << "\n";
+    }
+    return true;
+}
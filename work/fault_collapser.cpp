@@ -0,0 +1,151 @@
+#include "fault_collapser.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+struct UnionFind {
+    std::vector<uint32_t> parent;
+
+    explicit UnionFind(size_t n) : parent(n) { std::iota(parent.begin(), parent.end(), 0); }
+
+    uint32_t find(uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+    void unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) parent[std::max(a, b)] = std::min(a, b);   // 序号小的作代表
+    }
+};
+
+}
+
+FaultCollapser::FaultCollapser(const LevelizedAIG& aig, bool use_dominance)
+    : equivalence_dropped_(0), dominance_dropped_(0) {
+    const uint32_t n = aig.num_nodes;
+
+    // 全部故障及 (节点, 值) -> 故障序号
+    std::vector<int64_t> index(2 * (size_t)n, -1);
+    auto add = [&](uint32_t node) {
+        for (bool v : {false, true}) {
+            index[2 * (size_t)node + v] = faults_.size();
+            faults_.push_back({node, v});
+        }
+    };
+    for (uint32_t node : aig.pis) add(node);
+    for (uint32_t node : aig.ros) add(node);
+    for (uint32_t node : aig.gates) add(node);
+    auto fault = [&](uint32_t node, bool v) { return index[2 * (size_t)node + v]; };
+
+    // 无扇出节点：恰好一个扇出门、不被 PO/寄存器输入直接观测
+    std::vector<uint32_t> fanouts(n, 0);
+    std::vector<uint8_t> observed(n, 0);
+    for (size_t g = 0; g < aig.gates.size(); g++) {
+        const uint32_t a = aig.fanin0[g] >> 1, b = aig.fanin1[g] >> 1;
+        fanouts[a]++;
+        if (b != a) fanouts[b]++;
+    }
+    for (uint32_t lit : aig.pos) observed[lit >> 1] = 1;
+    for (uint32_t lit : aig.ris) observed[lit >> 1] = 1;
+    auto fanout_free = [&](uint32_t node) {
+        return node != 0 && fanouts[node] == 1 && !observed[node] && fault(node, false) >= 0;
+    };
+
+    // 等价：输入取控制值 0 的故障 == 输出 stuck-at-0
+    UnionFind uf(faults_.size());
+    for (size_t g = 0; g < aig.gates.size(); g++) {
+        const uint32_t out = aig.gates[g];
+        for (uint32_t lit : {aig.fanin0[g], aig.fanin1[g]}) {
+            const uint32_t in = lit >> 1;
+            if ((aig.fanin0[g] >> 1) == (aig.fanin1[g] >> 1) || !fanout_free(in)) continue;
+            uf.unite(fault(in, lit & 1), fault(out, false));
+        }
+    }
+
+    // 支配：按层级顺序，g stuck-at-1 所在的类支配无扇出输入为 1 的故障类；
+    // 依赖的类若已被丢弃则沿它的依赖继续 (支配关系可传递)
+    std::vector<int64_t> depends(faults_.size(), -1);   // 类代表 -> 所依赖的类代表
+    auto kept = [&](uint32_t cls) {
+        while (depends[cls] >= 0) cls = depends[cls];
+        return cls;
+    };
+    if (use_dominance) {
+        for (size_t g = 0; g < aig.gates.size(); g++) {
+            const uint32_t out = aig.gates[g];
+            if ((aig.fanin0[g] >> 1) == (aig.fanin1[g] >> 1)) continue;
+            const uint32_t cls = uf.find(fault(out, true));
+            if (depends[cls] >= 0) continue;
+            for (uint32_t lit : {aig.fanin0[g], aig.fanin1[g]}) {
+                const uint32_t in = lit >> 1;
+                if (!fanout_free(in)) continue;
+                const uint32_t target = kept(uf.find(fault(in, !(lit & 1))));
+                if (target == cls) continue;
+                depends[cls] = target;
+                break;
+            }
+        }
+    }
+
+    // 代表与成员
+    std::vector<int64_t> rep_of_class(faults_.size(), -1);
+    for (uint32_t f = 0; f < faults_.size(); f++) {
+        const uint32_t cls = uf.find(f);
+        if (depends[cls] >= 0) continue;
+        if (rep_of_class[cls] < 0) {
+            rep_of_class[cls] = representatives_.size();
+            representatives_.push_back(faults_[cls]);
+            members_.emplace_back();
+            implied_.emplace_back();
+        } else {
+            equivalence_dropped_++;
+        }
+        members_[rep_of_class[cls]].push_back(f);
+    }
+    for (uint32_t f = 0; f < faults_.size(); f++) {
+        const uint32_t cls = uf.find(f);
+        if (depends[cls] < 0) continue;
+        implied_[rep_of_class[kept(cls)]].push_back(f);
+        dominance_dropped_++;
+    }
+}
+
+std::vector<FaultCampaign::FaultResult>
+FaultCollapser::expand(const std::vector<FaultCampaign::FaultResult>& rep_results) const {
+    std::vector<FaultCampaign::FaultResult> results(faults_.size());
+    for (size_t f = 0; f < faults_.size(); f++) {
+        results[f].fault = faults_[f];
+        results[f].activations = -1;
+        results[f].detections = -1;
+    }
+    if (rep_results.size() != representatives_.size()) {
+        std::cerr << "Error: expected " << representatives_.size() << " representative results, got "
+                  << rep_results.size() << std::endl;
+        return results;
+    }
+    for (size_t r = 0; r < representatives_.size(); r++) {
+        const auto& rep = rep_results[r];
+        for (uint32_t f : members_[r]) {
+            results[f].first_detection = rep.first_detection;
+            results[f].detections = rep.detections;
+            if (faults_[f].node == rep.fault.node && faults_[f].value == rep.fault.value) {
+                results[f].activations = rep.activations;
+            }
+        }
+        for (uint32_t f : implied_[r]) {
+            results[f].first_detection = rep.first_detection;
+        }
+    }
+    return results;
+}
+
+void FaultCollapser::print_summary() const {
+    std::cout << "Fault collapsing: " << faults_.size() << " faults -> " << representatives_.size()
+              << " representatives (" << 100.0 * collapse_ratio() << "%), "
+              << equivalence_dropped_ << " equivalent, " << dominance_dropped_ << " dominated" << std::endl;
+}
@@ -1,19 +1,29 @@
 #include "fault_injector.h"
+#include <algorithm>
 #include <iostream>
 
 FaultInjector::FaultInjector(mockturtle::aig_network& circuit) 
-    : circuit_(circuit), rng_(std::random_device{}()), dist_(0.0, 1.0) {
+    : circuit_(circuit), seed_(0), trial_(0) {
 }
 
 void FaultInjector::inject_random_faults(double fault_probability) {
     stuck_at_faults_.clear();
     
-    circuit_.foreach_gate([&](auto node) {
-        if (dist_(rng_) < fault_probability) {
-            // 随机选择 stuck-at-0 或 stuck-at-1
-            stuck_at_faults_[node] = (dist_(rng_) < 0.5);
-        }
-    });
+    if (gates_.size() != circuit_.num_gates()) {
+        gates_.clear();
+        circuit_.foreach_gate([&](auto node) {
+            gates_.push_back(node);
+        });
+    }
+    
+    // 几何跳跃只抽出故障门，随机数个数与故障数成正比
+    PhiloxStream rng(seed_, trial_++);
+    fault_sites_.clear();
+    FaultSiteSampler(fault_probability).sample(gates_.size(), rng, fault_sites_);
+    for (uint64_t site : fault_sites_) {
+        // 随机选择 stuck-at-0 或 stuck-at-1
+        stuck_at_faults_[gates_[site]] = (rng() >> 63) != 0;
+    }
     
     std::cout << "Injected " << stuck_at_faults_.size() << " random faults" << std::endl;
 }
@@ -75,6 +85,168 @@ std::vector<bool> FaultInjector::simulate_with_faults(
     return outputs;
 }
 
+void FaultInjector::ensure_levelized() {
+    if (levelized_.num_nodes == circuit_.size()) return;
+    levelized_ = LevelizedAIG::build(circuit_);
+    const uint32_t n = levelized_.num_nodes;
+    
+    gate_of_node_.assign(n, UINT32_MAX);
+    for (size_t g = 0; g < levelized_.gates.size(); g++) gate_of_node_[levelized_.gates[g]] = g;
+    
+    // 扇出表 (按门序号，即层级顺序) 与 RI 读取表，均为 CSR
+    fanout_begin_.assign(n + 1, 0);
+    for (size_t g = 0; g < levelized_.gates.size(); g++) {
+        fanout_begin_[(levelized_.fanin0[g] >> 1) + 1]++;
+        if ((levelized_.fanin1[g] >> 1) != (levelized_.fanin0[g] >> 1)) fanout_begin_[(levelized_.fanin1[g] >> 1) + 1]++;
+    }
+    for (uint32_t i = 0; i < n; i++) fanout_begin_[i + 1] += fanout_begin_[i];
+    fanout_gates_.resize(fanout_begin_[n]);
+    std::vector<uint32_t> fill(fanout_begin_.begin(), fanout_begin_.end() - 1);
+    for (size_t g = 0; g < levelized_.gates.size(); g++) {
+        const uint32_t a = levelized_.fanin0[g] >> 1, b = levelized_.fanin1[g] >> 1;
+        fanout_gates_[fill[a]++] = g;
+        if (b != a) fanout_gates_[fill[b]++] = g;
+    }
+    
+    ri_begin_.assign(n + 1, 0);
+    for (uint32_t lit : levelized_.ris) ri_begin_[(lit >> 1) + 1]++;
+    for (uint32_t i = 0; i < n; i++) ri_begin_[i + 1] += ri_begin_[i];
+    ri_of_node_.resize(ri_begin_[n]);
+    fill.assign(ri_begin_.begin(), ri_begin_.end() - 1);
+    for (size_t r = 0; r < levelized_.ris.size(); r++) ri_of_node_[fill[levelized_.ris[r] >> 1]++] = r;
+    
+    diff_stamp_.assign(n, 0);
+    diff_value_.assign(n, 0);
+    queued_stamp_.assign(levelized_.gates.size(), 0);
+    stuck_.assign(n, -1);
+    level_queue_.assign(levelized_.depth + 1, {});
+    stamp_ = 0;
+    
+    golden_words_ = (n + 63) / 64;
+    golden_bits_.clear();
+    golden_cycles_ = 0;
+}
+
+void FaultInjector::record_golden_cycle(const std::vector<uint8_t>& node_values) {
+    ensure_levelized();
+    const size_t offset = golden_bits_.size();
+    golden_bits_.resize(offset + golden_words_, 0);
+    const uint32_t n = std::min<size_t>(node_values.size(), levelized_.num_nodes);
+    for (uint32_t i = 0; i < n; i++) {
+        golden_bits_[offset + (i >> 6)] |= uint64_t(node_values[i] & 1) << (i & 63);
+    }
+    golden_cycles_++;
+}
+
+bool FaultInjector::set_golden_trace(const SimulationTrace& trace) {
+    clear_golden();
+    std::vector<uint8_t> values;
+    for (int cycle = 0; cycle < trace.num_cycles(); cycle++) {
+        if (!trace.values_at(cycle, values)) {
+            clear_golden();
+            return false;
+        }
+        record_golden_cycle(values);
+    }
+    return true;
+}
+
+void FaultInjector::clear_golden() {
+    golden_bits_.clear();
+    golden_cycles_ = 0;
+}
+
+void FaultInjector::mark_diff(uint32_t node, bool value) {
+    diff_stamp_[node] = stamp_;
+    diff_value_[node] = value;
+    touched_.push_back(node);
+    for (uint32_t i = fanout_begin_[node]; i < fanout_begin_[node + 1]; i++) {
+        const uint32_t g = fanout_gates_[i];
+        if (queued_stamp_[g] != stamp_) {
+            queued_stamp_[g] = stamp_;
+            level_queue_[levelized_.level[levelized_.gates[g]]].push_back(g);
+        }
+    }
+}
+
+// 从 seeds (节点, 故障值) 出发按层级传播；固定值节点不重新求值
+void FaultInjector::propagate_cycle(int cycle, const std::vector<std::pair<uint32_t, bool>>& seeds) {
+    if (++stamp_ == 0) {
+        std::fill(diff_stamp_.begin(), diff_stamp_.end(), 0);
+        std::fill(queued_stamp_.begin(), queued_stamp_.end(), 0);
+        stamp_ = 1;
+    }
+    touched_.clear();
+    
+    for (const auto& [node, value] : seeds) {
+        if (stuck_[node] >= 0 && value != (bool)stuck_[node]) continue;   // 固定值优先于锁存值
+        if (value != golden_value(node, cycle) && diff_stamp_[node] != stamp_) mark_diff(node, value);
+    }
+    for (uint32_t level = 0; level < level_queue_.size(); level++) {
+        auto& queue = level_queue_[level];
+        for (size_t i = 0; i < queue.size(); i++) {
+            const uint32_t g = queue[i];
+            const uint32_t node = levelized_.gates[g];
+            if (stuck_[node] >= 0) continue;
+            evaluated_gates_++;
+            const bool value = faulty_literal(levelized_.fanin0[g], cycle) & faulty_literal(levelized_.fanin1[g], cycle);
+            if (value != golden_value(node, cycle)) mark_diff(node, value);
+        }
+        queue.clear();
+    }
+}
+
+std::vector<bool> FaultInjector::simulate_with_faults_differential(int cycle) {
+    auto outputs = simulate_sequence_differential(cycle, 1);
+    return outputs.empty() ? std::vector<bool>() : outputs.front();
+}
+
+std::vector<std::vector<bool>> FaultInjector::simulate_sequence_differential(int first_cycle, int num_cycles) {
+    std::vector<std::vector<bool>> outputs;
+    ensure_levelized();
+    evaluated_gates_ = 0;
+    if (first_cycle < 0 || first_cycle + num_cycles > golden_cycles_) {
+        std::cerr << "Error: golden trace covers " << golden_cycles_ << " cycles, requested "
+                  << first_cycle << ".." << first_cycle + num_cycles - 1 << std::endl;
+        return outputs;
+    }
+    
+    std::vector<std::pair<uint32_t, bool>> fault_seeds;
+    for (const auto& [node, value] : stuck_at_faults_) {
+        const uint32_t index = circuit_.node_to_index(node);
+        stuck_[index] = value;
+        fault_seeds.emplace_back(index, value);
+    }
+    
+    std::vector<std::pair<uint32_t, bool>> seeds;
+    std::vector<std::pair<uint32_t, bool>> latched;   // 下一周期寄存器输出的故障值
+    outputs.reserve(num_cycles);
+    for (int cycle = first_cycle; cycle < first_cycle + num_cycles; cycle++) {
+        seeds = fault_seeds;
+        seeds.insert(seeds.end(), latched.begin(), latched.end());
+        propagate_cycle(cycle, seeds);
+        
+        std::vector<bool> po_values;
+        po_values.reserve(levelized_.pos.size());
+        for (uint32_t lit : levelized_.pos) po_values.push_back(faulty_literal(lit, cycle));
+        outputs.push_back(std::move(po_values));
+        
+        // 只有出现差异的节点可能让寄存器锁存到不同的值
+        latched.clear();
+        if (cycle + 1 < first_cycle + num_cycles) {
+            for (uint32_t node : touched_) {
+                for (uint32_t i = ri_begin_[node]; i < ri_begin_[node + 1]; i++) {
+                    const uint32_t r = ri_of_node_[i];
+                    latched.emplace_back(levelized_.ros[r], faulty_literal(levelized_.ris[r], cycle));
+                }
+            }
+        }
+    }
+    
+    for (const auto& [index, value] : fault_seeds) stuck_[index] = -1;
+    return outputs;
+}
+
 void FaultInjector::compute_gate_output_with_values(
     mockturtle::aig_network::node node, 
     std::unordered_map<mockturtle::aig_network::node, bool>& values) {
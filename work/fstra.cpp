@@ -1,4 +1,5 @@
 #include "fstra.h"
+#include "fstra_kernels.h"
 #include <iostream>
 #include <algorithm>
 #include <omp.h>
@@ -16,7 +17,9 @@ std::ofstream dim_red_debug("dim_red_debug.txt");
 std::ofstream dim_red_progress("dim_red_progress.txt");
 
 FSTRAAnalyzer::FSTRAAnalyzer(mockturtle::aig_network& circuit, IverilogSimulator& sim, VCDParser& vcd_parser)
-    : circuit_(circuit), simulator_(sim), vcd_parser_(vcd_parser), faultRate_(0.01) ,nowCycle_(1){
+    : circuit_(circuit), simulator_(sim), vcd_parser_(vcd_parser), faultRate_(0.01) ,nowCycle_(1),
+      sparseMode_(false), sparseThreshold_(1e-6), sparseMinRows_(16),
+      statsWindowAverage_(true){
     initializeMffMatrix();
 }
 
@@ -291,7 +294,15 @@ void FSTRAAnalyzer::removeDuplicateElements(Eigen::MatrixXd& nodeIptM, std::vect
 
 
 
-    Eigen::MatrixXd com_iptM = Eigen::MatrixXd::Zero(new_rows, new_cols);
+    Eigen::MatrixXd com_iptM;
+    // 小规模 fsL 走编译期特化内核，否则回退到动态路径
+    if (fstra_kernels::combine(nodeIptM, nodeFsL, tmpM, tmpFsL, comFsL, com_iptM)) {
+        nodeFsL = std::move(comFsL);
+        nodeIptM = std::move(com_iptM);
+        return;
+    }
+
+    com_iptM = Eigen::MatrixXd::Zero(new_rows, new_cols);
     for (int binary_code = 0; binary_code < new_rows; binary_code++) {
         auto [binary1, binary2] = decomposeBinaryCode(binary_code, comFsL, nodeFsL, tmpFsL);
         
@@ -341,27 +352,41 @@ void FSTRAAnalyzer::del_rMr(const Eigen::MatrixXd& formoptM,const std::vector<in
 
     tmpM=Eigen::MatrixXd::Identity(1,1);
 
+    // 小规模 fsL 直接按行累加约简，避免构造 Kronecker 中间矩阵
+    std::vector<const Eigen::Vector2d*> opv;
+    opv.reserve(formFsL.size());
     for(auto en : formFsL){
+        bool removed = std::find(tb_rm_FsL.begin(), tb_rm_FsL.end(), en)!=tb_rm_FsL.end();
+        opv.push_back(removed ? &opVectors_[nowCycle_][en] : nullptr);
+    }
+    if(fstra_kernels::contract(formoptM, opv, tmpM)){
+        for(size_t i=0;i<formFsL.size();i++){
+            if(!opv[i]) tmpFsl.push_back(formFsL[i]);
+        }
+    }
+    else{
+        for(auto en : formFsL){
 
-        #ifdef DimensionReductionDebug
-            dim_red_progress << "=============================" << std::endl;
-            dim_red_progress << en << "  opV: "<<opVectors_[nowCycle_][en].transpose()<< std::endl;
-            dim_red_progress << "=============================" << std::endl;
-        #endif
+            #ifdef DimensionReductionDebug
+                dim_red_progress << "=============================" << std::endl;
+                dim_red_progress << en << "  opV: "<<opVectors_[nowCycle_][en].transpose()<< std::endl;
+                dim_red_progress << "=============================" << std::endl;
+            #endif
 
 
-        if(std::find(tb_rm_FsL.begin(), tb_rm_FsL.end(), en)!=tb_rm_FsL.end()){
-            Eigen::MatrixXd tmpM2=Eigen::kroneckerProduct(tmpM,opVectors_[nowCycle_][en].transpose());
-            tmpM=tmpM2;
-        }
-        else{
-            Eigen::MatrixXd tmpM2=Eigen::kroneckerProduct(tmpM, Eigen::Matrix2d::Identity());
-            tmpM=tmpM2;
-            tmpFsl.push_back(en);
+            if(std::find(tb_rm_FsL.begin(), tb_rm_FsL.end(), en)!=tb_rm_FsL.end()){
+                Eigen::MatrixXd tmpM2=Eigen::kroneckerProduct(tmpM,opVectors_[nowCycle_][en].transpose());
+                tmpM=tmpM2;
+            }
+            else{
+                Eigen::MatrixXd tmpM2=Eigen::kroneckerProduct(tmpM, Eigen::Matrix2d::Identity());
+                tmpM=tmpM2;
+                tmpFsl.push_back(en);
+            }
         }
-    }
 
-    tmpM=tmpM*formoptM;
+        tmpM=tmpM*formoptM;
+    }
 
     #ifdef DimensionReductionDebug
             dim_red_progress << "=============================" << std::endl;
@@ -381,6 +406,132 @@ void FSTRAAnalyzer::del_rMr(const Eigen::MatrixXd& formoptM,const std::vector<in
 
 }
 
+void FSTRAAnalyzer::del_rMrSparse(const Eigen::SparseMatrix<double, Eigen::RowMajor>& formoptM, bool swap_cols,
+                                  const std::vector<int>& formFsL, const std::vector<int>& tb_rm_FsL,
+                                  Eigen::MatrixXd& tmpM, std::vector<int>& tmpFsl){
+    // 与 del_rMr 等价，但只遍历稀疏 optM 的非零元素
+    const int n = formFsL.size();
+    std::vector<const Eigen::Vector2d*> opv(n, nullptr);
+    std::vector<int> keepMul(n, 0);
+
+    int kept = 0;
+    for(int i=0;i<n;i++){
+        if(std::find(tb_rm_FsL.begin(), tb_rm_FsL.end(), formFsL[i])!=tb_rm_FsL.end()){
+            opv[i] = &opVectors_[nowCycle_][formFsL[i]];
+        } else {
+            kept++;
+        }
+    }
+    int k = kept;
+    for(int i=0;i<n;i++){
+        if(!opv[i]){
+            keepMul[i] = 1 << (--k);
+            tmpFsl.push_back(formFsL[i]);
+        }
+    }
+
+    tmpM = Eigen::MatrixXd::Zero(1 << kept, formoptM.cols());
+    for(Eigen::Index r=0; r<formoptM.outerSize(); ++r){
+        int keptCode = 0;
+        double w = 1.0;
+        for(int i=0;i<n;i++){
+            int bit = (r >> (n-1-i)) & 1;
+            if(opv[i]) w *= (*opv[i])(bit);
+            else keptCode += bit * keepMul[i];
+        }
+        if(w == 0.0) continue;
+
+        for(Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(formoptM, r); it; ++it){
+            Eigen::Index c = swap_cols ? (formoptM.cols() - 1 - it.col()) : it.col();
+            tmpM(keptCode, c) += w * it.value();
+        }
+    }
+}
+
+bool FSTRAAnalyzer::buildSparseOptM(FSNode& fsnode, const std::vector<std::vector<int>>& faninFsL,
+                                    const std::vector<Eigen::MatrixXd>& faninM){
+    if(!sparseMode_) return false;
+
+    // 合并后的 fsL 与 removeDuplicateElements 相同：按扇入顺序去重，保留首次出现
+    std::vector<int> comFsL;
+    std::unordered_set<int> seen;
+    for(const auto& fsL : faninFsL){
+        for(int v : fsL){
+            if(seen.insert(v).second) comFsL.push_back(v);
+        }
+    }
+    const int n = comFsL.size();
+    const Eigen::Index rows = Eigen::Index(1) << n;
+    if(rows < sparseMinRows_) return false;
+
+    // 扇入 f 的编码由合并编码的若干位组成 (MSB 在前)：shifts[f] 为 (合并编码中的位, 扇入编码中的位)
+    std::vector<std::vector<std::pair<int, int>>> shifts(faninFsL.size());
+    Eigen::Index cols = 1;
+    for(size_t f=0; f<faninFsL.size(); ++f){
+        const int m = faninFsL[f].size();
+        for(int i=0;i<m;i++){
+            int pos = std::find(comFsL.begin(), comFsL.end(), faninFsL[f][i]) - comFsL.begin();
+            shifts[f].emplace_back(n-1-pos, m-1-i);
+        }
+        cols *= faninM[f].cols();
+    }
+
+    // 逐行求 iptM 的一行 (各扇入行的 Kronecker 积) 并立即乘 ptm，稠密的 iptM 和 optM 都不构造
+    std::vector<Eigen::Triplet<double>> triplets;
+    Eigen::RowVectorXd iptRow(cols), next(cols), optRow(fsnode.ptm.cols());
+    for(Eigen::Index r=0; r<rows; ++r){
+        Eigen::Index len = 1;
+        iptRow(0) = 1.0;
+        for(size_t f=0; f<faninM.size(); ++f){
+            Eigen::Index code = 0;
+            for(const auto& [from, to] : shifts[f]) code |= ((r >> from) & 1) << to;
+            const Eigen::Index fc = faninM[f].cols();
+            for(Eigen::Index a=0; a<len; ++a){
+                for(Eigen::Index b=0; b<fc; ++b) next(a*fc + b) = iptRow(a) * faninM[f](code, b);
+            }
+            len *= fc;
+            iptRow.swap(next);
+        }
+        optRow.noalias() = iptRow * fsnode.ptm;
+
+        for(Eigen::Index c=0; c<optRow.size(); ++c){
+            double v = optRow(c);
+            if(std::abs(v) >= sparseThreshold_) triplets.emplace_back(r, c, v);
+        }
+    }
+
+    fsnode.sparseOptM.resize(rows, optRow.size());
+    fsnode.sparseOptM.setFromTriplets(triplets.begin(), triplets.end());
+    fsnode.sparseOptM.makeCompressed();
+    fsnode.optMIsSparse = true;
+    fsnode.fsL = std::move(comFsL);
+
+    fsnode.optM.resize(0, 0);
+    fsnode.iptM.resize(0, 0);
+    return true;
+}
+
+void FSTRAAnalyzer::recordSparseErrorBound(const FSNode& father, int po_index){
+    if(!sparseMode_) return;
+    // optM 各行原本是概率分布，约简后缺失的质量即为丢弃误差的上界
+    double bound = std::max(0.0, 1.0 - father.REoptM.sum());
+    sparseErrorBound_[nowCycle_][po_index] = bound;
+    rel << "Cycle " << nowCycle_ << ", PO " << po_index 
+        << ", Sparse error bound: " << bound << std::endl;
+}
+
+double FSTRAAnalyzer::getSparseErrorBound(int cycle, int po_index) const {
+    if(cycle < 0 || cycle >= (int)sparseErrorBound_.size()) return 0.0;
+    if(po_index < 0 || po_index >= (int)sparseErrorBound_[cycle].size()) return 0.0;
+    return sparseErrorBound_[cycle][po_index];
+}
+
+double FSTRAAnalyzer::getReliability(int cycle, int po_index) const {
+    if(cycle < 0 || cycle >= (int)poReliability_.size()) return 0.0;
+    if(po_index < 0 || po_index >= (int)poReliability_[cycle].size()) return 0.0;
+    return poReliability_[cycle][po_index];
+}
+
 void FSTRAAnalyzer::generateTbRmFsL(std::vector<int>& tmpFsL, std::vector<int>& tb_rm_FsL,int Mn_fs){
     // 去重，保留首次出现
     std::unordered_set<int> seen;
@@ -450,6 +601,8 @@ void FSTRAAnalyzer::fsTracking(FSNode& fsnode) {
     // 初始化
     fsnode.fsL.clear();
     fsnode.iptM = Eigen::MatrixXd::Identity(1, 1);
+    fsnode.optMIsSparse = false;
+    fsnode.sparseOptM.resize(0, 0);
 
     auto node = circuit_.index_to_node(fsnode.index);
 
@@ -541,6 +694,8 @@ void FSTRAAnalyzer::DimensionReduction(FSNode& fsnode,int Mn_fs){
 
     fsnode.fsL.clear();
     fsnode.iptM = Eigen::MatrixXd::Identity(1, 1);
+    fsnode.optMIsSparse = false;
+    fsnode.sparseOptM.resize(0, 0);
     std::vector<int> tmpFsl,tb_rm_fsl,updated_fsl;
     tmpFsl.clear();
     tb_rm_fsl.clear();
@@ -671,6 +826,8 @@ void FSTRAAnalyzer::DimensionReductionByCycle(FSNode& fsnode,int Mn_fs){
 
     fsnode.fsL.clear();
     fsnode.iptM = Eigen::MatrixXd::Identity(1, 1);
+    fsnode.optMIsSparse = false;
+    fsnode.sparseOptM.resize(0, 0);
     std::vector<int> tmpFsl,tb_rm_fsl,updated_fsl;
     tmpFsl.clear();
     tb_rm_fsl.clear();
@@ -738,6 +895,10 @@ void FSTRAAnalyzer::DimensionReductionByCycle(FSNode& fsnode,int Mn_fs){
     
     updated_fsl = remove_elements_from_vector(tmpFsl, tb_rm_fsl);
     
+    // 各扇入约去 tb_rm_fsl 后的矩阵，合并成 iptM (稀疏模式下直接合并成稀疏的 optM)
+    std::vector<std::vector<int>> faninFsL;
+    std::vector<Eigen::MatrixXd> faninM;
+
     circuit_.foreach_fanin(node,[&](auto signal) {
         auto fanin_node = circuit_.get_node(signal);
         int fanin_index = circuit_.node_to_index(fanin_node);
@@ -753,7 +914,9 @@ void FSTRAAnalyzer::DimensionReductionByCycle(FSNode& fsnode,int Mn_fs){
             dim_red_debug << "=============================" << std::endl;
         #endif
 
-        if (!father.hasFanoutBranch) {
+        if (!father.hasFanoutBranch && father.optMIsSparse) {
+            del_rMrSparse(father.sparseOptM, circuit_.is_complemented(signal), father.fsL, tb_rm_fsl, tmpM_for, tmpFsl_for);
+        } else if (!father.hasFanoutBranch) {
             if(circuit_.is_complemented(signal)){
                 Eigen::MatrixXd father_optM=father.optM;
                 father_optM.col(0).swap(father_optM.col(1));
@@ -772,10 +935,22 @@ void FSTRAAnalyzer::DimensionReductionByCycle(FSNode& fsnode,int Mn_fs){
             }
         }
 
-        removeDuplicateElements(fsnode.iptM, fsnode.fsL,tmpFsl_for,tmpM_for);
+        faninFsL.push_back(std::move(tmpFsl_for));
+        faninM.push_back(std::move(tmpM_for));
 
     });
 
+    if(buildSparseOptM(fsnode, faninFsL, faninM)){
+        #ifdef DimensionReductionDebug
+            dim_red_debug << "fsnode index: "<<fsnode.index << ", sparse optM nnz: "<<fsnode.sparseOptM.nonZeros()
+                          << std::endl;
+        #endif
+        return;
+    }
+
+    for(size_t f=0; f<faninM.size(); ++f){
+        removeDuplicateElements(fsnode.iptM, fsnode.fsL, faninFsL[f], faninM[f]);
+    }
     fsnode.optM = fsnode.iptM * fsnode.ptm;
 
     // //输出是否取反
@@ -796,7 +971,6 @@ void FSTRAAnalyzer::DimensionReductionByCycle(FSNode& fsnode,int Mn_fs){
         dim_red_debug << "Dimension Reduction finish on node "<<fsnode.index << std::endl;
         dim_red_debug << "=============================" << std::endl;
     #endif
-
 }
 
 
@@ -825,11 +999,14 @@ void FSTRAAnalyzer::iterativeReduction(std::vector<int> nodefsL, Eigen::MatrixXd
                 t.push_back(*it);
                 removeDuplicateElements(redM, tmp_fsL, t, Eigen::MatrixXd::Identity(2, 2));
             }
+            else if(lsNode.optMIsSparse){
+                removeDuplicateElements(redM, tmp_fsL, lsNode.fsL, Eigen::MatrixXd(lsNode.sparseOptM));
+            }
             else{
                 removeDuplicateElements(redM, tmp_fsL, lsNode.fsL,lsNode.optM);
             }
         }
-        if(com_redM==Eigen::MatrixXd::Identity(1, 1)) com_redM=redM;
+        if(com_redM.size()==1 && com_redM(0,0)==1.0) com_redM=redM;
         else com_redM = redM * com_redM;
 
         #ifdef ITERDEBUG
@@ -915,6 +1092,9 @@ void FSTRAAnalyzer::ProgramIterativeReduction(FSNode& fsnode, Eigen::MatrixXd& n
                 t.push_back(*it);
                 del_rMr(Eigen::Matrix2d::Identity(), t, tb_rm_fsL, tmpM_for, tmp_fsL_for);
             }
+            else if(lsNode.optMIsSparse){
+                del_rMrSparse(lsNode.sparseOptM, false, lsNode.fsL, tb_rm_fsL, tmpM_for, tmp_fsL_for);
+            }
             else{
                 del_rMr(lsNode.optM, lsNode.fsL, tb_rm_fsL, tmpM_for, tmp_fsL_for);
             }
@@ -929,7 +1109,7 @@ void FSTRAAnalyzer::ProgramIterativeReduction(FSNode& fsnode, Eigen::MatrixXd& n
         #endif
 
 
-        if(com_redM==Eigen::MatrixXd::Identity(1, 1)) com_redM=redM;
+        if(com_redM.size()==1 && com_redM(0,0)==1.0) com_redM=redM;
         else com_redM = redM * com_redM;
 
         #ifdef progressDebug
@@ -954,7 +1134,8 @@ void FSTRAAnalyzer::ProgramIterativeReduction(FSNode& fsnode, Eigen::MatrixXd& n
     #endif
 
 
-    fsnode.REoptM = com_redM * fsnode.optM;
+    if(fsnode.optMIsSparse) fsnode.REoptM = com_redM * fsnode.sparseOptM;
+    else fsnode.REoptM = com_redM * fsnode.optM;
 
     #ifdef progressDebug
         dim_red_progress << "=============================" << std::endl;
@@ -981,7 +1162,7 @@ void FSTRAAnalyzer::iterativeReductionParallel(std::vector<int> nodefsL,
         {
             FSNode& lsNode = allFsNodes_[cycle][max_index];
             ls_fsL = lsNode.fsL;
-            ls_optM = lsNode.optM;
+            ls_optM = lsNode.optMIsSparse ? Eigen::MatrixXd(lsNode.sparseOptM) : lsNode.optM;
         }
         
         #ifdef ITERDEBUG
@@ -1006,7 +1187,7 @@ void FSTRAAnalyzer::iterativeReductionParallel(std::vector<int> nodefsL,
             }
         }
         
-        if(com_redM == Eigen::MatrixXd::Identity(1, 1)) {
+        if(com_redM.size()==1 && com_redM(0,0)==1.0) {
             com_redM = redM;
         } else {
             com_redM = redM * com_redM;
@@ -1108,6 +1289,7 @@ void FSTRAAnalyzer::runIterativeReduction() {
             iter_debug << "=============================" << std::endl;
         #endif
         
+        if(father.optMIsSparse) father.optM = father.sparseOptM;  // 不降维，稀疏化节点转回稠密矩阵
         iterativeReduction(father.fsL, father.optM);
 
         #ifdef ITERDEBUG
@@ -1118,7 +1300,7 @@ void FSTRAAnalyzer::runIterativeReduction() {
 
     
         std::vector<double> prob_0, prob_1;
-        if (vcd_parser_.getPOOutputFromWaveform(processed_count, nowCycle_, prob_0, prob_1)) {
+        if (idealPOOutput(processed_count, nowCycle_, prob_0, prob_1)) {
 
             Eigen::VectorXd oIV(2);
             oIV(0) = prob_0.back();
@@ -1175,12 +1357,14 @@ void FSTRAAnalyzer::runIterativeReductionParallel(int cycle) {
             processed_count,
             circuit_.is_complemented(signal),
             father.fsL,
-            father.optM
+            father.optMIsSparse ? Eigen::MatrixXd(father.sparseOptM) : father.optM
         });
         processed_count++;
     });
     
     
+    const VCDQuerySnapshot* wave = goldenTrace_ ? nullptr : waveformSnapshot();
+    
     // #pragma omp parallel for schedule(dynamic)
     for (size_t i = 0; i < po_data_list.size(); i++) {
         auto& po_data = po_data_list[i];
@@ -1208,7 +1392,8 @@ void FSTRAAnalyzer::runIterativeReductionParallel(int cycle) {
         
         // 获取波形数据并计算可靠性
         std::vector<double> prob_0, prob_1;
-        if (vcd_parser_.getPOOutputFromWaveform(po_data.sequential_index, cycle, prob_0, prob_1)) {
+        if (goldenTrace_ ? goldenTrace_->getPOOutput(po_data.sequential_index, cycle, prob_0, prob_1)
+                         : (wave && wave->getPOOutput(po_data.sequential_index, cycle, prob_0, prob_1))) {
             Eigen::VectorXd oIV(2);
             oIV(0) = prob_0.back();
             oIV(1) = prob_1.back();
@@ -1285,6 +1470,8 @@ void FSTRAAnalyzer::runParallelReliabilityCalculation(const std::vector<int>& ve
     //     runIterativeReductionParallel(i);
     // }
     
+    const VCDQuerySnapshot* wave = goldenTrace_ ? nullptr : waveformSnapshot();
+    
     #pragma omp parallel for schedule(dynamic)
 for (int i = 1; i <= k; i++) {
     int cycle = i;
@@ -1307,10 +1494,12 @@ for (int i = 1; i <= k; i++) {
         int po_index = circuit_.node_to_index(po_node);
         FSNode& father = allFsNodes_[cycle][po_index];
         
+        if(father.optMIsSparse) father.optM = father.sparseOptM;  // 不降维，稀疏化节点转回稠密矩阵
         iterativeReduction(father.fsL, father.optM);
         
         std::vector<double> prob_0, prob_1;
-        if (vcd_parser_.getPOOutputFromWaveform(processed_count, cycle, prob_0, prob_1)) {
+        if (goldenTrace_ ? goldenTrace_->getPOOutput(processed_count, cycle, prob_0, prob_1)
+                         : (wave && wave->getPOOutput(processed_count, cycle, prob_0, prob_1))) {
             Eigen::VectorXd oIV(2);
             oIV(0) = prob_0.back();
             oIV(1) = prob_1.back();
@@ -1381,7 +1570,7 @@ void FSTRAAnalyzer::FS_TRAMethod(int cycle, int Mn_fs){
 
         
             std::vector<double> prob_0, prob_1;
-            if (vcd_parser_.getPOOutputFromWaveform(processed_count, nowCycle_, prob_0, prob_1)) {
+            if (idealPOOutput(processed_count, nowCycle_, prob_0, prob_1)) {
 
                 Eigen::VectorXd oIV(2);
                 oIV(0) = prob_0.back();
@@ -1425,6 +1614,9 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
     
     getopVectors(cycle);
 
+    sparseErrorBound_.assign(cycle + 2, std::vector<double>(circuit_.num_pos(), 0.0));
+    poReliability_.assign(cycle + 2, std::vector<double>(circuit_.num_pos(), 0.0));
+
     for(int j=1; j <= cycle; ++j) {
 
         nowCycle_ = j;
@@ -1448,7 +1640,12 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
             if (!circuit_.is_pi(node) && !circuit_.is_constant(node) && !circuit_.is_ro(node)) {
                 std::cout << "=============================" << std::endl;
                 std::cout << "Cycle " << nowCycle_ << ", node index " << index << std::endl;
-                std::cout << "Before Reduction - optM: " << fsnode.optM << std::endl;
+                if (fsnode.optMIsSparse) {
+                    std::cout << "Before Reduction - optM: sparse, " << fsnode.sparseOptM.rows() << "x"
+                              << fsnode.sparseOptM.cols() << ", nnz " << fsnode.sparseOptM.nonZeros() << std::endl;
+                } else {
+                    std::cout << "Before Reduction - optM: " << fsnode.optM << std::endl;
+                }
                 std::cout << "Before Reduction - fsL elements: ";
                 for (const auto& val : fsnode.fsL) {    
                     std::cout << val << " ";
@@ -1499,7 +1696,7 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
                 }
                 else{                                  //主输出
                     std::vector<double> prob_0, prob_1;
-                    if (vcd_parser_.getPOOutputFromWaveform(index, nowCycle_, prob_0, prob_1)) {
+                    if (idealPOOutput(index, nowCycle_, prob_0, prob_1)) {
                     
                         Eigen::VectorXd oIV(2);
                         oIV(0) = prob_0.back();
@@ -1507,8 +1704,11 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
                     
                         double reliability = calculateOutputReliability(father.REoptM, oIV, circuit_.is_complemented(signal));
                         co_reliability[co_index] = reliability; // 缓存结果
+                        poReliability_[nowCycle_][index] = reliability;
                         rel << "Cycle " << nowCycle_ << ", PO " << index 
                             << ", Reliability: " << reliability << std::endl;
+
+                        recordSparseErrorBound(father, index);
                         
                     }
                 }
@@ -1529,7 +1729,7 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
                 }
                 else{
                     std::vector<double> prob_0, prob_1;
-                    if (vcd_parser_.getPOOutputFromWaveform(index, nowCycle_, prob_0, prob_1)) {
+                    if (idealPOOutput(index, nowCycle_, prob_0, prob_1)) {
                     
                         Eigen::VectorXd oIV(2);
                         oIV(0) = prob_0.back();
@@ -1537,8 +1737,11 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
                     
                         double reliability = calculateOutputReliability(father.REoptM, oIV,circuit_.is_complemented(signal));
                         co_reliability[co_index] = reliability; // 缓存结果
+                        poReliability_[nowCycle_][index] = reliability;
                         rel << "Cycle " << nowCycle_ << ", PO " << index 
                             << ", Reliability: " << reliability << std::endl;
+
+                        recordSparseErrorBound(father, index);
                         
                     }
                 }
@@ -1549,6 +1752,150 @@ void FSTRAAnalyzer::FS_TRAMethodByCycle(int cycle, int Mn_fs){
 
 }
 
+void FSTRAAnalyzer::buildCycleTensorNetwork(TensorNetwork& tn, int cycle, const std::vector<Eigen::Vector2d>& roDist){
+    tn.clear();
+
+    circuit_.foreach_node([&](auto node) {
+        int idx = circuit_.node_to_index(node);
+        const FSNode& fsnode = allFsNodes_[cycle][idx];
+
+        if (circuit_.is_constant(node)) {
+            tn.addFactor({idx}, {1.0, 0.0}, idx);
+            return;
+        }
+
+        if (circuit_.is_ro(node)) {
+            tn.addFactor({idx}, {roDist[idx](0), roDist[idx](1)}, idx);
+        } else if (circuit_.is_pi(node)) {
+            if (fsnode.optM.rows() == 1 && fsnode.optM.cols() == 2) {
+                tn.addFactor({idx}, {fsnode.optM(0, 0), fsnode.optM(0, 1)}, idx);
+            } else {
+                tn.addFactor({idx}, {1.0, 0.0}, idx);
+            }
+        } else {
+            // 门因子 T(fanin..., out) = ptm(row, out)，row 中 fanin_0 为最高位，
+            // 与 DimensionReductionByCycle 中 iptM 的 Kronecker 顺序一致；取反的扇入先翻转取值
+            std::vector<int> fanins;
+            std::vector<int> comps;
+            circuit_.foreach_fanin(node, [&](auto signal) {
+                fanins.push_back(circuit_.node_to_index(circuit_.get_node(signal)));
+                comps.push_back(circuit_.is_complemented(signal) ? 1 : 0);
+            });
+            const int k = fanins.size();
+
+            std::vector<int> scope;
+            for (int f : fanins) {
+                if (std::find(scope.begin(), scope.end(), f) == scope.end()) scope.push_back(f);
+            }
+            scope.push_back(idx);
+            const int s = scope.size();
+
+            std::vector<int> faninPos(k);
+            for (int i = 0; i < k; ++i) {
+                faninPos[i] = std::find(scope.begin(), scope.end(), fanins[i]) - scope.begin();
+            }
+
+            std::vector<double> table(size_t(1) << s);
+            for (size_t code = 0; code < table.size(); ++code) {
+                int row = 0;
+                for (int i = 0; i < k; ++i) {
+                    int bit = (code >> (s - 1 - faninPos[i])) & 1;
+                    row |= (bit ^ comps[i]) << (k - 1 - i);
+                }
+                table[code] = fsnode.ptm(row, code & 1);
+            }
+            tn.addFactor(scope, table, idx);
+        }
+
+        // 近似模式的先验与 FSTRA 约去扇出源时使用的 opVectors 相同
+        const Eigen::Vector2d& op = opVectors_[cycle][idx];
+        if (op.allFinite() && op.minCoeff() >= 0.0 && std::abs(op.sum() - 1.0) < 1e-6) {
+            tn.setCutPrior(idx, op);
+        }
+    });
+}
+
+bool FSTRAAnalyzer::TensorNetworkMethodByCycle(int cycle, int max_width, TensorNetwork::OrderHeuristic heuristic){
+
+    getopVectors(cycle);
+
+    tnReliability_.assign(cycle + 2, std::vector<double>(circuit_.num_pos(), 0.0));
+
+    // 寄存器初值取第 1 周期的 optM，之后由上一周期寄存器输入的边缘分布给出
+    std::vector<Eigen::Vector2d> roDist(circuit_.size(), Eigen::Vector2d(1.0, 0.0));
+    circuit_.foreach_ro([&](auto node) {
+        int idx = circuit_.node_to_index(node);
+        const Eigen::MatrixXd& optM = allFsNodes_[1][idx].optM;
+        if (optM.rows() == 1 && optM.cols() == 2) {
+            roDist[idx] = optM.row(0).transpose();
+        }
+    });
+
+    TensorNetwork tn;
+    tn.setMaxWidth(max_width);
+    tn.setOrderHeuristic(heuristic);
+
+    for (int j = 1; j <= cycle; ++j) {
+
+        buildCycleTensorNetwork(tn, j, roDist);
+
+        std::vector<Eigen::Vector2d> nextRoDist = roDist;
+        std::unordered_map<int, Eigen::Vector2d> co_marginal;
+        bool failed = false;
+
+        circuit_.foreach_co([&](auto signal, auto index) {
+            if (failed) return;
+            int co_index = circuit_.node_to_index(circuit_.get_node(signal));
+
+            auto it = co_marginal.find(co_index);
+            if (it == co_marginal.end()) {
+                Eigen::Vector2d m;
+                if (!tn.marginal(co_index, m)) {
+                    std::cerr << "Tensor network contraction failed on node " << co_index
+                              << " in cycle " << j << " (max width " << max_width << ")" << std::endl;
+                    failed = true;
+                    return;
+                }
+                it = co_marginal.emplace(co_index, m).first;
+
+                const auto& st = tn.lastStats();
+                rel << "Cycle " << j << ", TN node " << co_index << ", width: " << st.width
+                    << ", cuts: " << st.cuts << ", flops: " << st.flops << std::endl;
+            }
+
+            Eigen::Vector2d m = it->second;
+            if (index >= circuit_.num_cos() - circuit_.num_latches()) {   //是寄存器输出
+                int ro_index = circuit_.node_to_index(circuit_.ri_to_ro(signal));
+                if (circuit_.is_complemented(signal)) std::swap(m(0), m(1));
+                nextRoDist[ro_index] = m;
+            } else {                                                    //主输出
+                std::vector<double> prob_0, prob_1;
+                if (idealPOOutput(index, j, prob_0, prob_1)) {
+                    Eigen::VectorXd oIV(2);
+                    oIV(0) = prob_0.back();
+                    oIV(1) = prob_1.back();
+
+                    double reliability = calculateOutputReliability(Eigen::MatrixXd(m.transpose()), oIV,
+                                                                    circuit_.is_complemented(signal));
+                    tnReliability_[j][index] = reliability;
+                    rel << "Cycle " << j << ", PO " << index
+                        << ", TN Reliability: " << reliability << std::endl;
+                }
+            }
+        });
+
+        if (failed) return false;
+        roDist = std::move(nextRoDist);
+    }
+    return true;
+}
+
+double FSTRAAnalyzer::getTensorNetworkReliability(int cycle, int po_index) const {
+    if(cycle < 0 || cycle >= (int)tnReliability_.size()) return 0.0;
+    if(po_index < 0 || po_index >= (int)tnReliability_[cycle].size()) return 0.0;
+    return tnReliability_[cycle][po_index];
+}
+
 std::vector<std::reference_wrapper<FSTRAAnalyzer::FSNode>> FSTRAAnalyzer::getPrimaryInputs() {
     std::vector<std::reference_wrapper<FSNode>> inputs;
     
@@ -1591,25 +1938,67 @@ void FSTRAAnalyzer::printFSNodeInfo(int index) const {
     std::cout << "ptm size: " << node.ptm.rows() << "x" << node.ptm.cols() << std::endl;
 }
 
+// 冻结 VCD 解析结果；必须在并行区域之外调用，之后各线程只做 const 查询
+const VCDQuerySnapshot* FSTRAAnalyzer::waveformSnapshot() {
+    if (!waveform_) {
+        waveform_ = vcd_parser_.freeze(circuit_.num_pos());
+    }
+    return waveform_.get();
+}
+
+// 理想 PO 输出：设置了内置仿真结果时直接查询，否则从 VCD 波形采样
+bool FSTRAAnalyzer::idealPOOutput(int po_index, int cycle, std::vector<double>& prob_0, std::vector<double>& prob_1) {
+    if (goldenTrace_) {
+        return goldenTrace_->getPOOutput(po_index, cycle, prob_0, prob_1);
+    }
+    return vcd_parser_.getPOOutputFromWaveform(po_index, cycle, prob_0, prob_1);
+}
+
 void FSTRAAnalyzer::getopVectors(int cycle) {
 
+    if (goldenTrace_) {
+        // 内置仿真：与 VCD 中的 signal_N 相同，只覆盖与门节点，P(1) 为取 1 的通道比例
+        const GoldenTrace& trace = *goldenTrace_;
+        for (int i = 1; i <= cycle && trace.hasCycle(i); ++i) {
+            circuit_.foreach_gate([&](auto node) {
+                int index = circuit_.node_to_index(node);
+                double p0, p1;
+                if (index < (int)opVectors_[i].size() && trace.getNodeOutputByIndex(index, i, p0, p1)) {
+                    opVectors_[i][index] = Eigen::Vector2d(p0, p1);
+                }
+            });
+        }
+        return;
+    }
 
-    for (int i = 1; i <= cycle; ++i) {
+    if (signalStats_) {
+        // 统计先验：列下标直接由节点号得到，P(1) 为窗口平均或该周期的采样
+        const VCDSignalStatistics& stats = *signalStats_;
+        for (int i = 1; i <= cycle && i <= stats.num_cycles; ++i) {
+            const int n = std::min<int>(opVectors_[i].size(), stats.node_column.size());
+            for (int index = 0; index < n; ++index) {
+                double p1;
+                if (stats.probability(stats.node_column[index], i, statsWindowAverage_, p1)) {
+                    opVectors_[i][index] = Eigen::Vector2d(1.0 - p1, p1);
+                }
+            }
+        }
+        return;
+    }
 
-            std::unordered_map<std::string, std::pair<std::vector<double>, std::vector<double>>> all_outputs;
-            if (vcd_parser_.getAllNodeOutputsFromWaveform(i, all_outputs)) {
+    // 波形中 signal_N 对应网表节点 N，按节点号直接查询每个周期的采样值
+    const std::vector<int>& nodes = vcd_parser_.getIndexedNodes();
 
-                // 遍历所有节点
-                for (const auto& kv : all_outputs) {
-                    // std::cout << "Node: " << kv.first.c_str() << std::endl;
-                    std::string name = kv.first.c_str();
-                    const auto& probs = kv.second;
+    for (int i = 1; i <= cycle; ++i) {
+        for (int index : nodes) {
+            if (index >= (int)opVectors_[i].size()) break;
 
-                    int signal_index = extractSignalIndex(name);
-                    opVectors_[i][signal_index] = Eigen::Vector2d(probs.first.back(), probs.second.back());
-                    // std::cout<<"cycle: "<<i << "  prob: " << opVectors_[i][signal_index].transpose() << std::endl;
-                }
+            double p0, p1;
+            if (vcd_parser_.getNodeOutputByIndex(index, i, p0, p1)) {
+                opVectors_[i][index] = Eigen::Vector2d(p0, p1);
+                // std::cout<<"cycle: "<<i << "  prob: " << opVectors_[i][index].transpose() << std::endl;
             }
+        }
     }
 }
 
@@ -2,8 +2,15 @@
 #include <fstream>
 #include <string>
 #include <iomanip>
+#include <random>
+#include <sstream>
+#include <vector>
 #include "circuit_simulator.h"
 #include "fault_injector.h"
+#include "aig_bit_simulator.h"
+#include "fault_campaign.h"
+#include "fault_collapser.h"
+#include "seu_campaign.h"
 #include "fstra.h"
 #include "iverilog_simulator.h"
 #include "parse_verilog.h"
@@ -11,11 +18,41 @@
 #include <omp.h>
 
 void print_usage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " <circuit_file> [options]" << std::endl;
+    std::cout << "Usage: " << program_name << " [circuit_file] [options]" << std::endl;
     std::cout << "Options:" << std::endl;
-    std::cout << "  -fp <value>    Fault probability (default: 0.01)" << std::endl;
-    std::cout << "  -mc <count>    Monte Carlo iterations (default: 1000)" << std::endl;
-    std::cout << "  -h, --help     Show this help message" << std::endl;
+    std::cout << "  -fp <value>               Fault probability (default: 0.01)" << std::endl;
+    std::cout << "  --cycles <n>              Number of simulated cycles (default: 1 combinational, 5 sequential)" << std::endl;
+    std::cout << "  --iverilog                Run the iverilog/VCD flow and check the native simulation against it" << std::endl;
+    std::cout << "  --vcd-filter              Keep only the signals FS-TRA reads when parsing the VCD" << std::endl;
+    std::cout << "  --vcd-threads <n>         Parse long VCD files in n segments (0: one per core)" << std::endl;
+    std::cout << "  --vcd-cache               Write/load the binary waveform cache next to the VCD" << std::endl;
+    std::cout << "  --vcd-window <a> <b>      Load only cycles a..b using the .fwi index" << std::endl;
+    std::cout << "  --stats-window <cycles>   Use windowed VCD signal statistics as FS-TRA input priors" << std::endl;
+    std::cout << "  --stuck-at <patterns>     Stuck-at fault campaign with random patterns, report in stuck_at.txt" << std::endl;
+    std::cout << "  --collapse                Simulate only equivalence/dominance representatives in --stuck-at" << std::endl;
+    std::cout << "  --seu <c1,c2,...>         Single-cycle register flips at the given cycles, report in seu.txt" << std::endl;
+    std::cout << "  --seu-gates               Also flip every AND gate in --seu" << std::endl;
+    std::cout << "  --sparse <threshold>      Drop optM entries below threshold; error bounds go to rel.txt" << std::endl;
+    std::cout << "  --tn <max_width>          Also run tensor-network contraction (0: no width limit)" << std::endl;
+    std::cout << "  -h, --help                Show this help message" << std::endl;
+}
+
+// 逗号分隔的非负整数列表
+static bool parse_int_list(const std::string& text, std::vector<int>& values) {
+    std::stringstream ss(text);
+    std::string item;
+    values.clear();
+    while (std::getline(ss, item, ',')) {
+        try {
+            size_t used = 0;
+            int v = std::stoi(item, &used);
+            if (used != item.size() || v < 0) return false;
+            values.push_back(v);
+        } catch (...) {
+            return false;
+        }
+    }
+    return !values.empty();
 }
 
 
@@ -24,12 +61,118 @@ int main(int argc, char* argv[]) {
     // 默认参数
     std::string circuit_file;
     double fault_probability = 0.01;
-    int monte_carlo_iterations = 1000;
     int runCycles;
     std::vector<int> vec_int={0,0,0,0};
-    bool simOpen=true;
+    bool nativeSim=true;   // 内置位并行仿真产生 opVectors 与理想输出
+    bool simOpen=false;    // iverilog/VCD 流程，与内置仿真同时打开时作为对照
     bool computeOpen=true;
 
+    // 命令行选项
+    int cycleOverride=0;
+    bool vcdFilter=false;
+    int vcdThreads=-1;          // -1 表示保持 VCDParser 默认
+    bool vcdCache=false;
+    int vcdWindowFirst=0, vcdWindowLast=0;
+    int statsWindow=0;
+    long long stuckAtPatterns=0;
+    bool collapseFaults=false;
+    std::vector<int> seuCycles;
+    bool seuGates=false;
+    double sparseThreshold=0.0;
+    int tnMaxWidth=-1;          // -1 表示不运行张量网络缩并
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        // 取出选项后的 count 个参数，缺少时报错
+        auto values = [&](int count) -> bool {
+            if (i + count >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            return true;
+        };
+        try {
+            if (arg == "-h" || arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "-fp") {
+                if (!values(1)) return -1;
+                fault_probability = std::stod(argv[++i]);
+            } else if (arg == "--cycles") {
+                if (!values(1)) return -1;
+                cycleOverride = std::stoi(argv[++i]);
+            } else if (arg == "--iverilog") {
+                simOpen = true;
+            } else if (arg == "--vcd-filter") {
+                vcdFilter = true;
+            } else if (arg == "--vcd-threads") {
+                if (!values(1)) return -1;
+                vcdThreads = std::stoi(argv[++i]);
+            } else if (arg == "--vcd-cache") {
+                vcdCache = true;
+            } else if (arg == "--vcd-window") {
+                if (!values(2)) return -1;
+                vcdWindowFirst = std::stoi(argv[++i]);
+                vcdWindowLast = std::stoi(argv[++i]);
+            } else if (arg == "--stats-window") {
+                if (!values(1)) return -1;
+                statsWindow = std::stoi(argv[++i]);
+            } else if (arg == "--stuck-at") {
+                if (!values(1)) return -1;
+                stuckAtPatterns = std::stoll(argv[++i]);
+            } else if (arg == "--collapse") {
+                collapseFaults = true;
+            } else if (arg == "--seu") {
+                if (!values(1)) return -1;
+                if (!parse_int_list(argv[++i], seuCycles)) {
+                    std::cerr << "Invalid cycle list for --seu: " << argv[i] << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--seu-gates") {
+                seuGates = true;
+            } else if (arg == "--sparse") {
+                if (!values(1)) return -1;
+                sparseThreshold = std::stod(argv[++i]);
+            } else if (arg == "--tn") {
+                if (!values(1)) return -1;
+                tnMaxWidth = std::stoi(argv[++i]);
+            } else if (!arg.empty() && arg[0] != '-' && circuit_file.empty()) {
+                circuit_file = arg;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                print_usage(argv[0]);
+                return -1;
+            }
+        } catch (...) {
+            std::cerr << "Invalid value for " << arg << ": " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    if (fault_probability < 0.0 || fault_probability > 1.0 || cycleOverride < 0 || vcdWindowFirst < 0 ||
+        vcdWindowLast < vcdWindowFirst || statsWindow < 0 || stuckAtPatterns < 0 || sparseThreshold < 0.0 ||
+        tnMaxWidth < -1) {
+        std::cerr << "Option value out of range" << std::endl;
+        return -1;
+    }
+    if (!simOpen && (vcdFilter || vcdThreads >= 0 || vcdCache || vcdWindowLast > 0 || statsWindow > 0)) {
+        std::cerr << "VCD options require --iverilog" << std::endl;
+        return -1;
+    }
+    if (collapseFaults && stuckAtPatterns == 0) {
+        std::cerr << "--collapse requires --stuck-at" << std::endl;
+        return -1;
+    }
+    if (seuGates && seuCycles.empty()) {
+        std::cerr << "--seu-gates requires --seu" << std::endl;
+        return -1;
+    }
+    if (!seuCycles.empty() && simOpen) {
+        // SEU 注入使用内置仿真的随机激励；iverilog 流程的激励来自 testbench
+        std::cerr << "--seu cannot be combined with --iverilog" << std::endl;
+        return -1;
+    }
+
     omp_set_nested(1);  // 启用嵌套并行
     omp_set_max_active_levels(2);  // 允许2层嵌套
 
@@ -43,6 +186,7 @@ int main(int argc, char* argv[]) {
     std::string nameVerilog;
     std::string nameTb;
     std::string path;
+    std::string vcdFile="./sim_results/s382.vcd";
 
     ParseVerilog parser("./parse");
 
@@ -53,6 +197,8 @@ int main(int argc, char* argv[]) {
         nameblif=ISCAS85Name+".blif";
         nameVerilog=ISCAS85Name+"_aig.v";
         runCycles=1;
+        if(!circuit_file.empty()) path=circuit_file;
+        if(cycleOverride>0) runCycles=cycleOverride;
         if(!parser.read_circuit(path))return -1;
     }
     else{
@@ -61,10 +207,14 @@ int main(int argc, char* argv[]) {
         nameblif=ISCAS89Name+".blif";
         nameVerilog=ISCAS89Name+"_aig.v";
         runCycles=5;
+        if(!circuit_file.empty()) path=circuit_file;
+        if(cycleOverride>0) runCycles=cycleOverride;
         if(!parser.read_blifCircuit(path))return -1;
     }
 
-    parser.parse_verilog(nameblif,nameVerilog,!is_comb);
+    if(simOpen){
+        parser.parse_verilog(nameblif,nameVerilog,!is_comb);
+    }
 
 
 
@@ -105,7 +255,13 @@ int main(int argc, char* argv[]) {
         std::cout << "Simulation " << (result.success ? "succeeded" : "failed") << std::endl;
         std::cout << "Return code: " << result.return_code << std::endl;
 
-        if (!vcd_parser.parseFile("./sim_results/s382.vcd")) {
+        if (vcdFilter) vcd_parser.setSignalFilter(VCDParser::fstraSignalPatterns());  // 只保留 FSTRA 用到的信号
+        if (vcdThreads >= 0) vcd_parser.setParseThreads(vcdThreads);  // 长波形按时间戳分段并行解析
+        if (vcdCache) vcd_parser.setWaveformCache(true);  // 写入/装载 .fwc，VCD 未变化时跳过文本解析
+        bool parsed = vcdWindowLast > 0
+            ? vcd_parser.parseCycleWindow(vcdFile, "clock", vcdWindowFirst, vcdWindowLast)  // 借助 .fwi 索引只加载周期窗口
+            : vcd_parser.parseFile(vcdFile);
+        if (!parsed) {
                 std::cerr << "Failed to parse VCD file." << std::endl;
                 return -1;
         }
@@ -116,9 +272,65 @@ int main(int argc, char* argv[]) {
 
     // 解析 VCD 文件
     
+    LevelizedAIG levelized = LevelizedAIG::build(parser.get_circuit());
+    auto golden = std::make_shared<GoldenTrace>();
+    std::vector<std::vector<bool>> input_sequence;
+    if(nativeSim){
+        AigBitSimulator bit_sim(levelized, 64);
+        if(!is_comb) bit_sim.setClockInput(0);
+        if(simOpen){
+            // 使用 testbench 的激励，结果与 VCD 逐值对照
+            if(!bit_sim.loadStimulusFromWaveform(vcd_parser, runCycles)) return -1;
+        }
+        else{
+            // 一条随机激励广播到所有通道，理想输出为确定的 0/1 值
+            std::mt19937 gen(12345);
+            input_sequence.assign(runCycles, std::vector<bool>(levelized.pis.size()));
+            for (auto& row : input_sequence)
+                for (size_t i = 0; i < row.size(); ++i) row[i] = gen() & 1;
+            bit_sim.setStimulus(input_sequence);
+        }
+        if(!bit_sim.run(runCycles, *golden)){
+            std::cerr << "Native simulation failed." << std::endl;
+            return -1;
+        }
+        std::cout << "Native simulation: " << levelized.numGates() << " gates, depth " << levelized.depth
+                  << ", " << bit_sim.numLanes() << " lanes" << std::endl;
+        if(simOpen){
+            AigBitSimulator::compareWithWaveform(levelized, *golden, vcd_parser, runCycles);
+        }
+    }
+
+    if(stuckAtPatterns>0){
+        FaultCampaign campaign(levelized);  // 全部单固定型故障的 PPSFP 仿真，检出即丢弃
+        if(collapseFaults){
+            FaultCollapser collapser(levelized);  // 等价/支配压缩，只仿真代表故障
+            collapser.print_summary();
+            campaign.set_fault_list(collapser.representatives());
+            if(!campaign.run_random(stuckAtPatterns, 1)) return -1;
+            campaign.set_results(collapser.expand(campaign.get_results()));  // 展开回全部故障
+        }
+        else if(!campaign.run_random(stuckAtPatterns, 1)) return -1;
+        campaign.print_summary();
+        campaign.write_report("stuck_at.txt");
+    }
+
+    if(!seuCycles.empty()){
+        if(!nativeSim || input_sequence.empty()){
+            std::cerr << "--seu needs the native simulation stimulus" << std::endl;
+            return -1;
+        }
+        SEUCampaign seu(levelized);  // 寄存器/与门单周期翻转，状态恢复即停止
+        if(!seu.set_stimulus(input_sequence) || !seu.run_all(seuCycles, seuGates)) return -1;
+        seu.print_summary();
+        seu.write_report("seu.txt");
+    }
+
 
     if(computeOpen){
         FSTRAAnalyzer fs_tra_analyzer(parser.get_circuit(),sim,vcd_parser);
+        if(nativeSim) fs_tra_analyzer.setGoldenTrace(golden);
+        fs_tra_analyzer.setFaultRate(fault_probability);
 
         // 初始化 FS 节点
         fs_tra_analyzer.initializeFSNodes(runCycles);
@@ -126,7 +338,16 @@ int main(int argc, char* argv[]) {
         // fs_tra_analyzer.runParallelReliabilityCalculation(vec_int,runCycles);
 
         // fs_tra_analyzer.FS_TRAMethod(runCycles,5);
+        if(sparseThreshold>0.0) fs_tra_analyzer.setSparsification(true, sparseThreshold);  // 丢弃小于阈值的概率项，rel.txt 中输出误差上界
+        if(statsWindow>0){
+            // 按窗口平均 P(1) 作为 opVectors
+            auto stats = std::make_shared<VCDSignalStatistics>();
+            if(!VCDParser().computeSignalStatistics(vcdFile, "clock", statsWindow, *stats)) return -1;
+            fs_tra_analyzer.setSignalStatistics(stats);
+        }
         fs_tra_analyzer.FS_TRAMethodByCycle(runCycles,5);
+        // 张量网络缩并，结果与上面的 FS-TRA 对照
+        if(tnMaxWidth>=0 && !fs_tra_analyzer.TensorNetworkMethodByCycle(runCycles, tnMaxWidth)) return -1;
     }
 
     
@@ -5,16 +5,52 @@
 #include <iomanip>
 #include <algorithm>
 #include <queue>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
 MCFaultSimulator::MCFaultSimulator(CircuitReliabilitySimulator& simulator)
     : simulator_(simulator), 
-      rng_(std::random_device{}()),
-      dist_(0.0, 1.0) {
+      seed_(0),
+      scalar_trials_(0),
+      words_(1),
+      tolerance_(0.0),
+      time_budget_(0.0),
+      z_(1.96),
+      trials_run_(0) {
+}
+
+void MCFaultSimulator::set_adaptive_stopping(double tolerance, double time_budget_seconds, double z) {
+    tolerance_ = tolerance;
+    time_budget_ = time_budget_seconds;
+    z_ = z > 0.0 ? z : 1.96;
+}
+
+// 以 (failures + 1) / (trials + 2) 估计的 p(1-p)，避免 0 次失效时方差为 0
+double MCFaultSimulator::binomial_variance(long long failures, long long trials) {
+    const double p = (failures + 1.0) / (trials + 2.0);
+    return p * (1.0 - p);
+}
+
+// 置信区间半宽：批均值的 Welford 方差给出 z*s/sqrt(批数)；失效很少时批间方差不可靠，
+// 取与二项方差估计中的较大者
+double MCFaultSimulator::half_width(const RunningStat& stat, long long failures, long long trials) const {
+    if (trials <= 0) return std::numeric_limits<double>::infinity();
+    const double binomial = z_ * std::sqrt(binomial_variance(failures, trials) / trials);
+    if (stat.count < 2) return binomial;
+    return std::max(z_ * std::sqrt(stat.variance() / stat.count), binomial);
+}
+
+double MCFaultSimulator::max_half_width(const std::vector<RunningStat>& stats,
+                                        const std::vector<long long>& failures, long long trials) const {
+    double worst = 0.0;
+    for (size_t k = 0; k < stats.size(); k++) worst = std::max(worst, half_width(stats[k], failures[k], trials));
+    return worst;
 }
 
 std::vector<MCFaultSimulator::TrendProbability> 
 MCFaultSimulator::run_mc_simulations(
-    int n_sim,
+    long long n_sim,
     int k_cycles,
     const std::vector<std::vector<bool>>& input_sequence,
     double fault_prob,
@@ -22,71 +58,153 @@ MCFaultSimulator::run_mc_simulations(
     
     std::cout << "Algorithm 4: Running Monte Carlo fault injection simulations..." << std::endl;
     std::cout << "  n_sim = " << n_sim << ", k_cycles = " << k_cycles 
-              << ", fault_prob = " << fault_prob << std::endl;
+              << ", fault_prob = " << fault_prob << ", lanes = " << get_lanes() << std::endl;
     
     // 初始化统计数据结构
     statistics_.clear();
-    
-    // 创建故障注入器
-    FaultInjector fault_injector(simulator_.get_circuit());
-    
-    // 确定要统计的节点
-    std::vector<int> nodes_to_monitor = low_priority_nodes;
-    if (nodes_to_monitor.empty()) {
-        // 如果未指定，监控所有节点
-        // 这里需要从circuit_获取所有节点ID
-        // 简化处理：只监控一部分节点
-        // 实际应该遍历所有gate节点
+    po_statistics_.clear();
+    trials_run_ = 0;
+    if (n_sim <= 0 || k_cycles <= 0) {
+        return {};
     }
     
-    // 为每个要监控的节点初始化统计
-    for (int node_id : nodes_to_monitor) {
-        statistics_[node_id].resize(k_cycles);
-        for (int cycle = 0; cycle < k_cycles; cycle++) {
-            statistics_[node_id][cycle] = {cycle, node_id, 0, 0};
+    std::vector<bool> initial_state;
+    std::vector<uint8_t> golden_po;
+    const LevelizedAIG& aig = prepare_simulation(k_cycles, input_sequence, initial_state, golden_po);
+    
+    // 确定要统计的节点：未指定时统计所有与门
+    std::vector<uint32_t> monitored;
+    if (low_priority_nodes.empty()) {
+        monitored = aig.gates;
+        std::sort(monitored.begin(), monitored.end());
+    } else {
+        for (int node_id : low_priority_nodes) {
+            if (node_id >= 0 && node_id < (int)aig.num_nodes) monitored.push_back(node_id);
         }
     }
     
-    // 运行蒙特卡洛仿真
-    for (int sim_idx = 0; sim_idx < n_sim; sim_idx++) {
-        if (sim_idx % (n_sim / 10) == 0) {
-            std::cout << "  Progress: " << sim_idx << "/" << n_sim 
-                      << " (" << (sim_idx * 100 / n_sim) << "%)" << std::endl;
-        }
-        
-        // 重置仿真器状态
-        simulator_.initialize_sequential_simulation();
-        
-        // 为当前仿真随机注入故障
-        inject_random_faults(fault_injector, fault_prob);
+    sampler_.setProbability(fault_prob);
+    
+    const size_t num_pos = aig.pos.size();
+    std::vector<long long> node_ones((size_t)k_cycles * monitored.size(), 0);
+    std::vector<long long> po_failures((size_t)k_cycles * num_pos, 0);
+    
+    // 运行蒙特卡洛仿真：每批 64*W 个场景，最后一批只统计有效位。
+    // 各批的随机数流只由 (种子, 批号) 决定，计数为整数累加，结果与线程划分无关。
+    // 每轮至多 kRoundBatches 批；自适应模式在轮末按批号顺序更新 PO 失效概率的在线统计并判断是否停止，
+    // 只有这时需要逐批的失效计数，否则直接累加到线程局部计数，内存与场景数无关
+    const int lanes = get_lanes();
+    if ((n_sim + lanes - 1) / lanes > std::numeric_limits<int>::max()) {
+        std::cerr << "  n_sim too large: " << n_sim << std::endl;
+        return {};
+    }
+    const int batches = (int)((n_sim + lanes - 1) / lanes);
+    const int report_every = std::max(1, batches / 10);
+    const bool adaptive = tolerance_ > 0.0 || time_budget_ > 0.0;
+    const auto start_time = std::chrono::steady_clock::now();
+    std::vector<RunningStat> po_running(adaptive ? (size_t)k_cycles * num_pos : 0);
+    std::vector<long long> round_failures(adaptive ? (size_t)kRoundBatches * po_failures.size() : 0);
+    int finished = 0;
+    int first = 0;
+    bool stop = false;
+    
+    #pragma omp parallel
+    {
+        std::vector<long long> local_ones(node_ones.size(), 0);
+        std::vector<long long> local_failures(adaptive ? 0 : po_failures.size(), 0);
+        std::vector<uint64_t> valid(words_);
         
-        // 运行k个周期
-        for (int cycle = 0; cycle < k_cycles; cycle++) {
-            // 获取当前周期的输入
-            std::vector<bool> inputs;
-            if (cycle < input_sequence.size()) {
-                inputs = input_sequence[cycle];
-            } else {
-                inputs = std::vector<bool>(simulator_.get_num_inputs(), false);
-            }
+        // first/stop 只在 single 中修改，其后的隐式屏障保证各线程读到相同的值
+        while (!stop && first < batches) {
+            const int round = std::min(kRoundBatches, batches - first);
             
-            // 使用故障注入进行仿真
-            auto node_values = simulate_cycle_with_faults(inputs, fault_injector, cycle);
+            #pragma omp single
+            std::fill(round_failures.begin(), round_failures.end(), 0);
             
-            // 更新统计
-            for (int node_id : nodes_to_monitor) {
-                auto it = node_values.find(node_id);
-                if (it != node_values.end()) {
-                    if (it->second == 0) {
-                        statistics_[node_id][cycle].count_0++;
-                    } else {
-                        statistics_[node_id][cycle].count_1++;
+            #pragma omp for schedule(dynamic)
+            for (int i = 0; i < round; i++) {
+                const int batch = first + i;
+                const long long remaining = n_sim - (long long)batch * lanes;
+                for (int w = 0; w < words_; w++) {
+                    const long long bits = std::min(64LL, std::max(0LL, remaining - w * 64));
+                    valid[w] = bits == 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+                }
+                
+                long long* fails = adaptive ? round_failures.data() + (size_t)i * po_failures.size()
+                                            : local_failures.data();
+                if (words_ == 4) {
+                    simulate_batch<4>(aig, batch, k_cycles, input_sequence, initial_state, golden_po,
+                                      monitored, valid.data(), local_ones.data(), fails);
+                } else {
+                    simulate_batch<1>(aig, batch, k_cycles, input_sequence, initial_state, golden_po,
+                                      monitored, valid.data(), local_ones.data(), fails);
+                }
+                
+                #pragma omp critical(mc_progress)
+                {
+                    if (++finished % report_every == 0) {
+                        std::cout << "  Progress: " << std::min((long long)finished * lanes, n_sim)
+                                  << "/" << n_sim << " (" << ((long long)finished * 100 / batches) << "%)" << std::endl;
                     }
                 }
             }
             
-            // 为下一个周期更新状态（如果仿真器支持）
-            simulator_.propagate_register_values();
+            #pragma omp single
+            {
+                if (adaptive) {
+                    for (int i = 0; i < round; i++) {
+                        const int batch_lanes = (int)std::min((long long)lanes, n_sim - (long long)(first + i) * lanes);
+                        const long long* fails = round_failures.data() + (size_t)i * po_failures.size();
+                        for (size_t k = 0; k < po_failures.size(); k++) {
+                            po_failures[k] += fails[k];
+                            po_running[k].add(static_cast<double>(fails[k]) / batch_lanes);
+                        }
+                    }
+                }
+                first += round;
+                trials_run_ = std::min((long long)first * lanes, n_sim);
+                
+                if (adaptive && first < batches) {
+                    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                    const double half = max_half_width(po_running, po_failures, trials_run_);
+                    if (tolerance_ > 0.0 && half <= tolerance_) {
+                        std::cout << "  Converged after " << trials_run_ << " trials (CI half-width "
+                                  << half << " <= " << tolerance_ << ")" << std::endl;
+                        stop = true;
+                    } else if (time_budget_ > 0.0 && elapsed >= time_budget_) {
+                        std::cout << "  Time budget exhausted after " << trials_run_ << " trials (CI half-width "
+                                  << half << ")" << std::endl;
+                        stop = true;
+                    }
+                }
+            }
+        }
+        
+        #pragma omp critical(mc_merge)
+        {
+            for (size_t i = 0; i < node_ones.size(); i++) node_ones[i] += local_ones[i];
+            for (size_t k = 0; k < local_failures.size(); k++) po_failures[k] += local_failures[k];
+        }
+    }
+    
+    // 整理为按节点/周期的统计
+    for (size_t i = 0; i < monitored.size(); i++) {
+        const int node_id = monitored[i];
+        auto& cycle_stats = statistics_[node_id];
+        cycle_stats.resize(k_cycles);
+        for (int cycle = 0; cycle < k_cycles; cycle++) {
+            const long long ones = node_ones[(size_t)cycle * monitored.size() + i];
+            cycle_stats[cycle] = {cycle, node_id, trials_run_ - ones, ones};
+        }
+    }
+    
+    po_statistics_.resize(k_cycles);
+    for (int cycle = 0; cycle < k_cycles; cycle++) {
+        for (size_t po = 0; po < num_pos; po++) {
+            const size_t k = (size_t)cycle * num_pos + po;
+            const double half = adaptive ? half_width(po_running[k], po_failures[k], trials_run_)
+                                         : z_ * std::sqrt(binomial_variance(po_failures[k], trials_run_) / trials_run_);
+            po_statistics_[cycle].push_back({cycle, (int)po, po_failures[k], trials_run_, half});
         }
     }
     
@@ -115,44 +233,472 @@ MCFaultSimulator::run_mc_simulations(
     return trends;
 }
 
-void MCFaultSimulator::inject_random_faults(
-    FaultInjector& fault_injector, double fault_prob) {
+std::vector<std::vector<MCFaultSimulator::RareEventEstimate>>
+MCFaultSimulator::run_importance_sampling(
+    int n_sim,
+    int k_cycles,
+    const std::vector<std::vector<bool>>& input_sequence,
+    double fault_prob,
+    double biased_prob,
+    double relative_tolerance) {
     
-    fault_injector.clear_faults();
+    trials_run_ = 0;
+    if (n_sim <= 0 || k_cycles <= 0 || fault_prob <= 0.0 || fault_prob >= 1.0) {
+        return {};
+    }
+    
+    std::vector<bool> initial_state;
+    std::vector<uint8_t> golden_po;
+    const LevelizedAIG& aig = prepare_simulation(k_cycles, input_sequence, initial_state, golden_po);
+    const size_t num_pos = aig.pos.size();
+    const double num_sites = (double)aig.gates.size() * k_cycles;
+    if (biased_prob <= 0.0) {
+        biased_prob = std::max(fault_prob, std::min(0.5, 1.0 / std::max(1.0, num_sites)));
+    }
+    biased_prob = std::min(biased_prob, 0.5);
+    
+    std::cout << "Importance sampling: n_sim = " << n_sim << ", k_cycles = " << k_cycles
+              << ", fault_prob = " << fault_prob << ", biased_prob = " << biased_prob << std::endl;
     
-    // 遍历电路中的节点并随机注入故障
-    // 注意：这里需要访问mockturtle网络的节点
-    // 由于我们无法直接访问，简化处理
+    sampler_.setProbability(biased_prob);
+    const double log_fault = std::log(fault_prob / biased_prob);
+    const double log_clean = std::log1p(-fault_prob) - std::log1p(-biased_prob);
     
-    std::cout << "  Random fault injection with probability: " << fault_prob << std::endl;
+    const int lanes = get_lanes();
+    const int batches = (int)(((long long)n_sim + lanes - 1) / lanes);
+    std::vector<double> sum_w((size_t)k_cycles * num_pos, 0.0);
+    std::vector<double> sum_w2(sum_w.size(), 0.0);
+    std::vector<std::vector<RareEventEstimate>> estimates;
+    const auto start = std::chrono::steady_clock::now();
     
-    // 假设我们有一些节点ID
-    for (int node_id = 0; node_id < 100; node_id++) { // 示例：前100个节点
-        if (dist_(rng_) < fault_prob) {
-            // 随机选择stuck-at-0或stuck-at-1
-            bool stuck_value = (dist_(rng_) < 0.5);
-            // fault_injector.set_stuck_at_fault(node_id, stuck_value);
+    // 无偏估计 p = E_q[w 1{fail}]，方差 (E[w^2 1{fail}] - p^2) / n
+    auto update = [&](long long trials) {
+        estimates.assign(k_cycles, {});
+        for (int cycle = 0; cycle < k_cycles; cycle++) {
+            for (size_t po = 0; po < num_pos; po++) {
+                const size_t k = (size_t)cycle * num_pos + po;
+                const double p = sum_w[k] / trials;
+                const double var = std::max(0.0, sum_w2[k] / trials - p * p) / trials;
+                estimates[cycle].push_back({cycle, (int)po, p, std::sqrt(var), 0.0, trials});
+            }
         }
-    }
+    };
+    
+    run_weighted_batches(aig, batches, n_sim, k_cycles, input_sequence, initial_state, golden_po,
+        [&](int, std::vector<uint64_t>&, WeightedBatch& wb) {
+            wb.log_fault = log_fault;
+            wb.log_clean = log_clean;
+        },
+        [&](int, const double* w, const double* w2) {
+            for (size_t k = 0; k < sum_w.size(); k++) {
+                sum_w[k] += w[k];
+                sum_w2[k] += w2[k];
+            }
+        },
+        [&](int done) {
+            trials_run_ = std::min((long long)done * lanes, (long long)n_sim);
+            update(trials_run_);
+            return rare_event_converged(estimates, relative_tolerance, start);
+        });
+    
+    std::cout << "Importance sampling completed: " << trials_run_ << " trials" << std::endl;
+    return estimates;
 }
 
-std::unordered_map<int, bool> 
-MCFaultSimulator::simulate_cycle_with_faults(
-    const std::vector<bool>& inputs,
-    FaultInjector& fault_injector,
-    int cycle) {
+std::vector<std::vector<MCFaultSimulator::RareEventEstimate>>
+MCFaultSimulator::run_stratified_sampling(
+    int n_sim,
+    int k_cycles,
+    const std::vector<std::vector<bool>>& input_sequence,
+    double fault_prob,
+    int max_faults,
+    double relative_tolerance) {
     
-    std::unordered_map<int, bool> node_values;
+    trials_run_ = 0;
+    if (n_sim <= 0 || k_cycles <= 0 || fault_prob <= 0.0 || fault_prob >= 1.0) {
+        return {};
+    }
+    
+    std::vector<bool> initial_state;
+    std::vector<uint8_t> golden_po;
+    const LevelizedAIG& aig = prepare_simulation(k_cycles, input_sequence, initial_state, golden_po);
+    const size_t num_pos = aig.pos.size();
+    const uint64_t num_gates = aig.gates.size();
+    const uint64_t num_sites = num_gates * k_cycles;
+    if (num_sites == 0) {
+        return {};
+    }
+    
+    // 各层概率 pi_k = Binom(k; N, eps)，用对数形式避免溢出
+    auto log_pmf = [&](uint64_t k) {
+        const double n = (double)num_sites;
+        return std::lgamma(n + 1) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1)
+               + k * std::log(fault_prob) + (n - k) * std::log1p(-fault_prob);
+    };
+    auto tail_above = [&](uint64_t k) {   // P(K > k)
+        double tail = 0.0;
+        for (uint64_t j = k + 1; j <= num_sites && j <= k + 1000; j++) {
+            const double term = std::exp(log_pmf(j));
+            tail += term;
+            if (term < tail * 1e-17) break;
+        }
+        return tail;
+    };
+    const double p_any = -std::expm1(num_sites * std::log1p(-fault_prob));   // P(K >= 1)
+    uint64_t strata = max_faults > 0 ? (uint64_t)max_faults : 1;
+    if (max_faults <= 0) {
+        while (strata < 32 && strata < num_sites && tail_above(strata) > 1e-6 * p_any) strata++;
+    }
+    strata = std::min(strata, num_sites);
+    std::vector<double> pi(strata + 1, 0.0);
+    for (uint64_t k = 1; k <= strata; k++) pi[k] = std::exp(log_pmf(k));
+    const double truncation = tail_above(strata);
+    
+    std::cout << "Stratified sampling: n_sim = " << n_sim << ", k_cycles = " << k_cycles
+              << ", fault_prob = " << fault_prob << ", strata = 1.." << strata
+              << ", truncated mass = " << truncation << std::endl;
+    
+    // 批号 b 属于第 b % strata + 1 层，各层轮流推进，自适应停止时各层样本数均衡
+    const int lanes = get_lanes();
+    const int per_stratum = std::max(1, (int)((n_sim + (long long)lanes * strata - 1) / ((long long)lanes * strata)));
+    const int batches = per_stratum * (int)strata;
+    const uint64_t cycle_sites = num_gates * lanes;
+    std::vector<double> fail_w((strata + 1) * k_cycles * num_pos, 0.0);
+    std::vector<long long> stratum_trials(strata + 1, 0);
+    std::vector<std::vector<RareEventEstimate>> estimates;
+    const auto start = std::chrono::steady_clock::now();
+    
+    auto update = [&](long long trials) {
+        estimates.assign(k_cycles, {});
+        for (int cycle = 0; cycle < k_cycles; cycle++) {
+            for (size_t po = 0; po < num_pos; po++) {
+                double p = 0.0, var = 0.0;
+                for (uint64_t k = 1; k <= strata; k++) {
+                    if (stratum_trials[k] == 0) continue;
+                    const double n = (double)stratum_trials[k];
+                    const double pk = fail_w[(k * k_cycles + cycle) * num_pos + po] / n;
+                    p += pi[k] * pk;
+                    var += pi[k] * pi[k] * pk * (1.0 - pk) / n;
+                }
+                estimates[cycle].push_back({cycle, (int)po, p, std::sqrt(var), truncation, trials});
+            }
+        }
+    };
+    
+    run_weighted_batches(aig, batches, (long long)batches * lanes, k_cycles, input_sequence,
+                         initial_state, golden_po,
+        [&](int batch, std::vector<uint64_t>& sites, WeightedBatch& wb) {
+            // 每个场景在 N 个 (周期, 门) 位置中无放回地抽 k 个
+            const uint64_t k = batch % strata + 1;
+            PhiloxStream rng(seed_, kStrataStream, (uint32_t)k, batch);
+            std::vector<uint64_t> picked;
+            sites.clear();
+            for (int lane = 0; lane < lanes; lane++) {
+                picked.clear();
+                while (picked.size() < k) {
+                    const uint64_t pos = (uint64_t)(((unsigned __int128)rng() * num_sites) >> 64);
+                    if (std::find(picked.begin(), picked.end(), pos) == picked.end()) picked.push_back(pos);
+                }
+                for (uint64_t pos : picked) {
+                    const uint64_t cycle = pos / num_gates, gate = pos % num_gates;
+                    sites.push_back(cycle * cycle_sites + gate * lanes + lane);
+                }
+            }
+            std::sort(sites.begin(), sites.end());
+            wb.sites = &sites;
+        },
+        [&](int batch, const double* w, const double*) {
+            const uint64_t k = batch % strata + 1;
+            double* dst = fail_w.data() + k * k_cycles * num_pos;
+            for (size_t i = 0; i < (size_t)k_cycles * num_pos; i++) dst[i] += w[i];
+            stratum_trials[k] += lanes;
+        },
+        [&](int done) {
+            trials_run_ = (long long)done * lanes;
+            update(trials_run_);
+            return done >= (int)strata && rare_event_converged(estimates, relative_tolerance, start);
+        });
+    
+    std::cout << "Stratified sampling completed: " << trials_run_ << " trials" << std::endl;
+    return estimates;
+}
+
+void MCFaultSimulator::run_weighted_batches(
+    const LevelizedAIG& aig, int batches, long long n_trials, int k_cycles,
+    const std::vector<std::vector<bool>>& input_sequence,
+    const std::vector<bool>& initial_state,
+    const std::vector<uint8_t>& golden_po,
+    const std::function<void(int, std::vector<uint64_t>&, WeightedBatch&)>& setup,
+    const std::function<void(int, const double*, const double*)>& batch_done,
+    const std::function<bool(int)>& round_done) {
+    
+    const size_t cells = (size_t)k_cycles * aig.pos.size();
+    const int lanes = get_lanes();
+    std::vector<double> round_w, round_w2;
+    
+    for (int first = 0; first < batches; ) {
+        const int round = std::min(kRoundBatches, batches - first);
+        round_w.assign((size_t)round * cells, 0.0);
+        round_w2.assign((size_t)round * cells, 0.0);
+        
+        #pragma omp parallel
+        {
+            std::vector<long long> fails(cells, 0);
+            std::vector<uint64_t> valid(words_);
+            std::vector<uint64_t> sites;
+            const std::vector<uint32_t> none;
+            
+            #pragma omp for schedule(dynamic)
+            for (int i = 0; i < round; i++) {
+                const int batch = first + i;
+                const long long remaining = n_trials - (long long)batch * lanes;
+                for (int w = 0; w < words_; w++) {
+                    const long long bits = std::min(64LL, std::max(0LL, remaining - w * 64));
+                    valid[w] = bits == 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+                }
+                
+                WeightedBatch wb;
+                setup(batch, sites, wb);
+                wb.po_weight = round_w.data() + (size_t)i * cells;
+                wb.po_weight_sq = round_w2.data() + (size_t)i * cells;
+                if (words_ == 4) {
+                    simulate_batch<4>(aig, batch, k_cycles, input_sequence, initial_state, golden_po,
+                                      none, valid.data(), nullptr, fails.data(), &wb);
+                } else {
+                    simulate_batch<1>(aig, batch, k_cycles, input_sequence, initial_state, golden_po,
+                                      none, valid.data(), nullptr, fails.data(), &wb);
+                }
+            }
+        }
+        
+        for (int i = 0; i < round; i++) {
+            batch_done(first + i, round_w.data() + (size_t)i * cells, round_w2.data() + (size_t)i * cells);
+        }
+        first += round;
+        if (round_done(first)) break;
+    }
+}
+
+// 所有估计为正的输出相对误差 z*se/p 都不超过 relative_tolerance (且至少有一个为正)，
+// 或超过 set_adaptive_stopping 给出的时间预算
+bool MCFaultSimulator::rare_event_converged(const std::vector<std::vector<RareEventEstimate>>& estimates,
+                                            double relative_tolerance,
+                                            std::chrono::steady_clock::time_point start) const {
+    if (relative_tolerance > 0.0) {
+        double worst = 0.0;
+        bool any = false;
+        for (const auto& cycle : estimates) {
+            for (const auto& e : cycle) {
+                if (e.probability <= 0.0) continue;
+                any = true;
+                worst = std::max(worst, z_ * e.relative_error());
+            }
+        }
+        if (any && worst <= relative_tolerance) {
+            std::cout << "  Converged: relative CI half-width " << worst << " <= " << relative_tolerance << std::endl;
+            return true;
+        }
+    }
+    if (time_budget_ > 0.0 &&
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= time_budget_) {
+        std::cout << "  Time budget exhausted" << std::endl;
+        return true;
+    }
+    return false;
+}
+
+void MCFaultSimulator::inject_random_faults(
+    FaultInjector& fault_injector, double fault_prob) {
     
-    // 这里应该调用仿真器的故障注入仿真功能
-    // 由于当前仿真器不支持，我们简化处理
+    fault_injector.clear_faults();
     
-    // 实际应该：
-    // 1. 设置输入值
-    // 2. 使用故障注入器进行仿真
-    // 3. 返回所有节点值
+    // 在所有与门上按概率注入 stuck-at 故障 (标量路径，位并行仿真不经过这里)
+    const auto& gates = simulator_.get_levelized().gates;
+    PhiloxStream rng(seed_, kScalarStream, 0, scalar_trials_++);
+    std::vector<uint64_t> sites;
+    FaultSiteSampler(fault_prob).sample(gates.size(), rng, sites);
+    for (uint64_t site : sites) {
+        // 随机选择stuck-at-0或stuck-at-1
+        bool stuck_value = (rng() >> 63) != 0;
+        fault_injector.set_stuck_at_fault(simulator_.get_circuit().index_to_node(gates[site]), stuck_value);
+    }
+}
+
+// 寄存器初值取仿真器的初始状态，并求出无故障参考输出
+const LevelizedAIG& MCFaultSimulator::prepare_simulation(int k_cycles,
+                                                         const std::vector<std::vector<bool>>& input_sequence,
+                                                         std::vector<bool>& initial_state,
+                                                         std::vector<uint8_t>& golden_po) {
+    simulator_.initialize_sequential_simulation();
+    const LevelizedAIG& aig = simulator_.get_levelized();
+    initial_state.assign(aig.ros.size(), false);
+    for (const auto& reg : simulator_.get_registers()) {
+        if (reg.index >= 0 && reg.index < (int)initial_state.size()) {
+            initial_state[reg.index] = reg.current_state;
+        }
+    }
+    simulate_golden(aig, k_cycles, input_sequence, initial_state, golden_po);
+    return aig;
+}
+
+void MCFaultSimulator::simulate_golden(const LevelizedAIG& aig, int k_cycles,
+                                       const std::vector<std::vector<bool>>& input_sequence,
+                                       const std::vector<bool>& initial_state,
+                                       std::vector<uint8_t>& golden_po) {
+    std::vector<uint8_t> v(aig.num_nodes, 0);
+    std::vector<uint8_t> state(initial_state.begin(), initial_state.end());
+    golden_po.assign((size_t)k_cycles * aig.pos.size(), 0);
+    auto lit = [&](uint32_t l) -> uint8_t { return v[l >> 1] ^ (l & 1); };
+    
+    for (int cycle = 0; cycle < k_cycles; cycle++) {
+        for (size_t i = 0; i < aig.pis.size(); i++) {
+            v[aig.pis[i]] = cycle < (int)input_sequence.size() && i < input_sequence[cycle].size()
+                            && input_sequence[cycle][i];
+        }
+        for (size_t r = 0; r < aig.ros.size(); r++) v[aig.ros[r]] = state[r];
+        for (size_t g = 0; g < aig.gates.size(); g++) {
+            v[aig.gates[g]] = lit(aig.fanin0[g]) & lit(aig.fanin1[g]);
+        }
+        for (size_t po = 0; po < aig.pos.size(); po++) {
+            golden_po[(size_t)cycle * aig.pos.size() + po] = lit(aig.pos[po]);
+        }
+        for (size_t r = 0; r < aig.ris.size(); r++) state[r] = lit(aig.ris[r]);
+    }
+}
+
+template <int W>
+void MCFaultSimulator::simulate_batch(const LevelizedAIG& aig, int batch, int k_cycles,
+                                      const std::vector<std::vector<bool>>& input_sequence,
+                                      const std::vector<bool>& initial_state,
+                                      const std::vector<uint8_t>& golden_po,
+                                      const std::vector<uint32_t>& monitored,
+                                      const uint64_t* valid, long long* node_ones,
+                                      long long* po_failures, const WeightedBatch* weighted) const {
+    // values[node * W + w]：节点在 64*W 个场景中的取值
+    std::vector<uint64_t> values((size_t)aig.num_nodes * W, 0);
+    std::vector<uint64_t> fault_sites;
+    const uint64_t cycle_sites = (uint64_t)aig.gates.size() * W * 64;
+    
+    // 重要性抽样：记录每个场景 (位) 到当前周期为止的故障数，用于似然比
+    const bool reweight = weighted && (weighted->log_fault != 0.0 || weighted->log_clean != 0.0);
+    std::vector<uint32_t> lane_faults(reweight ? W * 64 : 0, 0);
+    size_t fixed_next = 0;
+    std::vector<uint64_t> state(aig.ros.size() * W, 0);
+    for (size_t r = 0; r < aig.ros.size(); r++) {
+        if (r < initial_state.size() && initial_state[r]) std::fill_n(state.begin() + r * W, W, ~uint64_t(0));
+    }
     
-    return node_values;
+    uint64_t* v = values.data();
+    for (int cycle = 0; cycle < k_cycles; cycle++) {
+        // 所有场景使用同一组输入
+        for (size_t i = 0; i < aig.pis.size(); i++) {
+            const bool in = cycle < (int)input_sequence.size() && i < input_sequence[cycle].size()
+                            && input_sequence[cycle][i];
+            std::fill_n(v + (size_t)aig.pis[i] * W, W, in ? ~uint64_t(0) : 0);
+        }
+        for (size_t r = 0; r < aig.ros.size(); r++) {
+            std::copy_n(state.begin() + r * W, W, v + (size_t)aig.ros[r] * W);
+        }
+        
+        // 故障率低时把本周期的 门 x 场景位 看作一串位置，几何跳跃抽出全部故障位置；
+        // 随机数流按 (门或整串, 周期, 批号) 编号。分层抽样时故障位置已预先给定
+        const bool fixed = weighted && weighted->sites;
+        const bool mask_bits = !fixed && sampler_.prefersMaskBits();
+        const uint64_t* site = nullptr;
+        const uint64_t* site_end = nullptr;
+        uint64_t site_base = 0;
+        if (fixed) {
+            const std::vector<uint64_t>& all = *weighted->sites;
+            const size_t begin = fixed_next;
+            while (fixed_next < all.size() && all[fixed_next] < (uint64_t)(cycle + 1) * cycle_sites) fixed_next++;
+            site = all.data() + begin;
+            site_end = all.data() + fixed_next;
+            site_base = (uint64_t)cycle * cycle_sites;
+        } else if (!mask_bits) {
+            fault_sites.clear();
+            PhiloxStream rng(seed_, kSiteStream, cycle, batch);
+            sampler_.sample(cycle_sites, rng, fault_sites);
+            site = fault_sites.data();
+            site_end = site + fault_sites.size();
+        }
+        
+        // 一次扫描求出所有场景的门输出，再异或各自的故障翻转掩码
+        for (size_t g = 0; g < aig.gates.size(); g++) {
+            const uint32_t f0 = aig.fanin0[g];
+            const uint32_t f1 = aig.fanin1[g];
+            const uint64_t m0 = 0 - (uint64_t)(f0 & 1);
+            const uint64_t m1 = 0 - (uint64_t)(f1 & 1);
+            const uint64_t* a = v + (size_t)(f0 >> 1) * W;
+            const uint64_t* b = v + (size_t)(f1 >> 1) * W;
+            uint64_t* out = v + (size_t)aig.gates[g] * W;
+            for (int w = 0; w < W; w++) {
+                out[w] = (a[w] ^ m0) & (b[w] ^ m1);
+            }
+            
+            if (mask_bits) {
+                PhiloxStream rng(seed_, (uint32_t)g, cycle, batch);
+                for (int w = 0; w < W; w++) {
+                    const uint64_t flip = sampler_.mask64(rng);
+                    out[w] ^= flip;
+                    if (reweight) {
+                        for (uint64_t f = flip; f; f &= f - 1) lane_faults[w * 64 + __builtin_ctzll(f)]++;
+                    }
+                }
+            } else {
+                const uint64_t end = site_base + (uint64_t)(g + 1) * W * 64;
+                for (; site != site_end && *site < end; ++site) {
+                    const uint64_t bit = *site - site_base - (uint64_t)g * W * 64;
+                    out[bit >> 6] ^= uint64_t(1) << (bit & 63);
+                    if (reweight) lane_faults[bit]++;
+                }
+            }
+        }
+        
+        // 节点取 1 的场景数
+        long long* ones = node_ones + (size_t)cycle * monitored.size();
+        for (size_t i = 0; i < monitored.size(); i++) {
+            const uint64_t* x = v + (size_t)monitored[i] * W;
+            for (int w = 0; w < W; w++) ones[i] += __builtin_popcountll(x[w] & valid[w]);
+        }
+        
+        // PO 与无故障值不同的场景数
+        long long* fails = po_failures + (size_t)cycle * aig.pos.size();
+        for (size_t po = 0; po < aig.pos.size(); po++) {
+            const uint32_t l = aig.pos[po];
+            const uint64_t expect = golden_po[(size_t)cycle * aig.pos.size() + po] ? ~uint64_t(0) : 0;
+            const uint64_t m = 0 - (uint64_t)(l & 1);
+            const uint64_t* x = v + (size_t)(l >> 1) * W;
+            for (int w = 0; w < W; w++) {
+                const uint64_t diff = ((x[w] ^ m) ^ expect) & valid[w];
+                const int count = __builtin_popcountll(diff);
+                fails[po] += count;
+                if (!weighted || count == 0) continue;
+                
+                const size_t k = (size_t)cycle * aig.pos.size() + po;
+                if (!reweight) {
+                    weighted->po_weight[k] += count;
+                    weighted->po_weight_sq[k] += count;
+                    continue;
+                }
+                // 似然比只计到本周期为止的故障位置，之后的故障不影响本周期的 PO
+                const double sites_so_far = (double)aig.gates.size() * (cycle + 1);
+                for (uint64_t d = diff; d; d &= d - 1) {
+                    const uint32_t f = lane_faults[w * 64 + __builtin_ctzll(d)];
+                    const double lw = std::exp(f * weighted->log_fault + (sites_so_far - f) * weighted->log_clean);
+                    weighted->po_weight[k] += lw;
+                    weighted->po_weight_sq[k] += lw * lw;
+                }
+            }
+        }
+        
+        // 寄存器锁存 RI 的 (可能已出错的) 值
+        for (size_t r = 0; r < aig.ris.size(); r++) {
+            const uint32_t l = aig.ris[r];
+            const uint64_t m = 0 - (uint64_t)(l & 1);
+            const uint64_t* x = v + (size_t)(l >> 1) * W;
+            for (int w = 0; w < W; w++) state[r * W + w] = x[w] ^ m;
+        }
+    }
 }
 
 std::unordered_map<int, std::pair<double, double>>
@@ -161,16 +707,8 @@ MCFaultSimulator::get_low_priority_trend_vectors(
     
     std::unordered_map<int, std::pair<double, double>> vectors;
     
-    // 计算节点优先级
-    auto priorities = calculate_gate_priorities(k_cycles);
-    
     // 找出低优先级节点
-    std::vector<int> low_priority_nodes;
-    for (const auto& [node_id, priority] : priorities) {
-        if (priority < priority_threshold) {
-            low_priority_nodes.push_back(node_id);
-        }
-    }
+    std::vector<int> low_priority_nodes = get_low_priority_nodes(priority_threshold);
     
     std::cout << "Found " << low_priority_nodes.size() 
               << " low priority nodes (threshold = " << priority_threshold << ")" << std::endl;
@@ -205,68 +743,135 @@ MCFaultSimulator::get_low_priority_trend_vectors(
 std::unordered_map<int, double> 
 MCFaultSimulator::calculate_gate_priorities(int k_cycles) {
     
+    // 寄存器输出在 FSTRA 中不带扇出源，结构优先级与周期数无关
+    (void)k_cycles;
+    const LevelizedAIG& aig = simulator_.get_levelized();
+    const StructuralPriorities& structure = structural_priorities();
+    
     std::unordered_map<int, double> priorities;
+    priorities.reserve(aig.gates.size());
+    for (uint32_t node : aig.gates) {
+        priorities[node] = structure.priorities[node];
+    }
+    return priorities;
+}
+
+std::vector<int> MCFaultSimulator::get_low_priority_nodes(double priority_threshold) {
+    const LevelizedAIG& aig = simulator_.get_levelized();
+    const StructuralPriorities& structure = structural_priorities();
     
-    // 计算扇出源长度（论文公式3）
-    auto fanout_lengths = get_fanout_source_lengths();
+    std::vector<int> nodes;
+    for (uint32_t node : aig.gates) {
+        if (structure.priorities[node] < priority_threshold) nodes.push_back(node);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+// 一遍正向扫描做符号化的扇出源跟踪 (论文算法1，与 FSTRAAnalyzer::fsTracking 相同的规则)：
+// 扇入有多个扇出时贡献它自身，否则继承它的扇出源列表；PI/寄存器输出没有扇出源。
+// 单扇出节点的列表只被唯一的扇出门读取一次，读取后即释放；列表长度饱和于 kMaxFanoutSources，
+// 整体为 O(门数 * kMaxFanoutSources)。
+// 一遍反向扫描求到 PO/寄存器输入的最长路径。优先级 (论文公式5-7)：
+//   py_pre = kFanoutDecay * sum(扇入 py_pre) + |fsL|，py_suc = 到输出的距离，py_1 = py_pre + py_suc，
+//   py_2 = depth - level (从输出侧数的拓扑序号)，cpy = 0.75 py_1 / max(py_1) + 0.25 py_2 / max(py_2)。
+// 按最大值而不是总和归一化，优先级阈值在不同规模的电路间含义相同
+const MCFaultSimulator::StructuralPriorities& MCFaultSimulator::structural_priorities() {
+    const LevelizedAIG& aig = simulator_.get_levelized();
+    if (structure_.num_nodes == aig.num_nodes && structure_.num_gates == aig.gates.size()
+        && !structure_.priorities.empty()) {
+        return structure_;
+    }
     
-    // 计算拓扑距离（论文公式4,6）
-    auto distances = get_topological_distances();
+    const uint32_t n = aig.num_nodes;
+    StructuralPriorities& s = structure_;
+    s.num_nodes = n;
+    s.num_gates = aig.gates.size();
+    s.fanout_sources.assign(n, 0);
+    s.distances.assign(n, -1);
+    s.priorities.assign(n, 0.0);
+    
+    // 与 mockturtle 的 fanout_size 一致：门的扇入引用、PO 与寄存器输入都计入
+    std::vector<uint32_t> fanout_size(n, 0);
+    for (size_t g = 0; g < aig.gates.size(); g++) {
+        fanout_size[aig.fanin0[g] >> 1]++;
+        fanout_size[aig.fanin1[g] >> 1]++;
+    }
+    for (uint32_t lit : aig.pos) fanout_size[lit >> 1]++;
+    for (uint32_t lit : aig.ris) fanout_size[lit >> 1]++;
+    
+    std::vector<std::vector<uint32_t>> sources(n);   // 只保存单扇出门的列表
+    std::vector<double> py_pre(n, 0.0);
+    std::vector<uint32_t> merged;
+    for (size_t g = 0; g < aig.gates.size(); g++) {
+        const uint32_t node = aig.gates[g];
+        merged.clear();
+        for (uint32_t lit : {aig.fanin0[g], aig.fanin1[g]}) {
+            const uint32_t fanin = lit >> 1;
+            if (fanin == 0) continue;
+            if (fanout_size[fanin] != 1) {
+                merged.push_back(fanin);
+            } else {
+                merged.insert(merged.end(), sources[fanin].begin(), sources[fanin].end());
+                std::vector<uint32_t>().swap(sources[fanin]);
+            }
+            py_pre[node] += py_pre[fanin];
+        }
+        std::sort(merged.begin(), merged.end());
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+        if (merged.size() > kMaxFanoutSources) merged.resize(kMaxFanoutSources);
+        
+        s.fanout_sources[node] = merged.size();
+        py_pre[node] = kFanoutDecay * py_pre[node] + merged.size();
+        if (fanout_size[node] == 1) sources[node] = merged;
+    }
     
-    // 计算每个节点的优先级（论文公式5,7）
-    for (const auto& [node_id, fanout_length] : fanout_lengths) {
-        if (distances.count(node_id)) {
-            double py_pre = fanout_length; // 简化：使用扇出源长度
-            double py_suc = distances[node_id]; // 使用到主输出的距离
-            
-            // 论文公式5: G_{k-i}.py_1 = G_{k-i}.py_pre + G_{k-i}.py_suc
-            double py_1 = py_pre + py_suc;
-            
-            // 论文公式6: G_{k-i}.py_2 = i (拓扑顺序索引)
-            double py_2 = node_id; // 简化：使用节点ID作为拓扑索引
-            
-            // 归一化
-            // 这里需要所有节点的和，简化处理
-            double norm_py1 = py_1 / 1000.0; // 假设总和为1000
-            double norm_py2 = py_2 / 1000.0; // 假设总和为1000
-            
-            // 论文公式7: G_{k-i}.cpy = Σ(λ_j * G_{k-i}.py_j / Σ(G_{k-i}.py_j))
-            double lambda1 = 0.75; // 论文默认值
-            double lambda2 = 0.25; // 论文默认值
-            
-            priorities[node_id] = lambda1 * norm_py1 + lambda2 * norm_py2;
+    // 反向层级：观测点为 0，门把自身距离加一传给扇入
+    for (uint32_t lit : aig.pos) s.distances[lit >> 1] = 0;
+    for (uint32_t lit : aig.ris) s.distances[lit >> 1] = 0;
+    for (size_t g = aig.gates.size(); g-- > 0; ) {
+        const int d = s.distances[aig.gates[g]];
+        if (d < 0) continue;
+        for (uint32_t lit : {aig.fanin0[g], aig.fanin1[g]}) {
+            s.distances[lit >> 1] = std::max(s.distances[lit >> 1], d + 1);
         }
     }
     
-    return priorities;
+    double max_py1 = 0.0, max_py2 = 0.0;
+    for (uint32_t node : aig.gates) {
+        max_py1 = std::max(max_py1, py_pre[node] + std::max(0, s.distances[node]));
+        max_py2 = std::max(max_py2, (double)(aig.depth - aig.level[node]));
+    }
+    const double lambda1 = 0.75;   // 论文默认值
+    const double lambda2 = 0.25;
+    for (uint32_t node : aig.gates) {
+        const double py1 = py_pre[node] + std::max(0, s.distances[node]);
+        const double py2 = aig.depth - aig.level[node];
+        s.priorities[node] = (max_py1 > 0.0 ? lambda1 * py1 / max_py1 : 0.0)
+                           + (max_py2 > 0.0 ? lambda2 * py2 / max_py2 : 0.0);
+    }
+    return structure_;
 }
 
 std::unordered_map<int, double> 
 MCFaultSimulator::get_fanout_source_lengths() {
+    const LevelizedAIG& aig = simulator_.get_levelized();
+    const StructuralPriorities& structure = structural_priorities();
     
     std::unordered_map<int, double> lengths;
-    
-    // 这里应该实现扇出源跟踪算法（论文算法1）
-    // 简化：假设每个节点的扇出源长度为1
-    for (int i = 0; i < 100; i++) { // 示例：前100个节点
-        lengths[i] = 1.0 + (i % 10); // 简单变化
-    }
-    
+    lengths.reserve(aig.gates.size());
+    for (uint32_t node : aig.gates) lengths[node] = structure.fanout_sources[node];
     return lengths;
 }
 
 std::unordered_map<int, int> 
 MCFaultSimulator::get_topological_distances() {
+    const LevelizedAIG& aig = simulator_.get_levelized();
+    const StructuralPriorities& structure = structural_priorities();
     
     std::unordered_map<int, int> distances;
-    
-    // 计算每个节点到主输出的最大距离
-    // 这里应该实现拓扑分析
-    // 简化：假设距离与节点ID相关
-    for (int i = 0; i < 100; i++) {
-        distances[i] = 10 - (i % 10); // 简单变化
-    }
-    
+    distances.reserve(aig.gates.size());
+    for (uint32_t node : aig.gates) distances[node] = structure.distances[node];
     return distances;
 }
 
@@ -0,0 +1,277 @@
+#include "seu_campaign.h"
+#include <omp.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+SEUCampaign::SEUCampaign(const LevelizedAIG& aig)
+    : aig_(aig), horizon_(0), simulated_lane_cycles_(0), full_lane_cycles_(0) {
+    register_of_node_.assign(aig_.num_nodes, -1);
+    for (size_t r = 0; r < aig_.ros.size(); r++) register_of_node_[aig_.ros[r]] = (int)r;
+    gate_of_node_.assign(aig_.num_nodes, UINT32_MAX);
+    for (size_t g = 0; g < aig_.gates.size(); g++) gate_of_node_[aig_.gates[g]] = g;
+}
+
+bool SEUCampaign::set_stimulus(const std::vector<std::vector<bool>>& input_sequence,
+                               const std::vector<bool>& initial_state) {
+    if (input_sequence.empty()) {
+        std::cerr << "Error: SEU campaign needs at least one input cycle" << std::endl;
+        return false;
+    }
+    if (!initial_state.empty() && initial_state.size() != aig_.ros.size()) {
+        std::cerr << "Error: initial state has " << initial_state.size() << " values, expected "
+                  << aig_.ros.size() << " registers" << std::endl;
+        return false;
+    }
+    inputs_ = input_sequence;
+
+    // 无故障轨迹：所有位相同的字求值，取第 0 位
+    const size_t regs = aig_.ros.size(), pos = aig_.pos.size();
+    golden_state_.assign((size_t)(num_cycles() + 1) * regs, 0);
+    golden_po_.assign((size_t)num_cycles() * pos, 0);
+    for (size_t r = 0; r < initial_state.size(); r++) golden_state_[r] = initial_state[r];
+
+    std::vector<uint64_t> values(aig_.num_nodes, 0), state(regs);
+    auto lit = [&](uint32_t l) { return (values[l >> 1] ^ (0 - (uint64_t)(l & 1))) & 1; };
+    for (int cycle = 0; cycle < num_cycles(); cycle++) {
+        for (size_t r = 0; r < regs; r++) state[r] = golden_state_[(size_t)cycle * regs + r] ? ~uint64_t(0) : 0;
+        evaluate(values, cycle, state.data(), {});
+        for (size_t po = 0; po < pos; po++) golden_po_[(size_t)cycle * pos + po] = lit(aig_.pos[po]);
+        for (size_t r = 0; r < regs; r++) golden_state_[(size_t)(cycle + 1) * regs + r] = lit(aig_.ris[r]);
+    }
+    return true;
+}
+
+void SEUCampaign::evaluate(std::vector<uint64_t>& values, int cycle, const uint64_t* state,
+                           const std::vector<std::pair<uint32_t, uint64_t>>& flips) const {
+    const auto& inputs = inputs_[cycle];
+    values[0] = 0;
+    for (size_t i = 0; i < aig_.pis.size(); i++) {
+        values[aig_.pis[i]] = i < inputs.size() && inputs[i] ? ~uint64_t(0) : 0;
+    }
+    for (size_t r = 0; r < aig_.ros.size(); r++) values[aig_.ros[r]] = state[r];
+
+    auto flip = flips.begin();
+    for (size_t g = 0; g < aig_.gates.size(); g++) {
+        const uint32_t f0 = aig_.fanin0[g], f1 = aig_.fanin1[g];
+        uint64_t v = (values[f0 >> 1] ^ (0 - (uint64_t)(f0 & 1))) & (values[f1 >> 1] ^ (0 - (uint64_t)(f1 & 1)));
+        for (; flip != flips.end() && flip->first == g; ++flip) v ^= flip->second;
+        values[aig_.gates[g]] = v;
+    }
+}
+
+bool SEUCampaign::run(const std::vector<Injection>& injections) {
+    if (inputs_.empty()) {
+        std::cerr << "Error: call set_stimulus before running the SEU campaign" << std::endl;
+        return false;
+    }
+    for (const auto& inj : injections) {
+        if (inj.node >= aig_.num_nodes || (register_of_node_[inj.node] < 0 && gate_of_node_[inj.node] == UINT32_MAX)) {
+            std::cerr << "Error: node " << inj.node << " is neither a register output nor an AND gate" << std::endl;
+            return false;
+        }
+        if (inj.cycle < 0 || inj.cycle >= num_cycles()) {
+            std::cerr << "Error: injection cycle " << inj.cycle << " outside 0.." << num_cycles() - 1 << std::endl;
+            return false;
+        }
+    }
+
+    results_.assign(injections.size(), InjectionResult());
+    for (size_t i = 0; i < injections.size(); i++) results_[i].injection = injections[i];
+
+    // 按注入周期分组，每组至多 64 个场景
+    std::vector<uint32_t> order(injections.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return injections[a].cycle < injections[b].cycle; });
+    std::vector<std::pair<size_t, size_t>> groups;   // order 中的 [起点, 长度)
+    for (size_t i = 0; i < order.size(); ) {
+        size_t j = i;
+        while (j < order.size() && j - i < 64 && injections[order[j]].cycle == injections[order[i]].cycle) j++;
+        groups.push_back({i, j - i});
+        i = j;
+    }
+
+    full_lane_cycles_ = 0;
+    for (const auto& inj : injections) {
+        const int end = horizon_ > 0 ? std::min(num_cycles(), inj.cycle + horizon_) : num_cycles();
+        full_lane_cycles_ += end - inj.cycle;
+    }
+
+    long long simulated = 0;
+    #pragma omp parallel reduction(+ : simulated)
+    {
+        std::vector<uint64_t> values(aig_.num_nodes, 0);
+        #pragma omp for schedule(dynamic)
+        for (size_t k = 0; k < groups.size(); k++) {
+            simulated += simulate_group(order.data() + groups[k].first, groups[k].second, values);
+        }
+    }
+    simulated_lane_cycles_ = simulated;
+    return true;
+}
+
+bool SEUCampaign::run_all(const std::vector<int>& cycles, bool include_gates) {
+    std::vector<Injection> injections;
+    for (int cycle : cycles) {
+        for (uint32_t node : aig_.ros) injections.push_back({node, cycle});
+        if (include_gates) {
+            for (uint32_t node : aig_.gates) injections.push_back({node, cycle});
+        }
+    }
+    return run(injections);
+}
+
+long long SEUCampaign::simulate_group(const uint32_t* group, size_t size, std::vector<uint64_t>& values) {
+    const size_t regs = aig_.ros.size(), pos = aig_.pos.size();
+    const int start = results_[group[0]].injection.cycle;
+    const int end = horizon_ > 0 ? std::min(num_cycles(), start + horizon_) : num_cycles();
+
+    // 第 lane 位是 group[lane] 的场景
+    std::vector<uint64_t> state(regs);
+    for (size_t r = 0; r < regs; r++) state[r] = golden_state_[(size_t)start * regs + r] ? ~uint64_t(0) : 0;
+    std::vector<std::pair<uint32_t, uint64_t>> flips;
+    for (size_t lane = 0; lane < size; lane++) {
+        const uint32_t node = results_[group[lane]].injection.node;
+        if (register_of_node_[node] >= 0) {
+            state[register_of_node_[node]] ^= uint64_t(1) << lane;
+        } else {
+            flips.push_back({gate_of_node_[node], uint64_t(1) << lane});
+        }
+    }
+    std::sort(flips.begin(), flips.end());
+    const std::vector<std::pair<uint32_t, uint64_t>> none;
+
+    auto lit = [&](uint32_t l) { return values[l >> 1] ^ (0 - (uint64_t)(l & 1)); };
+    auto finish = [&](uint64_t lanes, Outcome outcome, int latency) {
+        for (; lanes; lanes &= lanes - 1) {
+            InjectionResult& result = results_[group[__builtin_ctzll(lanes)]];
+            result.outcome = outcome;
+            result.latency = latency;
+        }
+    };
+
+    uint64_t alive = size == 64 ? ~uint64_t(0) : ((uint64_t(1) << size) - 1);
+    long long simulated = 0;
+    for (int cycle = start; cycle < end && alive; cycle++) {
+        simulated += __builtin_popcountll(alive);
+        evaluate(values, cycle, state.data(), cycle == start ? flips : none);
+
+        uint64_t fail = 0;
+        for (size_t po = 0; po < pos; po++) {
+            fail |= lit(aig_.pos[po]) ^ (golden_po_[(size_t)cycle * pos + po] ? ~uint64_t(0) : 0);
+        }
+        fail &= alive;
+        finish(fail, Outcome::Failure, cycle - start);
+        alive &= ~fail;
+
+        // 周期末状态与无故障一致的场景此后不再偏离
+        uint64_t diverged = 0;
+        for (size_t r = 0; r < regs; r++) {
+            state[r] = lit(aig_.ris[r]);
+            diverged |= state[r] ^ (golden_state_[(size_t)(cycle + 1) * regs + r] ? ~uint64_t(0) : 0);
+        }
+        finish(alive & ~diverged, Outcome::Masked, cycle - start + 1);
+        alive &= diverged;
+    }
+    finish(alive, Outcome::Latent, -1);
+    return simulated;
+}
+
+std::vector<SEUCampaign::TargetStats> SEUCampaign::get_target_stats() const {
+    std::vector<int64_t> slot(aig_.num_nodes, -1);
+    std::vector<TargetStats> stats;
+    auto add = [&](uint32_t node, int reg) {
+        slot[node] = stats.size();
+        TargetStats t;
+        t.node = node;
+        t.register_index = reg;
+        stats.push_back(t);
+    };
+    for (size_t r = 0; r < aig_.ros.size(); r++) add(aig_.ros[r], (int)r);
+    for (uint32_t node : aig_.gates) add(node, -1);
+
+    for (const auto& result : results_) {
+        TargetStats& t = stats[slot[result.injection.node]];
+        t.injections++;
+        if (result.outcome == Outcome::Failure) {
+            t.failures++;
+            t.mean_failure_latency += result.latency;
+        } else if (result.outcome == Outcome::Latent) {
+            t.latent++;
+        }
+    }
+    std::vector<TargetStats> injected;
+    for (auto& t : stats) {
+        if (t.injections == 0) continue;
+        if (t.failures > 0) t.mean_failure_latency /= t.failures;
+        injected.push_back(t);
+    }
+    return injected;
+}
+
+std::vector<long long> SEUCampaign::get_failure_latency_histogram() const {
+    std::vector<long long> histogram;
+    for (const auto& result : results_) {
+        if (result.outcome != Outcome::Failure) continue;
+        if ((int)histogram.size() <= result.latency) histogram.resize(result.latency + 1, 0);
+        histogram[result.latency]++;
+    }
+    return histogram;
+}
+
+std::vector<long long> SEUCampaign::get_convergence_histogram() const {
+    std::vector<long long> histogram;
+    for (const auto& result : results_) {
+        if (result.outcome != Outcome::Masked) continue;
+        if ((int)histogram.size() <= result.latency) histogram.resize(result.latency + 1, 0);
+        histogram[result.latency]++;
+    }
+    return histogram;
+}
+
+void SEUCampaign::print_summary() const {
+    long long failures = 0, latent = 0;
+    for (const auto& result : results_) {
+        failures += result.outcome == Outcome::Failure;
+        latent += result.outcome == Outcome::Latent;
+    }
+    const long long total = results_.size();
+    std::cout << "SEU campaign: " << total << " injections over " << num_cycles() << " cycles" << std::endl;
+    if (total == 0) return;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Failures: " << failures << " (" << 100.0 * failures / total << "%)"
+              << ", masked: " << total - failures - latent << ", latent: " << latent << std::endl;
+    if (full_lane_cycles_ > 0) {
+        std::cout << "  Simulated lane-cycles: " << simulated_lane_cycles_ << "/" << full_lane_cycles_
+                  << " (" << 100.0 * simulated_lane_cycles_ / full_lane_cycles_ << "%)" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+
+    const auto latency = get_failure_latency_histogram();
+    if (!latency.empty()) {
+        std::cout << "  Failure latency:";
+        for (size_t l = 0; l < latency.size(); l++) {
+            if (latency[l] > 0) std::cout << " " << l << ":" << latency[l];
+        }
+        std::cout << std::endl;
+    }
+}
+
+bool SEUCampaign::write_report(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+    file << "# node register injections failures latent vulnerability mean_failure_latency\n";
+    for (const auto& t : get_target_stats()) {
+        file << t.node << " " << t.register_index << " " << t.injections << " " << t.failures << " "
+             << t.latent << " " << t.vulnerability() << " " << t.mean_failure_latency << "\n";
+    }
+    file << "# failure latency histogram: cycles count\n";
+    const auto latency = get_failure_latency_histogram();
+    for (size_t l = 0; l < latency.size(); l++) file << l << " " << latency[l] << "\n";
+    return true;
+}
@@ -0,0 +1,294 @@
+#include "tensor_network.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <unordered_set>
+
+TensorNetwork::TensorNetwork()
+    : heuristic_(OrderHeuristic::MinFill), maxWidth_(20), stats_{0, 0, 0.0} {
+}
+
+void TensorNetwork::clear() {
+    factors_.clear();
+    cutPriors_.clear();
+    stats_ = ContractionStats{0, 0, 0.0};
+}
+
+bool TensorNetwork::addFactor(const std::vector<int>& vars, const std::vector<double>& table, int owner) {
+    const int k = vars.size();
+    if (k > 30 || table.size() != (size_t(1) << k)) {
+        std::cerr << "TensorNetwork: factor table size " << table.size()
+                  << " does not match " << k << " variables" << std::endl;
+        return false;
+    }
+
+    Factor f;
+    f.vars = vars;
+    std::sort(f.vars.begin(), f.vars.end());
+    if (std::adjacent_find(f.vars.begin(), f.vars.end()) != f.vars.end()) {
+        std::cerr << "TensorNetwork: duplicated variable in factor" << std::endl;
+        return false;
+    }
+    f.owner = owner;
+    f.table.resize(table.size());
+
+    // 输入编码：vars[i] 为第 (k-1-i) 位；内部编码：升序后第 j 个变量为第 j 位
+    std::vector<int> shiftIn(k);
+    for (int j = 0; j < k; ++j) {
+        int i = std::find(vars.begin(), vars.end(), f.vars[j]) - vars.begin();
+        shiftIn[j] = k - 1 - i;
+    }
+    for (size_t code = 0; code < f.table.size(); ++code) {
+        size_t in = 0;
+        for (int j = 0; j < k; ++j) {
+            in |= ((code >> j) & 1) << shiftIn[j];
+        }
+        f.table[code] = table[in];
+    }
+
+    factors_.push_back(std::move(f));
+    return true;
+}
+
+// 只保留 query 的祖先所拥有的因子：PTM 每行和为 1，非祖先节点求和后恒为 1
+std::vector<int> TensorNetwork::collectCone(int query) const {
+    std::unordered_map<int, std::vector<int>> ownedBy;
+    std::vector<int> cone;
+    for (int i = 0; i < (int)factors_.size(); ++i) {
+        if (factors_[i].owner < 0) cone.push_back(i);
+        else ownedBy[factors_[i].owner].push_back(i);
+    }
+
+    std::unordered_set<int> visited;
+    std::vector<int> stack{query};
+    visited.insert(query);
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        auto it = ownedBy.find(v);
+        if (it == ownedBy.end()) continue;
+        for (int fi : it->second) {
+            cone.push_back(fi);
+            for (int u : factors_[fi].vars) {
+                if (visited.insert(u).second) stack.push_back(u);
+            }
+        }
+    }
+    std::sort(cone.begin(), cone.end());
+    return cone;
+}
+
+std::vector<int> TensorNetwork::planOrder(const std::vector<Factor>& factors, int query,
+                                          int& width, std::vector<int>& widestScope) const {
+    // 交互图：同一因子中的变量两两相邻
+    std::unordered_map<int, std::unordered_set<int>> adj;
+    for (const auto& f : factors) {
+        for (int a : f.vars) {
+            auto& na = adj[a];
+            for (int b : f.vars) {
+                if (a != b) na.insert(b);
+            }
+        }
+    }
+
+    std::vector<int> remaining;
+    for (const auto& kv : adj) {
+        if (kv.first != query) remaining.push_back(kv.first);
+    }
+    std::sort(remaining.begin(), remaining.end());
+
+    std::vector<int> order;
+    order.reserve(remaining.size());
+    width = adj.count(query) ? 1 : 0;
+    widestScope.clear();
+
+    while (!remaining.empty()) {
+        size_t best = 0;
+        if (heuristic_ != OrderHeuristic::Topological) {
+            long long bestScore = std::numeric_limits<long long>::max();
+            for (size_t r = 0; r < remaining.size(); ++r) {
+                const auto& nb = adj[remaining[r]];
+                long long size = nb.size();
+                long long score = size;
+                if (heuristic_ == OrderHeuristic::MinFill) {
+                    long long fill = 0;
+                    for (int a : nb) {
+                        const auto& na = adj[a];
+                        for (int b : nb) {
+                            if (a < b && !na.count(b)) ++fill;
+                        }
+                    }
+                    // 以新增边数为主，生成张量大小为次
+                    score = fill * 64 + size;
+                }
+                if (score < bestScore) {
+                    bestScore = score;
+                    best = r;
+                }
+            }
+        }
+
+        int x = remaining[best];
+        remaining.erase(remaining.begin() + best);
+        order.push_back(x);
+
+        auto nb = adj[x];
+        if ((int)nb.size() + 1 > width) {
+            width = nb.size() + 1;
+            widestScope.assign(nb.begin(), nb.end());
+            widestScope.push_back(x);
+        }
+        for (int a : nb) {
+            auto& na = adj[a];
+            na.erase(x);
+            for (int b : nb) {
+                if (a != b) na.insert(b);
+            }
+        }
+        adj.erase(x);
+    }
+    return order;
+}
+
+std::vector<int> TensorNetwork::eliminationOrder(int query, int& width) const {
+    std::vector<Factor> local;
+    for (int fi : collectCone(query)) local.push_back(factors_[fi]);
+    std::vector<int> widest;
+    return planOrder(local, query, width, widest);
+}
+
+void TensorNetwork::eliminate(std::vector<Factor>& factors, int var, double& flops) {
+    std::vector<Factor> bucket;
+    std::vector<Factor> rest;
+    for (auto& f : factors) {
+        if (std::binary_search(f.vars.begin(), f.vars.end(), var)) bucket.push_back(std::move(f));
+        else rest.push_back(std::move(f));
+    }
+    if (bucket.empty()) {
+        factors = std::move(rest);
+        return;
+    }
+
+    std::vector<int> scope;
+    for (const auto& f : bucket) scope.insert(scope.end(), f.vars.begin(), f.vars.end());
+    std::sort(scope.begin(), scope.end());
+    scope.erase(std::unique(scope.begin(), scope.end()), scope.end());
+
+    const int u = scope.size();
+    const int p = std::lower_bound(scope.begin(), scope.end(), var) - scope.begin();
+
+    // 每个因子的变量在合并编码中的位置
+    std::vector<std::vector<int>> pos(bucket.size());
+    for (size_t i = 0; i < bucket.size(); ++i) {
+        for (int v : bucket[i].vars) {
+            pos[i].push_back(std::lower_bound(scope.begin(), scope.end(), v) - scope.begin());
+        }
+    }
+
+    Factor out;
+    out.owner = -1;
+    out.vars = scope;
+    out.vars.erase(out.vars.begin() + p);
+    out.table.assign(size_t(1) << (u - 1), 0.0);
+
+    const size_t lowMask = (size_t(1) << p) - 1;
+    for (size_t code = 0; code < (size_t(1) << u); ++code) {
+        double prod = 1.0;
+        for (size_t i = 0; i < bucket.size() && prod != 0.0; ++i) {
+            size_t idx = 0;
+            for (size_t j = 0; j < pos[i].size(); ++j) {
+                idx |= ((code >> pos[i][j]) & 1) << j;
+            }
+            prod *= bucket[i].table[idx];
+        }
+        if (prod != 0.0) {
+            out.table[((code >> (p + 1)) << p) | (code & lowMask)] += prod;
+        }
+    }
+    flops += double(size_t(1) << u) * bucket.size();
+
+    rest.push_back(std::move(out));
+    factors = std::move(rest);
+}
+
+void TensorNetwork::absorbPrior(Factor& f, int var, const Eigen::Vector2d& prior) {
+    const int p = std::lower_bound(f.vars.begin(), f.vars.end(), var) - f.vars.begin();
+    const size_t lowMask = (size_t(1) << p) - 1;
+    std::vector<double> table(f.table.size() / 2);
+    for (size_t code = 0; code < table.size(); ++code) {
+        size_t base = ((code >> p) << (p + 1)) | (code & lowMask);
+        table[code] = prior(0) * f.table[base] + prior(1) * f.table[base | (size_t(1) << p)];
+    }
+    f.table = std::move(table);
+    f.vars.erase(f.vars.begin() + p);
+}
+
+bool TensorNetwork::marginal(int query, Eigen::Vector2d& result) {
+    stats_ = ContractionStats{0, 0, 0.0};
+
+    std::vector<Factor> local;
+    for (int fi : collectCone(query)) local.push_back(factors_[fi]);
+
+    bool hasQuery = false;
+    for (const auto& f : local) {
+        if (std::binary_search(f.vars.begin(), f.vars.end(), query)) hasQuery = true;
+    }
+    if (!hasQuery) {
+        std::cerr << "TensorNetwork: no factor defines variable " << query << std::endl;
+        return false;
+    }
+
+    std::unordered_set<int> cut;
+    std::vector<int> order;
+    std::vector<int> widest;
+    int width = 0;
+    while (true) {
+        order = planOrder(local, query, width, widest);
+        if (maxWidth_ <= 0 || width <= maxWidth_) break;
+
+        // 在最宽的一步中挑出被最多下游因子共享的变量，用先验切断
+        int victim = -1;
+        int victimUses = 0;
+        for (int v : widest) {
+            if (v == query || cut.count(v) || !cutPriors_.count(v)) continue;
+            int uses = 0;
+            for (const auto& f : local) {
+                if (f.owner != v && std::binary_search(f.vars.begin(), f.vars.end(), v)) ++uses;
+            }
+            if (uses > victimUses) {
+                victimUses = uses;
+                victim = v;
+            }
+        }
+        if (victim < 0) {
+            std::cerr << "TensorNetwork: width " << width << " exceeds limit " << maxWidth_
+                      << " for variable " << query << " and no remaining variable has a prior to cut" << std::endl;
+            return false;
+        }
+
+        const Eigen::Vector2d& prior = cutPriors_[victim];
+        for (auto& f : local) {
+            if (f.owner != victim && std::binary_search(f.vars.begin(), f.vars.end(), victim)) {
+                absorbPrior(f, victim, prior);
+            }
+        }
+        cut.insert(victim);
+        ++stats_.cuts;
+    }
+    stats_.width = width;
+
+    for (int v : order) {
+        eliminate(local, v, stats_.flops);
+    }
+
+    result = Eigen::Vector2d::Ones();
+    for (const auto& f : local) {
+        if (f.vars.empty()) {
+            result *= f.table[0];
+        } else {
+            result(0) *= f.table[0];
+            result(1) *= f.table[1];
+        }
+    }
+    return true;
+}